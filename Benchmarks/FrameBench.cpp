@@ -0,0 +1,467 @@
+//-----------------------------------------------------------------------------
+// File: FrameBench.cpp
+//
+// Desc: Headless full frame benchmark. Runs the game's own GameWorld (the
+//	   planes, EnemyGroup, the projectile pools, the layered broadphase and
+//	   the pixel masks loaded from Data/) without a window, on scripted
+//	   scenarios for a number of fixed 60 Hz frames, and reports mean /
+//	   p50 / p99 per phase of the tick:
+//
+//	     input     - decode the recorded input log, apply it to the plane
+//	                 (movement, fire, beam ray query, bombs)
+//	     update    - wave events, enemy fire, formation paths, flow field
+//	                 chasing, projectile motion, culling
+//	     collision - broadphase pairs, mask and boss part tests, removals
+//	     draw      - interpolated sprite blits into the headless platform's
+//	                 in-memory surface
+//
+//	   Each scenario is a wave script, compiled here, that keeps the world
+//	   at its size: the wave starts over whenever it is cleared. The plane
+//	   gets enough lives not to end the run; should a game end anyway it
+//	   restarts, as F5 would.
+//
+//	   After the last frame the world is snapshotted: the snapshot size,
+//	   the save / hash / restore times and a round trip check are printed.
+//
+//	   Build with CMake (see CMakeLists.txt) and run from the repository
+//	   root so Data/ is found:
+//	     FrameBench [--frames N] [--threads N] [--lock FPS] [--trace file.json] [scenario ...]
+//
+//	   --threads sets how many threads the job system runs the update and
+//	   collision phases on (default: one per hardware thread); the score
+//	   and hits reported do not change with it. --lock caps each frame
+//	   with the game's CTimer limiter, as the game's -fps does, and reports
+//	   how close the frames came to the target and how much CPU the process
+//	   used while capped. --trace needs the profiler compiled in
+//	   (-DENABLE_PROFILER=ON).
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "AllocationCounter.h"
+#include "CTimer.h"
+#include "FrameArena.h"
+#include "GameWorld.h"
+#include "InputLog.h"
+#include "JobSystem.h"
+#include "PlatformHeadless.h"
+#include "Profiler.h"
+#include "SpriteBank.h"
+#include "WaveScript.h"
+#include "WorldSnapshot.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+static const size_t   kEnemyBullets   = 16384;
+static const size_t   kFrameArenaSize = 256 * 1024;
+static const int      kLives          = 1000;
+static const int      kDefaultFrames  = 600;
+static const uint64_t kSeed           = 20240601;
+static const int      kRowLength      = 40;		// Enemies per line of a scenario's formation
+
+enum Phase
+{
+	PHASE_INPUT,
+	PHASE_UPDATE,
+	PHASE_COLLISION,
+	PHASE_DRAW,
+	PHASE_COUNT
+};
+
+static const char * const kPhaseNames[PHASE_COUNT] = { "input", "update", "collision", "draw" };
+
+//-----------------------------------------------------------------------------
+// Name : Scenario (Struct)
+// Desc : One wave, started over whenever it is cleared, and the input.
+//-----------------------------------------------------------------------------
+struct Scenario
+{
+	const char * mName;
+	size_t       mEnemies;		// In lines of kRowLength over the top two thirds
+	size_t       mBosses;		// In a row across the top
+	const char * mFire;			// <interval> <volley> <speed>, see WaveScript.h
+	float        mChaseSpeed;	// Enemies steer toward the plane, pixels per second
+	bool         mPlayerInput;	// Scripted movement, fire and beam
+	bool         mBombs;		// Bomb whenever it is ready
+};
+
+// bullets-10k and swarm-4k fire enough, from random enemies, to keep about
+// that many bullets on screen at once.
+static const Scenario kScenarios[] =
+{
+	{ "idle",        8,    0,  "1 0 0",       0.0f,  false, false },
+	{ "enemies-1k",  1000, 0,  "1 1 300",     0.0f,  true,  false },
+	{ "bullets-10k", 50,   0,  "0.05 280 200", 0.0f, true,  false },
+	{ "boss-storm",  200,  12, "0.5 3 350",   0.0f,  true,  true  },
+	{ "swarm-4k",    4000, 0,  "0.05 56 200", 0.0f,  true,  false },
+	{ "chase-4k",    4000, 0,  "1 1 300",     60.0f, true,  false },
+};
+
+//-----------------------------------------------------------------------------
+// Name : Bench (Struct)
+// Desc : What every scenario shares: the headless platform, the sprites
+//		loaded once, the workers and the frame arena.
+//-----------------------------------------------------------------------------
+struct Bench
+{
+	explicit Bench(unsigned aThreads)
+		: mPlatform(GameWorld::kPlayWidth, GameWorld::kPlayHeight, false)
+		, mSprites(mPlatform)
+		, mJobs(aThreads ? aThreads - 1 : JobSystem::kAutoWorkers)
+		, mFrameArena(kFrameArenaSize)
+	{
+	}
+
+	HeadlessPlatform mPlatform;
+	SpriteBank       mSprites;
+	JobSystem        mJobs;
+	FrameArena       mFrameArena;
+};
+
+//-----------------------------------------------------------------------------
+// Name : MakeScript () (Static)
+// Desc : The scenario as a wave script: the game's movement paths, one
+//		fire pattern and a single wave. Lines alternate between the paths.
+//-----------------------------------------------------------------------------
+static std::string MakeScript(const Scenario & aScenario)
+{
+	static const char * const kPaths[] = { "sweep", "loop", "drift", "dive" };
+
+	std::string script =
+		"path sweep  sine   40 15 1.5\n"
+		"path dive   dive   2 400 5 30 4\n"
+		"path loop   spline 0.8   0 0   120 60   0 120   -120 60\n"
+		"path drift  sine   250 40 0.4\n";
+	script += std::string("fire bench ") + aScenario.mFire + "\n";
+
+	char line[128];
+	snprintf(line, sizeof(line), "wave bench chase %g\n", aScenario.mChaseSpeed);
+	script += line;
+
+	const size_t rows = (aScenario.mEnemies + kRowLength - 1) / kRowLength;
+	const float  rowHeight = rows ? 400.0f / rows : 0.0f;
+	for (size_t row = 0; row < rows; ++row)
+	{
+		const size_t count = std::min(aScenario.mEnemies - row * kRowLength, (size_t)kRowLength);
+		snprintf(line, sizeof(line), "\tat 0 line %s %u 30 %.1f 18.5 0.05\n", kPaths[row % 4],
+			(unsigned)count, 40.0f + row * rowHeight);
+		script += line;
+	}
+
+	for (size_t boss = 0; boss < aScenario.mBosses; ++boss)
+	{
+		snprintf(line, sizeof(line), "\tat 0 boss drift %.1f 100\n",
+			60.0f + boss * (GameWorld::kPlayWidth - 120.0f) / std::max(aScenario.mBosses - 1, (size_t)1));
+		script += line;
+	}
+
+	return script + "end\n";
+}
+
+// Scripted input: weave left / right, change every second, fire and beam
+// held, bombs if the scenario uses them.
+static void RecordInput(InputLog & aInput, const Scenario & aScenario, int aFrames)
+{
+	aInput.Clear(kSeed);
+	uint16_t buttons = 0;
+	for (int frame = 0; frame < aFrames; ++frame)
+	{
+		if (aScenario.mPlayerInput && frame % 60 == 0)
+		{
+			buttons = INPUT_FIRE | INPUT_BEAM;
+			buttons |= (frame / 60) & 1 ? INPUT_LEFT : INPUT_RIGHT;
+			buttons |= (frame / 120) & 1 ? INPUT_UP : INPUT_DOWN;
+			if (aScenario.mBombs)
+				buttons |= INPUT_BOMB;
+		}
+		aInput.Record(buttons);
+	}
+	aInput.Rewind();
+}
+
+//-----------------------------------------------------------------------------
+// Frame phases, in the order GameWorld::SimulateTick runs them
+//-----------------------------------------------------------------------------
+static void PhaseInput(GameWorld & aWorld, InputLog & aInput, size_t & aRestarts)
+{
+	PROFILE_SCOPE("Input");
+
+	uint16_t buttons = 0;
+	aInput.Read(buttons);
+
+	if (aWorld.IsGameOver())
+	{
+		aWorld.Restart();
+		++aRestarts;
+	}
+
+	aWorld.ApplyInputs(buttons, 0);
+}
+
+static void PhaseDraw(Bench & aBench, GameWorld & aWorld)
+{
+	PROFILE_SCOPE("Draw");
+
+	uint32_t * pixels = aBench.mPlatform.Pixels();
+	std::fill(pixels, pixels + (size_t)aBench.mPlatform.Width() * aBench.mPlatform.Height(), 0xFF000020u);
+
+	// Frames land half way between ticks on average.
+	aWorld.Draw(0.5f);
+	aBench.mPlatform.Present();
+}
+
+//-----------------------------------------------------------------------------
+// Snapshots
+//-----------------------------------------------------------------------------
+// Times save, hash and restore of the world as it is now, and checks that
+// saving again after the restores gives back the same bytes.
+static void MeasureSnapshot(GameWorld & aWorld)
+{
+	static const int kRuns = 100;
+
+	WorldSnapshot snapshot, check;
+	aWorld.SaveState(snapshot);
+	const uint64_t hash = snapshot.Hash();
+
+	const int64_t start = PlatformClock::Ticks();
+	for (int run = 0; run < kRuns; ++run)
+		aWorld.SaveState(snapshot);
+	const int64_t saved = PlatformClock::Ticks();
+
+	uint64_t hashes = 0;
+	for (int run = 0; run < kRuns; ++run)
+		hashes += snapshot.Hash();
+	const int64_t hashed = PlatformClock::Ticks();
+
+	bool loaded = true;
+	for (int run = 0; run < kRuns; ++run)
+		loaded = aWorld.LoadState(snapshot) && loaded;
+	const int64_t restored = PlatformClock::Ticks();
+
+	aWorld.SaveState(check);
+	const bool same = loaded && hashes == hash * kRuns && check.Size() == snapshot.Size() &&
+		memcmp(check.Data(), snapshot.Data(), snapshot.Size()) == 0 && check.Hash() == hash;
+
+	const double microseconds = 1e6 / kRuns;
+	printf("  snapshot: %.1f KB, hash %016llx; save %.1f us, hash %.1f us, restore %.1f us; round trip %s\n",
+		snapshot.Size() / 1024.0, (unsigned long long)hash,
+		PlatformClock::Seconds(start, saved) * microseconds,
+		PlatformClock::Seconds(saved, hashed) * microseconds,
+		PlatformClock::Seconds(hashed, restored) * microseconds,
+		same ? "ok" : "MISMATCH");
+}
+
+//-----------------------------------------------------------------------------
+// Reporting
+//-----------------------------------------------------------------------------
+static double Percentile(std::vector<double> & aSamples, double aFraction)
+{
+	// Nearest rank on a sorted copy.
+	std::sort(aSamples.begin(), aSamples.end());
+	size_t rank = (size_t)(aFraction * aSamples.size() + 0.5);
+	rank = std::min(std::max(rank, (size_t)1), aSamples.size());
+	return aSamples[rank - 1];
+}
+
+static void PrintRow(const char * szName, std::vector<double> aSamples)
+{
+	double sum = 0.0;
+	for (double sample : aSamples)
+		sum += sample;
+
+	const double mean = sum / aSamples.size();
+	const double p50  = Percentile(aSamples, 0.50);
+	const double p99  = Percentile(aSamples, 0.99);
+
+	printf("  %-10s %9.3f %9.3f %9.3f\n", szName, mean, p50, p99);
+}
+
+static bool RunScenario(Bench & aBench, const Scenario & aScenario, int aFrames, float aLockFps)
+{
+	WaveScript script;
+	if (!script.Compile(MakeScript(aScenario).c_str()))
+	{
+		fprintf(stderr, "%s: %s\n", aScenario.mName, script.GetError().c_str());
+		return false;
+	}
+
+	GameWorld world(aBench.mPlatform, aBench.mSprites, aBench.mFrameArena, &aBench.mJobs, 1, kSeed, kEnemyBullets);
+	CPlayer & player = *world.GetPlayer(0);
+	player.SetLives(kLives);
+	world.SetWaves(script);
+
+	InputLog input;
+	RecordInput(input, aScenario, aFrames);
+
+	const EnemyGroup &     enemies       = world.GetEnemyGroup();
+	const ProjectilePool & playerBullets = world.GetPlayerBullets(0);
+	const ProjectilePool & enemyBullets  = enemies.GetBulletPool();
+
+	std::vector<double> samples[PHASE_COUNT + 1];
+	for (std::vector<double> & phase : samples)
+		phase.reserve(aFrames);
+
+	// With --lock each frame ends in the limiter; whole frames are timed
+	// from one Tick to the next, and the process CPU time over the run
+	// shows what the wait cost.
+	std::vector<double> lockedFrames;
+	lockedFrames.reserve(aFrames);
+	CTimer timer;
+	const clock_t cpuStart = clock();
+	const int64_t wallStart = PlatformClock::Ticks();
+
+	size_t peakEntities = 0, points = 0, hits = 0, restarts = 0;
+	uint64_t allocations = 0, allocatedBytes = 0, allocatingFrames = 0;
+	for (int frame = 0; frame < aFrames; ++frame)
+	{
+		int64_t times[PHASE_COUNT + 1];
+
+		AllocationCounter::BeginFrame();
+
+		times[0] = PlatformClock::Ticks();
+		PhaseInput(world, input, restarts);
+		times[1] = PlatformClock::Ticks();
+
+		// Lives and score change here, not in drawing
+		const size_t score = player.GetScore();
+		const int    lives = player.GetLives();
+
+		world.AnimateObjects(GameWorld::kTickTime);
+		times[2] = PlatformClock::Ticks();
+		world.ResolveCollisions();
+		times[3] = PlatformClock::Ticks();
+		PhaseDraw(aBench, world);
+		times[4] = PlatformClock::Ticks();
+
+		aBench.mFrameArena.Reset();
+
+		const AllocationStats frameAllocations = AllocationCounter::EndFrame();
+		allocations    += frameAllocations.mAllocations;
+		allocatedBytes += frameAllocations.mBytes;
+		allocatingFrames += frameAllocations.mAllocations ? 1 : 0;
+
+		points += player.GetScore() - score;
+		hits   += (size_t)(lives - player.GetLives());
+
+		for (int phase = 0; phase < PHASE_COUNT; ++phase)
+			samples[phase].push_back(PlatformClock::Seconds(times[phase], times[phase + 1]) * 1000.0);
+		samples[PHASE_COUNT].push_back(PlatformClock::Seconds(times[0], times[PHASE_COUNT]) * 1000.0);
+
+		peakEntities = std::max(peakEntities, enemies.GetEnemyCount() + playerBullets.Size() + enemyBullets.Size());
+
+		if (aLockFps > 0.0f)
+		{
+			timer.Tick(aLockFps);
+			if (frame > 0)
+				lockedFrames.push_back(timer.GetRawTimeElapsed() * 1000.0);
+		}
+	}
+
+	const double cpuSeconds  = (double)(clock() - cpuStart) / CLOCKS_PER_SEC;
+	const double wallSeconds = PlatformClock::Seconds(wallStart, PlatformClock::Ticks());
+
+	printf("%s: %d frames, peak %u entities, %u points, %u player hits, %u restarts, %u dropped\n",
+		aScenario.mName, aFrames, (unsigned)peakEntities, (unsigned)points, (unsigned)hits, (unsigned)restarts,
+		(unsigned)(playerBullets.Dropped() + enemyBullets.Dropped()));
+	printf("  heap: %.2f allocations, %.0f bytes per frame; %u of %d frames allocated\n",
+		(double)allocations / aFrames, (double)allocatedBytes / aFrames, (unsigned)allocatingFrames, aFrames);
+	if (aScenario.mChaseSpeed > 0.0f)
+		printf("  flow field: %u rebuilds\n", (unsigned)enemies.GetFlowField().Rebuilds());
+	MeasureSnapshot(world);
+	printf("  %-10s %9s %9s %9s   (ms)\n", "phase", "mean", "p50", "p99");
+
+	for (int phase = 0; phase < PHASE_COUNT; ++phase)
+		PrintRow(kPhaseNames[phase], samples[phase]);
+	PrintRow("frame", samples[PHASE_COUNT]);
+
+	if (!lockedFrames.empty())
+	{
+		// Late frames are the ones the limiter overslept by more than the
+		// spin floor's worth.
+		const double target = 1000.0 / aLockFps;
+		size_t late = 0;
+		for (double frameTime : lockedFrames)
+			late += frameTime > target + 0.25 ? 1 : 0;
+
+		PrintRow("locked", lockedFrames);
+		printf("  lock %.0f fps: target %.3f ms, max %.3f ms, %u late by over 0.25 ms; "
+			"cpu %.0f%% of %.1f s wall (all threads)\n",
+			aLockFps, target, Percentile(lockedFrames, 1.0), (unsigned)late,
+			wallSeconds > 0.0 ? cpuSeconds / wallSeconds * 100.0 : 0.0, wallSeconds);
+	}
+	printf("\n");
+	return true;
+}
+
+int main(int argc, char ** argv)
+{
+	int frames = kDefaultFrames;
+	unsigned threads = 0;
+	float lockFps = 0.0f;
+	const char * traceFile = NULL;
+	std::vector<std::string> selected;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+			frames = std::max(atoi(argv[++i]), 1);
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			threads = (unsigned)std::max(atoi(argv[++i]), 1);
+		else if (strcmp(argv[i], "--lock") == 0 && i + 1 < argc)
+			lockFps = std::max((float)atof(argv[++i]), 0.0f);
+		else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+			traceFile = argv[++i];
+		else
+			selected.push_back(argv[i]);
+	}
+
+	Bench bench(threads);
+	printf("%u threads\n\n", bench.mJobs.ThreadCount());
+
+	std::string error;
+	if (!bench.mSprites.Load(error))
+	{
+		fprintf(stderr, "%s\n", error.c_str());
+		return 1;
+	}
+
+	size_t ran = 0;
+	for (const Scenario & scenario : kScenarios)
+	{
+		if (!selected.empty() && std::find(selected.begin(), selected.end(), scenario.mName) == selected.end())
+			continue;
+
+		if (!RunScenario(bench, scenario, frames, lockFps))
+			return 1;
+		++ran;
+	}
+
+	if (!ran)
+	{
+		fprintf(stderr, "unknown scenario; available:");
+		for (const Scenario & scenario : kScenarios)
+			fprintf(stderr, " %s", scenario.mName);
+		fprintf(stderr, "\n");
+		return 1;
+	}
+
+	if (traceFile)
+	{
+#if !defined(PROFILER_ENABLED)
+		fprintf(stderr, "profiler not compiled in, %s will be empty\n", traceFile);
+#endif
+		if (!Profiler::WriteChromeTrace(bench.mPlatform, traceFile))
+		{
+			fprintf(stderr, "cannot write %s\n", traceFile);
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,287 @@
+//-----------------------------------------------------------------------------
+// File: RollbackBench.cpp
+//
+// Desc: Headless two player rollback benchmark. Two peers, each with its
+//	   own GameWorld (the game's simulation: both planes, EnemyGroup
+//	   playing Data/waves.txt, the projectile pools, the broadphase and the
+//	   pixel masks loaded from Data/), play a scripted game against each
+//	   other through RollbackSession over a LoopbackTransport pair. Each
+//	   direction goes through a LossyTransport that adds latency, jitter
+//	   and packet loss, on a simulated clock, so the run takes as long as
+//	   the CPU work and not the game time.
+//
+//	   Reports per peer how often it rolled back and how far, how long the
+//	   rollbacks took against the 16.7 ms frame, the cost of the worst
+//	   case (restore plus kMaxRollback ticks, the most over the run), and
+//	   whether both peers ended on the same world hash, and that the peer
+//	   left behind notices when the other disconnects.
+//
+//	   Run from the repository root so Data/ is found:
+//	     RollbackBench [--ticks N] [--waves file] [--threads N] [--latency ms]
+//	                   [--jitter ms] [--loss percent] [--delay ticks]
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include "FrameArena.h"
+#include "GameWorld.h"
+#include "InputLog.h"
+#include "JobSystem.h"
+#include "NetTransport.h"
+#include "Platform.h"
+#include "PlatformHeadless.h"
+#include "Random.h"
+#include "RollbackSession.h"
+#include "SpriteBank.h"
+#include "WorldSnapshot.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+static const float    kTickTime       = GameWorld::kTickTime;
+static const size_t   kFrameArenaSize = 256 * 1024;
+static const uint64_t kSeed           = 20240601;
+static const uint32_t kMeasureEvery   = 60;		// Frames between worst case rollback measurements
+static const uint16_t kHeldButtons    = INPUT_UP | INPUT_DOWN | INPUT_LEFT | INPUT_RIGHT | INPUT_BEAM;
+
+//-----------------------------------------------------------------------------
+// Name : Peer (Struct)
+// Desc : A machine's share of the game: its platform and sprites, its
+//		world, the session over it and the two ends of its link.
+//-----------------------------------------------------------------------------
+struct Peer
+{
+	Peer(JobSystem & aJobs, int aPlayer, double aLatency, double aJitter, float aLoss, uint32_t aDelay)
+		: mPlatform(GameWorld::kPlayWidth, GameWorld::kPlayHeight)
+		, mSprites(mPlatform)
+		, mFrameArena(kFrameArenaSize)
+		, mWorld(mPlatform, mSprites, mFrameArena, &aJobs, 2, kSeed)
+		, mLink(mLoopback, aLatency, aJitter, aLoss, kSeed + aPlayer)
+		, mSession(mWorld, mLink, aPlayer, aDelay)
+		, mScript(kSeed * 31 + aPlayer)
+		, mButtons(0)
+		, mHoldTicks(0)
+	{
+		mSession.SetHeldButtons(kHeldButtons);
+	}
+
+	bool Load(const char * szWaves, std::string & aError)
+	{
+		return mSprites.Load(aError) && mWorld.LoadWaves(szWaves, aError);
+	}
+
+	// Scripted player: holds a random direction, now and then with the
+	// beam, for a random while, and taps fire and the odd bomb, which the
+	// other peer can never predict. Restarts at game over, as F5 would.
+	uint16_t NextInput()
+	{
+		if (mWorld.IsGameOver())
+			return INPUT_RESTART;
+
+		if (mHoldTicks-- <= 0)
+		{
+			mButtons   = (uint16_t)(mScript.Next() & (INPUT_UP | INPUT_DOWN | INPUT_LEFT | INPUT_RIGHT));
+			mButtons  |= mScript.NextBelow(4) == 0 ? INPUT_BEAM : 0;
+			mHoldTicks = 5 + (int)mScript.NextBelow(40);
+		}
+
+		uint16_t buttons = mButtons;
+		if (mScript.NextBelow(6) == 0)
+			buttons |= INPUT_FIRE;
+		if (mScript.NextBelow(300) == 0)
+			buttons |= INPUT_BOMB;
+		return buttons;
+	}
+
+	HeadlessPlatform  mPlatform;
+	SpriteBank        mSprites;
+	FrameArena        mFrameArena;
+	GameWorld         mWorld;
+	LoopbackTransport mLoopback;
+	LossyTransport    mLink;
+	RollbackSession   mSession;
+	Random            mScript;
+	uint16_t          mButtons;
+	int               mHoldTicks;
+
+	std::vector<double> mRollbackMs;
+	std::vector<double> mFrameMs;
+};
+
+//-----------------------------------------------------------------------------
+// Reporting
+//-----------------------------------------------------------------------------
+static double Percentile(std::vector<double> aSamples, double aFraction)
+{
+	if (aSamples.empty())
+		return 0.0;
+
+	// Nearest rank on a sorted copy.
+	std::sort(aSamples.begin(), aSamples.end());
+	size_t rank = (size_t)(aFraction * aSamples.size() + 0.5);
+	rank = std::min(std::max(rank, (size_t)1), aSamples.size());
+	return aSamples[rank - 1];
+}
+
+// One frame of one peer: poll, then at most one tick.
+static void RunFrame(Peer & aPeer, uint32_t aTicks)
+{
+	const RollbackStats & stats = aPeer.mSession.Stats();
+	const uint32_t rollbacks = stats.mRollbacks;
+
+	const int64_t start = PlatformClock::Ticks();
+	aPeer.mSession.Poll();
+	if (aPeer.mSession.Tick() < aTicks && aPeer.mSession.CanAdvance())
+		aPeer.mSession.Advance(aPeer.NextInput());
+	aPeer.mFrameMs.push_back(PlatformClock::Seconds(start, PlatformClock::Ticks()) * 1000.0);
+	aPeer.mFrameArena.Reset();
+
+	if (stats.mRollbacks != rollbacks)
+		aPeer.mRollbackMs.push_back(stats.mLastRollbackSeconds * 1000.0);
+}
+
+// Restore plus kMaxRollback ticks, the most one frame ever has to catch
+// up, from the world as it is now; the world is left as it was.
+static double MeasureWorstRollback(GameWorld & aWorld)
+{
+	static const int kRuns = 10;
+
+	WorldSnapshot snapshot;
+	aWorld.SaveState(snapshot);
+
+	const uint16_t buttons[2] = { INPUT_FIRE | INPUT_BEAM | INPUT_LEFT, INPUT_FIRE | INPUT_BEAM | INPUT_RIGHT };
+	const int64_t start = PlatformClock::Ticks();
+	for (int run = 0; run < kRuns; ++run)
+	{
+		aWorld.LoadState(snapshot);
+		for (uint32_t tick = 0; tick < RollbackSession::kMaxRollback; ++tick)
+			aWorld.SimulateTick(buttons, true);
+	}
+	const double seconds = PlatformClock::Seconds(start, PlatformClock::Ticks()) / kRuns;
+
+	aWorld.LoadState(snapshot);
+	return seconds * 1000.0;
+}
+
+int main(int argc, char ** argv)
+{
+	uint32_t     ticks   = 3600;
+	const char * waves   = "Data/waves.txt";
+	unsigned     threads = 0;
+	double       latency = 60.0, jitter = 15.0, loss = 5.0;
+	uint32_t     delay   = 2;
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "--ticks") == 0)        ticks   = (uint32_t)std::max(atoi(argv[i + 1]), 1);
+		else if (strcmp(argv[i], "--waves") == 0)   waves   = argv[i + 1];
+		else if (strcmp(argv[i], "--threads") == 0) threads = (unsigned)std::max(atoi(argv[i + 1]), 1);
+		else if (strcmp(argv[i], "--latency") == 0) latency = std::max(atof(argv[i + 1]), 0.0);
+		else if (strcmp(argv[i], "--jitter") == 0)  jitter  = std::max(atof(argv[i + 1]), 0.0);
+		else if (strcmp(argv[i], "--loss") == 0)    loss    = std::min(std::max(atof(argv[i + 1]), 0.0), 100.0);
+		else if (strcmp(argv[i], "--delay") == 0)   delay   = (uint32_t)std::max(atoi(argv[i + 1]), 0);
+		else
+		{
+			fprintf(stderr, "unknown option %s\n", argv[i]);
+			return 1;
+		}
+	}
+
+	// The peers take turns, so they can share the workers, as two
+	// machines' worth of threads would not be on one anyway.
+	JobSystem jobs(threads ? threads - 1 : JobSystem::kAutoWorkers);
+
+	// One-way latency is half the round trip asked for.
+	std::unique_ptr<Peer> peers[2];
+	for (int player = 0; player < 2; ++player)
+	{
+		peers[player].reset(new Peer(jobs, player, latency / 2000.0, jitter / 1000.0, (float)(loss / 100.0), delay));
+
+		std::string error;
+		if (!peers[player]->Load(waves, error))
+		{
+			fprintf(stderr, "%s\n", error.c_str());
+			return 1;
+		}
+	}
+	LoopbackTransport::Connect(peers[0]->mLoopback, peers[1]->mLoopback);
+
+	printf("%u ticks, %s, %u threads, %.0f ms round trip (+%.0f jitter), %.0f%% loss, %u ticks input delay\n\n",
+		ticks, waves, jobs.ThreadCount(), latency, jitter, loss, delay);
+
+	// Run until both peers have simulated every tick with every input
+	// confirmed; the clock only moves in whole frames.
+	// The worst case is measured every so often along the way, since what
+	// a tick costs follows the waves.
+	uint32_t frame = 0;
+	double   worst = 0.0;
+	for (;; ++frame)
+	{
+		bool done = true;
+		for (std::unique_ptr<Peer> & peer : peers)
+		{
+			peer->mLink.SetTime(frame * (double)kTickTime);
+			peer->mSession.SetTime(frame * (double)kTickTime);
+			RunFrame(*peer, ticks);
+			done = done && peer->mSession.Tick() == ticks && peer->mSession.RemoteInputCount() >= ticks;
+		}
+
+		if (frame % kMeasureEvery == 0)
+			worst = std::max(worst, MeasureWorstRollback(peers[0]->mWorld));
+
+		if (done || frame > ticks * 20)
+			break;
+	}
+
+	WorldSnapshot finals[2];
+	for (int player = 0; player < 2; ++player)
+	{
+		Peer & peer = *peers[player];
+		const RollbackStats & stats = peer.mSession.Stats();
+
+		printf("peer %d: %u frames, %u rollbacks, %u ticks replayed (max %u at once), %u stalled polls\n",
+			player, frame + 1, stats.mRollbacks, stats.mReplayedTicks, stats.mMaxDepth, stats.mStalls);
+		printf("  datagrams: %u sent (%u lost), %u received\n",
+			stats.mPacketsSent, peer.mLink.Dropped(), stats.mPacketsReceived);
+		printf("  rollback: p50 %.3f ms, p99 %.3f ms, max %.3f ms; frame: p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+			Percentile(peer.mRollbackMs, 0.50), Percentile(peer.mRollbackMs, 0.99), stats.mMaxRollbackSeconds * 1000.0,
+			Percentile(peer.mFrameMs, 0.50), Percentile(peer.mFrameMs, 0.99), Percentile(peer.mFrameMs, 1.0));
+		printf("  score %u / %u, lives %d / %d%s\n", (unsigned)peer.mWorld.GetPlayer(0)->GetScore(),
+			(unsigned)peer.mWorld.GetPlayer(1)->GetScore(), peer.mWorld.GetPlayer(0)->GetLives(),
+			peer.mWorld.GetPlayer(1)->GetLives(), peer.mSession.IsDesynced() ? ", DESYNC reported" : "");
+
+		peer.mWorld.SaveState(finals[player]);
+	}
+
+	printf("\nworst case rollback (restore + %u ticks): %.3f ms, %.0f%% of a %.1f ms frame\n",
+		RollbackSession::kMaxRollback, worst, worst * 100.0 / (kTickTime * 1000.0), kTickTime * 1000.0);
+
+	const bool same = finals[0].Size() == finals[1].Size() &&
+		memcmp(finals[0].Data(), finals[1].Data(), finals[0].Size()) == 0;
+	printf("final state: %016llx / %016llx, %s\n", (unsigned long long)finals[0].Hash(),
+		(unsigned long long)finals[1].Hash(), same ? "match" : "MISMATCH");
+
+	// Peer 0 leaves; peer 1 has to notice, from the leaving datagram or,
+	// if every copy is lost, from the silence.
+	peers[0]->mSession.Disconnect();
+	const uint32_t leftAt = frame;
+	RollbackSession & remaining = peers[1]->mSession;
+	while (!remaining.IsOver() && frame - leftAt < (uint32_t)(60.0 / kTickTime))
+	{
+		++frame;
+		for (std::unique_ptr<Peer> & peer : peers)
+			peer->mLink.SetTime(frame * (double)kTickTime);
+		peers[0]->mLink.Flush();
+		remaining.SetTime(frame * (double)kTickTime);
+		remaining.Poll();
+	}
+	printf("peer 0 left: peer 1 %s after %.0f ms\n", remaining.End() == SESSION_PEER_LEFT ? "was told" :
+		remaining.End() == SESSION_TIMED_OUT ? "timed out" : "never noticed", (frame - leftAt) * kTickTime * 1000.0);
+
+	return same && remaining.IsOver() && !peers[0]->mSession.IsDesynced() && !peers[1]->mSession.IsDesynced() ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+//-----------------------------------------------------------------------------
+// File: SpatialQueryBench.cpp
+//
+// Desc: Target query benchmark: 5k enemies, 10k nearest / radius queries per
+//	   frame, grid rebuilt every frame as the game does. Brute force scans
+//	   are timed alongside for reference.
+//
+//	   Build (any platform, no window needed):
+//	     g++ -O2 -std=c++14 -IIncludes Benchmarks/SpatialQueryBench.cpp
+//	         Source/SpatialGrid.cpp Source/RectangleSoA.cpp
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "SpatialGrid.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+static const int   kEnemyCount   = 5000;
+static const int   kQueryCount   = 10000;
+static const int   kFrames       = 20;
+static const int   kWorldWidth   = 3200;
+static const int   kWorldHeight  = 2400;
+static const int   kEnemySize    = 50;
+static const size_t kNearestCount = 4;
+static const float kRadius       = 100.0f;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Milliseconds(Clock::time_point aStart, Clock::time_point aEnd)
+{
+	return std::chrono::duration<double, std::milli>(aEnd - aStart).count();
+}
+
+int main()
+{
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> worldX(0.0f, (float)kWorldWidth);
+	std::uniform_real_distribution<float> worldY(0.0f, (float)kWorldHeight);
+	std::uniform_real_distribution<float> drift(-2.0f, 2.0f);
+
+	std::vector<float> enemyX(kEnemyCount), enemyY(kEnemyCount);
+	for (int i = 0; i < kEnemyCount; ++i)
+	{
+		enemyX[i] = worldX(random);
+		enemyY[i] = worldY(random);
+	}
+
+	std::vector<float> queryX(kQueryCount), queryY(kQueryCount);
+	for (int i = 0; i < kQueryCount; ++i)
+	{
+		queryX[i] = worldX(random);
+		queryY[i] = worldY(random);
+	}
+
+	RectangleSoA rectangles;
+	SpatialGrid grid(64);
+	uint32_t indices[kNearestCount];
+	float distances[kNearestCount];
+
+	double buildMs = 0.0, nearestMs = 0.0, radiusMs = 0.0;
+	size_t checksum = 0;
+
+	for (int frame = 0; frame < kFrames; ++frame)
+	{
+		for (int i = 0; i < kEnemyCount; ++i)
+		{
+			enemyX[i] += drift(random);
+			enemyY[i] += drift(random);
+		}
+
+		Clock::time_point t0 = Clock::now();
+
+		rectangles.Clear();
+		for (int i = 0; i < kEnemyCount; ++i)
+		{
+			int32_t left = (int32_t)enemyX[i] - kEnemySize / 2;
+			int32_t top  = (int32_t)enemyY[i] - kEnemySize / 2;
+			rectangles.Add(left, top, left + kEnemySize, top + kEnemySize);
+		}
+		grid.Build(rectangles);
+
+		Clock::time_point t1 = Clock::now();
+
+		for (int q = 0; q < kQueryCount; ++q)
+			checksum += grid.FindNearest(queryX[q], queryY[q], kNearestCount, 1e9f, indices, distances);
+
+		Clock::time_point t2 = Clock::now();
+
+		for (int q = 0; q < kQueryCount; ++q)
+			grid.QueryRadius(queryX[q], queryY[q], kRadius, [&](uint32_t) { ++checksum; });
+
+		Clock::time_point t3 = Clock::now();
+
+		buildMs   += Milliseconds(t0, t1);
+		nearestMs += Milliseconds(t1, t2);
+		radiusMs  += Milliseconds(t2, t3);
+	}
+
+	// Brute force reference, one frame.
+	Clock::time_point b0 = Clock::now();
+	for (int q = 0; q < kQueryCount; ++q)
+	{
+		float best = 1e30f;
+		for (int i = 0; i < kEnemyCount; ++i)
+		{
+			float dx = enemyX[i] - queryX[q];
+			float dy = enemyY[i] - queryY[q];
+			best = std::min(best, dx * dx + dy * dy);
+		}
+		checksum += (size_t)best;
+	}
+	Clock::time_point b1 = Clock::now();
+
+	printf("enemies %d, queries/frame %d, frames %d\n", kEnemyCount, kQueryCount, kFrames);
+	printf("grid rebuild          : %8.3f ms/frame\n", buildMs / kFrames);
+	printf("nearest (k=%u)         : %8.3f ms/frame\n", (unsigned)kNearestCount, nearestMs / kFrames);
+	printf("radius (r=%.0f)        : %8.3f ms/frame\n", kRadius, radiusMs / kFrames);
+	printf("brute force nearest   : %8.3f ms/frame\n", Milliseconds(b0, b1));
+	printf("(checksum %u)\n", (unsigned)checksum);
+
+	return 0;
+}
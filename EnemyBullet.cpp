@@ -1,6 +0,0 @@
-#include "EnemyBullet.h"
-
-EnemyBullet::EnemyBullet(const BackBuffer * pBackBuffer, const Vec2 & aPosition)
-  :Bullet(pBackBuffer, aPosition, DIRECTION::DIR_BACKWARD, nullptr)
-{
-}
\ No newline at end of file
@@ -1,9 +0,0 @@
-#pragma once
-#include "Bullet.h"
-#include "BackBuffer.h"
-
-class EnemyBullet :public Bullet
-{
-public:
-  EnemyBullet(const BackBuffer * pBackBuffer, const Vec2 & aPosition);
-};
\ No newline at end of file
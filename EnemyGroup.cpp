@@ -1,124 +1,472 @@
+#include <float.h>
 #include <algorithm>
 #include "EnemyGroup.h"
 using namespace std;
 
-const int EnemyGroup::kEnemyNumber = 8;
-const int EnemyGroup::kEnemiesOnLine = 8;
+const int EnemyGroup::kBossPartSize = 25;
+const int EnemyGroup::kBossPartHitPoints = 2;
+const size_t EnemyGroup::kDefaultMaxBullets;
+const float EnemyGroup::kChaseStandOff = 120.0f;
 
-EnemyGroup::EnemyGroup(const BackBuffer * aBackBuffer)
-	:mBackBuffer(aBackBuffer)
+EnemyGroup::EnemyGroup(SpriteBank * aSprites, uint64_t aSeed, size_t aMaxBullets)
+	:mWave(0)
+	,mEventCursor(0)
+	,mFireTimer(0.0f)
+	,mRandom(aSeed)
+	,mSprites(aSprites)
+	,mWaveTime(0.0f)
+	,mBullets(aMaxBullets)
+	,mTargetCount(0)
+	,mRectanglesDirty(true)
 {
-	GenerateEnemies();
 }
 
-void EnemyGroup::GenerateEnemies()
+bool EnemyGroup::LoadWaves(IPlatform & aPlatform, const char * szFileName, std::string & aError)
 {
-	mEnemies.clear();
+	WaveScript script;
+	if (!script.LoadFromFile(aPlatform, szFileName))
+	{
+		aError = std::string(szFileName) + ", " + script.GetError();
+		return false;
+	}
 
-	auto generator = [this](int aIndex)
+	SetWaves(script);
+	return true;
+}
+
+void EnemyGroup::SetWaves(const WaveScript & aScript)
+{
+	mScript = aScript;
+	mFormation = Formation();
+	mScript.RegisterPaths(mFormation);
+
+	StartWave(0);
+}
+
+void EnemyGroup::StartWave(size_t aWave)
+{
+	mEnemies.Clear();
+	mEnemySlots.Clear();
+	mFormation.Clear();
+	mBossColliders.clear();
+
+	mWave        = aWave;
+	mEventCursor = mScript.Waves()[aWave].mFirstEvent;
+	mWaveTime    = 0.0f;
+	mFireTimer   = 0.0f;
+
+	mRectanglesDirty = true;
+}
+
+void EnemyGroup::SpawnEvent(const WaveEvent & aEvent)
+{
+	if (aEvent.mType == WAVE_EVENT_BOSS)
+	{
+		AddBossCollider();
+		AddEnemy(Vec2(aEvent.mX, aEvent.mY), SPRITE_BOSS, (int32_t)mBossColliders.size() - 1,
+			aEvent.mPath, -mWaveTime);
+	}
+	else
 	{
-		auto pos = Vec2(45 + 100 * (aIndex % kEnemiesOnLine),
-			100 + 100 * (aIndex / kEnemiesOnLine));
+		// Clocks are shifted so each enemy starts its path when it spawns,
+		// plus its stagger along the line.
+		for (uint16_t i = 0; i < aEvent.mCount; ++i)
+		{
+			AddEnemy(Vec2(aEvent.mX + aEvent.mSpacing * i, aEvent.mY), SPRITE_ENEMY, -1,
+				aEvent.mPath, aEvent.mStagger * i - mWaveTime);
+		}
+	}
+
+	mRectanglesDirty = true;
+}
+
+void EnemyGroup::AddBossCollider()
+{
+	mBossColliders.push_back(CompoundCollider());
+	mBossColliders.back().BuildFromMask(mSprites->GetCollisionMask(SPRITE_BOSS),
+		kBossPartSize, kBossPartHitPoints);
+}
+
+void EnemyGroup::AddEnemy(const Vec2 & aSlot, SpriteId aSprite, int32_t aCollider,
+	uint16_t aPath, float aTimeOffset)
+{
+	mEnemies.Add((float)aSlot.x, (float)aSlot.y, 0.0f, 0.0f, (uint16_t)aSprite,
+		mSprites->Width(aSprite) / 2, mSprites->Height(aSprite) / 2, OWNER_ENEMY, aCollider);
+	mEnemySlots.Insert();
+	mFormation.Add(aPath, (float)aSlot.x, (float)aSlot.y, aTimeOffset);
+}
+
+bool EnemyGroup::HitEnemy(size_t aEnemy, const EntityStore & aBullets, size_t aBullet, bool & aDestroyed)
+{
+	return ApplyHit(aEnemy, aBullets, aBullet, TestHit(aEnemy, aBullets, aBullet), aDestroyed);
+}
 
-		return std::make_unique<Enemy>(mBackBuffer, pos);
-	};
+int EnemyGroup::TestHit(size_t aEnemy, const EntityStore & aBullets, size_t aBullet) const
+{
+	int32_t enemyLeft, enemyTop, enemyRight, enemyBottom;
+	int32_t bulletLeft, bulletTop, bulletRight, bulletBottom;
+	mEnemies.GetBounds(aEnemy, enemyLeft, enemyTop, enemyRight, enemyBottom);
+	aBullets.GetBounds(aBullet, bulletLeft, bulletTop, bulletRight, bulletBottom);
+
+	const CollisionMask & bulletMask = mSprites->GetCollisionMask(aBullets.Sprite()[aBullet]);
+	const int offsetX = bulletLeft - enemyLeft;
+	const int offsetY = bulletTop - enemyTop;
 
-	for (int i = 0; i < kEnemyNumber; ++i)
+	// Small enemies keep the single mask test and die on the first hit.
+	const int32_t collider = mEnemies.Collider()[aEnemy];
+	if (collider < 0)
 	{
-		mEnemies.push_back(generator(i));
+		const CollisionMask & enemyMask = mSprites->GetCollisionMask(mEnemies.Sprite()[aEnemy]);
+		return enemyMask.Overlaps(bulletMask, offsetX, offsetY) ? 0 : -1;
 	}
+
+	return mBossColliders[collider].HitTest(bulletMask, offsetX, offsetY);
 }
 
-bool EnemyGroup::HandleBullet(Bullet & aBullet)
+bool EnemyGroup::ApplyHit(size_t aEnemy, const EntityStore & aBullets, size_t aBullet, int aPart,
+	bool & aDestroyed)
 {
-	auto shot = std::find_if(mEnemies.begin(), mEnemies.end(),
-		[&](unique_ptr<Enemy> & aEnemy)
+	aDestroyed = false;
+	if (aPart < 0)
+		return false;
+
+	const int32_t collider = mEnemies.Collider()[aEnemy];
+	if (collider < 0)
 	{
-		return aEnemy->IsShot(aBullet);
-	});
+		aDestroyed = true;
+		return true;
+	}
 
-	if (shot != mEnemies.end())
+	// Bosses absorb the bullet with whichever part it touched. Parts only
+	// ever die, so a miss stays a miss, but a part destroyed since the test
+	// means the bullet may now reach another one behind it.
+	CompoundCollider & boss = mBossColliders[collider];
+	if (boss.GetPart(aPart).mHitPoints <= 0)
 	{
-		mEnemies.erase(shot);
+		aPart = TestHit(aEnemy, aBullets, aBullet);
+		if (aPart < 0)
+			return false;
+	}
 
+	boss.Damage(aPart, 1);
+	aDestroyed = boss.IsDestroyed();
+	return true;
+}
+
+bool EnemyGroup::DamageEnemy(size_t aEnemy, const Vec2 & aPoint, int aAmount)
+{
+	const int32_t collider = mEnemies.Collider()[aEnemy];
+	if (collider < 0)
 		return true;
-	}
 
-	return false;
+	int32_t left, top, right, bottom;
+	mEnemies.GetBounds(aEnemy, left, top, right, bottom);
+
+	CompoundCollider & boss = mBossColliders[collider];
+	boss.Damage(boss.PartNear((int)aPoint.x - left, (int)aPoint.y - top), aAmount);
+
+	return boss.IsDestroyed();
 }
 
-bool EnemyGroup::IsEmpty() const
+bool EnemyGroup::DamageEnemyPart(size_t aEnemy, int aPart, int aAmount)
 {
-	return mEnemies.empty();
+	const int32_t collider = mEnemies.Collider()[aEnemy];
+	if (collider < 0)
+		return true;
+
+	CompoundCollider & boss = mBossColliders[collider];
+	boss.Damage(aPart, aAmount);
+
+	return boss.IsDestroyed();
 }
 
-void EnemyGroup::Draw()
+size_t EnemyGroup::GetScoreValue(size_t aEnemy) const
 {
-	std::for_each(mEnemies.begin(), mEnemies.end(),
-		[](auto & aEnemy)
-	{
-		aEnemy->Draw();
-	});
+	const int32_t collider = mEnemies.Collider()[aEnemy];
 
-	for (auto & bullet : mBullets)
+	return collider < 0 ? 1 : mBossColliders[collider].PartCount();
+}
+
+SlotHandle EnemyGroup::GetEnemyHandle(size_t aEnemy) const
+{
+	return mEnemySlots.HandleAt(aEnemy);
+}
+
+void EnemyGroup::RemoveEnemies(const SlotHandle * aEnemies, size_t aCount)
+{
+	for (size_t i = 0; i < aCount; ++i)
 	{
-		bullet->Draw();
+		const size_t index = mEnemySlots.IndexOf(aEnemies[i]);
+		if (index == SlotMap::kInvalidIndex)
+			continue;
+
+		// All three move their last element into the hole.
+		mEnemies.Remove(index);
+		mEnemySlots.EraseAt(index);
+		mFormation.Remove(index);
+		mRectanglesDirty = true;
 	}
 }
 
-void EnemyGroup::ShootRandom()
+bool EnemyGroup::IsEmpty() const
 {
-	static size_t lastTime = ::GetTickCount();
-	size_t currentTime = ::GetTickCount();
-	if (currentTime - lastTime < 1000)
-	{
+	return mEnemies.IsEmpty();
+}
+
+size_t EnemyGroup::GetEnemyCount() const
+{
+	return mEnemies.Size();
+}
+
+void EnemyGroup::Draw(float aAlpha)
+{
+	mSprites->DrawEntities(mEnemies, aAlpha);
+	mSprites->DrawEntities(mBullets.Entities(), aAlpha);
+}
+
+void EnemyGroup::FireVolley(const FirePattern & aPattern)
+{
+	if (mEnemies.IsEmpty())
 		return;
-	}
-	else
+
+	for (uint32_t shot = 0; shot < aPattern.mVolley; ++shot)
 	{
-		lastTime = currentTime;
+		const size_t idx = mRandom.NextBelow((uint32_t)mEnemies.Size());
+		mBullets.Spawn(mEnemies.X()[idx], mEnemies.Y()[idx], 0.0f, aPattern.mSpeed, SPRITE_BULLET_DOWN,
+			mSprites->Width(SPRITE_BULLET_DOWN) / 2, mSprites->Height(SPRITE_BULLET_DOWN) / 2, OWNER_ENEMY);
 	}
+}
 
-	static bool init = false;
-	if (!init)
+void EnemyGroup::SetTargets(const Vec2 * aTargets, size_t aCount)
+{
+	mTargetCount = std::min(aCount, FlowField::kMaxTargets);
+	for (size_t i = 0; i < mTargetCount; ++i)
 	{
-		srand(time(0));
+		mTargetX[i] = (float)aTargets[i].x;
+		mTargetY[i] = (float)aTargets[i].y;
 	}
-
-	auto idx = rand() % mEnemies.size();
-	mBullets.push_back(mEnemies[idx]->Shoot());
 }
 
-void EnemyGroup::Update(float aTimeElapsed)
+void EnemyGroup::Update(float aTimeElapsed, int32_t aLeft, int32_t aTop, int32_t aRight, int32_t aBottom,
+	JobSystem * aJobs)
 {
-	for (auto & enemy : mEnemies)
+	const WaveInfo & wave = mScript.Waves()[mWave];
+	const size_t waveEnd = wave.mFirstEvent + wave.mEventCount;
+
+	mEnemies.StorePrevious();
+	mBullets.StorePrevious();
+
+	// Only the events that are due are touched; the wave is sorted by time.
+	mWaveTime += aTimeElapsed;
+	const size_t firstSpawned = mEnemies.Size();
+	while (mEventCursor < waveEnd && mScript.Events()[mEventCursor].mTime <= mWaveTime)
+		SpawnEvent(mScript.Events()[mEventCursor++]);
+
+	const FirePattern & fire = mScript.FirePatterns()[wave.mFirePattern];
+	mFireTimer += aTimeElapsed;
+	while (mFireTimer >= fire.mInterval)
+	{
+		mFireTimer -= fire.mInterval;
+		FireVolley(fire);
+	}
+
+	// Chasers move their whole path along the field, sampled where they
+	// are now, and hold off once they are close.
+	if (wave.mChaseSpeed > 0.0f)
 	{
-		enemy->Update(aTimeElapsed);
+		mFlowField.Update(aLeft, aTop, aRight, aBottom, mTargetX, mTargetY, mTargetCount);
+		mFlowField.Steer(mEnemies.X(), mEnemies.Y(), mEnemies.Size(), wave.mChaseSpeed * aTimeElapsed,
+			kChaseStandOff, mFormation.SlotX(), mFormation.SlotY(), aJobs);
 	}
 
-	for (auto & bullet : mBullets)
+	mFormation.Evaluate(mWaveTime, mEnemies.X(), mEnemies.Y(), aJobs);
+
+	// Enemies spawned this tick appear on their path, not on their slot.
+	for (size_t i = firstSpawned; i < mEnemies.Size(); ++i)
 	{
-		bullet->Update(aTimeElapsed);
+		mEnemies.PreviousX()[i] = mEnemies.X()[i];
+		mEnemies.PreviousY()[i] = mEnemies.Y()[i];
 	}
 
+	mBullets.Integrate(aTimeElapsed, aJobs);
+
+	const EntityStore & bullets = mBullets.Entities();
+	mBullets.ReleaseIf([&](size_t aIndex)
+	{
+		int32_t left, top, right, bottom;
+		bullets.GetBounds(aIndex, left, top, right, bottom);
+
+		return right < aLeft || left > aRight ||
+			bottom < aTop || top > aBottom;
+	});
+
+	mRectanglesDirty = true;
+
+	// Cleared: on to the next wave, looping back to the first.
+	if (mEventCursor == waveEnd && mEnemies.IsEmpty())
+		StartWave((mWave + 1) % mScript.Waves().size());
+}
+
+const EntityStore & EnemyGroup::GetBullets() const
+{
+	return mBullets.Entities();
 }
 
-EnemyGroup::Iter EnemyGroup::begin()
+const ProjectilePool & EnemyGroup::GetBulletPool() const
 {
-	return mBullets.begin();
+	return mBullets;
 }
 
-EnemyGroup::Iter EnemyGroup::end()
+const FlowField & EnemyGroup::GetFlowField() const
 {
-	return mBullets.end();
+	return mFlowField;
 }
 
-EnemyGroup::ConstIter EnemyGroup::cbegin() const
+void EnemyGroup::SaveState(WorldSnapshot & aSnapshot) const
 {
-	return mBullets.cbegin();
+	aSnapshot.Write((uint32_t)mWave);
+	aSnapshot.Write((uint32_t)mEventCursor);
+	aSnapshot.Write(mFireTimer);
+	aSnapshot.Write(mWaveTime);
+	aSnapshot.Write(mRandom.GetState());
+
+	mEnemies.SaveState(aSnapshot);
+	mEnemySlots.SaveState(aSnapshot);
+	mFormation.SaveState(aSnapshot);
+	mBullets.SaveState(aSnapshot);
+
+	aSnapshot.Write((uint32_t)mBossColliders.size());
+	for (const CompoundCollider & boss : mBossColliders)
+		boss.SaveState(aSnapshot);
 }
 
-EnemyGroup::ConstIter EnemyGroup::cend() const
+bool EnemyGroup::LoadState(SnapshotReader & aReader)
 {
-	return mBullets.cend();
+	uint32_t wave = 0, eventCursor = 0, bosses = 0;
+	uint64_t randomState = 0;
+
+	aReader.Read(wave);
+	aReader.Read(eventCursor);
+	aReader.Read(mFireTimer);
+	aReader.Read(mWaveTime);
+	aReader.Read(randomState);
+	if (aReader.Failed() || wave >= mScript.Waves().size() || eventCursor > mScript.Events().size())
+		return false;
+
+	mWave        = wave;
+	mEventCursor = eventCursor;
+	mRandom.SetState(randomState);
+
+	if (!mEnemies.LoadState(aReader) || !mEnemySlots.LoadState(aReader) ||
+		!mFormation.LoadState(aReader) || !mBullets.LoadState(aReader))
+		return false;
+
+	if (mEnemySlots.Size() != mEnemies.Size() || mFormation.Size() != mEnemies.Size())
+		return false;
+
+	// Every boss collider comes from the same mask: keep the ones already
+	// built, build only what is missing, then load the hit points.
+	if (!aReader.Read(bosses))
+		return false;
+	if (bosses < mBossColliders.size())
+		mBossColliders.erase(mBossColliders.begin() + bosses, mBossColliders.end());
+	while (mBossColliders.size() < bosses)
+		AddBossCollider();
+
+	for (CompoundCollider & boss : mBossColliders)
+		if (!boss.LoadState(aReader))
+			return false;
+
+	mRectanglesDirty = true;
+	return true;
+}
+
+void EnemyGroup::AddColliders(Broadphase & aBroadphase)
+{
+	RefreshRectangles();
+
+	aBroadphase.SetLayer(LAYER_ENEMY, &mEnemyRectangles);
+	aBroadphase.SetLayer(LAYER_ENEMY_BULLET, &mBulletRectangles);
+}
+
+bool EnemyGroup::Raycast(const Vec2 & aOrigin, const Vec2 & aDir, float aMaxDistance, RayHit & aHit,
+	int & aPart)
+{
+	RefreshRectangles();
+
+	const float originX = (float)aOrigin.x;
+	const float originY = (float)aOrigin.y;
+	const float dirX    = (float)aDir.x;
+	const float dirY    = (float)aDir.y;
+
+	// The grid finds the boxes along the ray, the enemy mask (or the live
+	// boss parts) gives the first opaque pixel inside the box. The grid
+	// keeps the nearest hit, so the part is tracked the same way.
+	float partT = FLT_MAX;
+	aPart = 0;
+
+	return mEnemyGrid.Raycast(originX, originY, dirX, dirY, aMaxDistance,
+		[&](uint32_t aIndex, float aEnterT, float aExitT, float & aHitT)
+	{
+		const float localX = originX - mEnemyRectangles.Left()[aIndex];
+		const float localY = originY - mEnemyRectangles.Top()[aIndex];
+
+		const int32_t collider = mEnemies.Collider()[aIndex];
+		int part = 0;
+		bool hit;
+
+		if (collider < 0)
+			hit = mSprites->GetCollisionMask(mEnemies.Sprite()[aIndex]).Raycast(localX, localY,
+				dirX, dirY, aEnterT, aExitT, aHitT);
+		else
+			hit = (part = mBossColliders[collider].Raycast(localX, localY, dirX, dirY,
+				aEnterT, aExitT, aHitT)) >= 0;
+
+		if (hit && aHitT < partT)
+		{
+			partT = aHitT;
+			aPart = part;
+		}
+		return hit;
+	}, aHit);
+}
+
+size_t EnemyGroup::FindNearestEnemies(const Vec2 & aPosition, size_t aCount, float aMaxDistance,
+	std::vector<size_t> & aEnemies)
+{
+	RefreshRectangles();
+
+	mNearestIndices.resize(aCount);
+	mNearestDistances.resize(aCount);
+	size_t found = mEnemyGrid.FindNearest((float)aPosition.x, (float)aPosition.y, aCount,
+		aMaxDistance, mNearestIndices.data(), mNearestDistances.data());
+
+	aEnemies.assign(mNearestIndices.begin(), mNearestIndices.begin() + found);
+	return found;
+}
+
+size_t EnemyGroup::FindEnemiesInRadius(const Vec2 & aCenter, float aRadius, std::vector<size_t> & aEnemies)
+{
+	RefreshRectangles();
+
+	aEnemies.clear();
+	mEnemyGrid.QueryRadius((float)aCenter.x, (float)aCenter.y, aRadius, [&](uint32_t aIndex)
+	{
+		aEnemies.push_back(aIndex);
+	});
+
+	return aEnemies.size();
+}
+
+void EnemyGroup::RefreshRectangles()
+{
+	if (!mRectanglesDirty)
+		return;
+
+	mEnemies.BuildRectangles(mEnemyRectangles);
+	mEnemyGrid.Build(mEnemyRectangles);
+
+	mBullets.Entities().BuildRectangles(mBulletRectangles);
+
+	mRectanglesDirty = false;
 }
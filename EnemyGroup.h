@@ -1,46 +1,157 @@
 #pragma once
 
 #include <vector>
-#include <iterator>
-#include <memory>
-#include <time.h>
-#include <stdlib.h>
-#include "Enemy.h"
-#include "Bullet.h"
-#include "BackBuffer.h"
+#include "Vec2.h"
+#include "SpriteBank.h"
+#include "EntityStore.h"
+#include "ProjectilePool.h"
+#include "SlotMap.h"
+#include "CompoundCollider.h"
+#include "Formation.h"
+#include "WaveScript.h"
+#include "Random.h"
+#include "RectangleSoA.h"
+#include "Broadphase.h"
+#include "SpatialGrid.h"
+#include "JobSystem.h"
+#include "WorldSnapshot.h"
+#include "FlowField.h"
+#include "Platform.h"
 
 class EnemyGroup
 {
 public:
-	using Iter = std::vector<std::unique_ptr<EnemyBullet>>::iterator;
-	using ConstIter = std::vector<std::unique_ptr<EnemyBullet>>::const_iterator;
+	// Enemy bullets alive at once, unless the constructor is told otherwise.
+	static const size_t kDefaultMaxBullets = 256;
 
-	EnemyGroup(const BackBuffer * aBackBuffer);
+	// aSeed drives every random choice of the group (who fires).
+	// aMaxBullets caps the enemy bullets alive at once; more are dropped.
+	EnemyGroup(SpriteBank * aSprites, uint64_t aSeed, size_t aMaxBullets = kDefaultMaxBullets);
 
-	void GenerateEnemies();
+	// Compiles the wave script, read through aPlatform, and starts its
+	// first wave. Returns false and leaves the reason in aError if the
+	// file is missing or invalid.
+	bool LoadWaves(IPlatform & aPlatform, const char * szFileName, std::string & aError);
 
-	bool HandleBullet(Bullet & aBullet);
+	// Starts the first wave of a script that compiled.
+	void SetWaves(const WaveScript & aScript);
+
+	// Applies bullet aBullet of aBullets to an enemy. Returns true if it
+	// hit; aDestroyed is set when the enemy should be removed.
+	bool HitEnemy(size_t aEnemy, const EntityStore & aBullets, size_t aBullet, bool & aDestroyed);
+
+	// HitEnemy in two halves. TestHit only reads, so many pairs can be
+	// tested at once: it returns the part hit (0 for small enemies) or -1.
+	// ApplyHit then applies the result, in pair order, and gives the same
+	// outcome as HitEnemy even if earlier hits destroyed that part.
+	int  TestHit(size_t aEnemy, const EntityStore & aBullets, size_t aBullet) const;
+	bool ApplyHit(size_t aEnemy, const EntityStore & aBullets, size_t aBullet, int aPart, bool & aDestroyed);
+
+	// Area damage at a point; true if the enemy should be removed.
+	bool DamageEnemy(size_t aEnemy, const Vec2 & aPoint, int aAmount);
+
+	// Damage to a known part, as returned by Raycast; true if the enemy
+	// should be removed.
+	bool DamageEnemyPart(size_t aEnemy, int aPart, int aAmount);
+
+	size_t GetScoreValue(size_t aEnemy) const;
+
+	// Stable handle of the enemy currently at aEnemy. Handles survive other
+	// enemies being removed; indices do not.
+	SlotHandle GetEnemyHandle(size_t aEnemy) const;
+
+	// O(1) per enemy; stale handles are ignored.
+	void RemoveEnemies(const SlotHandle * aEnemies, size_t aCount);
 
 	bool IsEmpty() const;
 
-	void Draw();
+	size_t GetEnemyCount() const;
+
+	// Draws at aAlpha of the way from the previous tick to the current one.
+	void Draw(float aAlpha);
+
+	// Where the players are, for waves that chase them. Set before each
+	// Update; an empty list (everyone shot down) stops the chase.
+	void SetTargets(const Vec2 * aTargets, size_t aCount);
 
-	void ShootRandom();
+	// Runs the wave script (spawns, enemy fire, next wave once cleared),
+	// moves enemies and bullets; bullets leaving the bounds are dropped,
+	// and chasers steer by a flow field over them. The movement is split
+	// across aJobs if given. The bounds must be the fixed play area, the
+	// same on every peer and in every replay, or the worlds drift apart.
+	void Update(float aTimeElapsed, int32_t aLeft, int32_t aTop, int32_t aRight, int32_t aBottom,
+		JobSystem * aJobs = nullptr);
 
-	void Update(float aTimeElapsed);
+	const EntityStore & GetBullets() const;
+	const ProjectilePool & GetBulletPool() const;
+	const FlowField & GetFlowField() const;
 
-	Iter begin();
+	// Wave progress, enemies, bosses and bullets, see WorldSnapshot. The
+	// wave script is not included; load into a group running the same one.
+	void SaveState(WorldSnapshot & aSnapshot) const;
+	bool LoadState(SnapshotReader & aReader);
 
-	Iter end();
+	void AddColliders(Broadphase & aBroadphase);
 
-	ConstIter cbegin() const;
+	// Pixel exact segment query against the enemies (aDir normalised).
+	// Bosses are tested part by part, so destroyed parts let the ray
+	// through; aPart is the part hit (0 for small enemies).
+	bool Raycast(const Vec2 & aOrigin, const Vec2 & aDir, float aMaxDistance, RayHit & aHit,
+		int & aPart);
 
-	ConstIter cend() const;
+	// Target queries for homing / auto-aim and area damage. Results are
+	// enemy indices, valid until the group is next modified.
+	size_t FindNearestEnemies(const Vec2 & aPosition, size_t aCount, float aMaxDistance,
+		std::vector<size_t> & aEnemies);
+	size_t FindEnemiesInRadius(const Vec2 & aCenter, float aRadius, std::vector<size_t> & aEnemies);
 
 private:
-	static const int kEnemyNumber;
-	static const int kEnemiesOnLine;
-	std::vector<std::unique_ptr<Enemy>> mEnemies;
-	std::vector<std::unique_ptr<EnemyBullet>> mBullets;
-	const BackBuffer * mBackBuffer;
+	void StartWave(size_t aWave);
+	void SpawnEvent(const WaveEvent & aEvent);
+	void AddBossCollider();
+	void FireVolley(const FirePattern & aPattern);
+	void AddEnemy(const Vec2 & aSlot, SpriteId aSprite, int32_t aCollider,
+		uint16_t aPath, float aTimeOffset);
+	void RefreshRectangles();
+
+	static const int kBossPartSize;
+	static const int kBossPartHitPoints;
+	static const float kChaseStandOff;
+
+	// Compiled waves; mEventCursor is the next event of the current wave.
+	WaveScript mScript;
+	size_t mWave;
+	size_t mEventCursor;
+	float mFireTimer;
+	Random mRandom;
+
+	SpriteBank * mSprites;
+	EntityStore mEnemies;
+	SlotMap mEnemySlots;
+
+	// Enemy movement: positions are evaluated from the wave clock.
+	Formation mFormation;
+	float mWaveTime;
+	ProjectilePool mBullets;
+
+	// Chasing waves drift the formation slots along a field toward the
+	// targets; the field follows from the targets, so it is not saved.
+	FlowField mFlowField;
+	float mTargetX[FlowField::kMaxTargets];
+	float mTargetY[FlowField::kMaxTargets];
+	size_t mTargetCount;
+
+	// Compound colliders of the bosses, indexed by the enemy collider
+	// component. Cleared with each new wave.
+	std::vector<CompoundCollider> mBossColliders;
+
+	// Broadphase boxes mirroring mEnemies / mBullets, rebuilt when dirty.
+	RectangleSoA mEnemyRectangles;
+	RectangleSoA mBulletRectangles;
+	SpatialGrid mEnemyGrid;
+	bool mRectanglesDirty;
+
+	// Scratch for FindNearestEnemies.
+	std::vector<uint32_t> mNearestIndices;
+	std::vector<float> mNearestDistances;
 };
@@ -0,0 +1,51 @@
+//-----------------------------------------------------------------------------
+// File: AllocationCounter.h
+//
+// Desc: Counts every heap allocation made through operator new, by
+//	   replacing the global allocation functions. The counts are atomic, so
+//	   every thread is seen.
+//
+//	   The frame loop brackets each frame with BeginFrame / EndFrame to get
+//	   that frame's allocations. Once the game has warmed up a frame should
+//	   make none; ExpectNoAllocations turns that goal into an assert.
+//-----------------------------------------------------------------------------
+
+#ifndef _ALLOCATIONCOUNTER_H_
+#define _ALLOCATIONCOUNTER_H_
+
+//-----------------------------------------------------------------------------
+// AllocationCounter Specific Includes
+//-----------------------------------------------------------------------------
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Main Structure Declarations
+//-----------------------------------------------------------------------------
+struct AllocationStats
+{
+	uint64_t mAllocations;
+	uint64_t mBytes;
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : AllocationCounter (Class)
+// Desc : Process wide allocation totals and per frame deltas.
+//-----------------------------------------------------------------------------
+class AllocationCounter
+{
+public:
+	// Since the process started.
+	static AllocationStats Total();
+
+	// Returns what was allocated since the matching BeginFrame, asserting
+	// it was nothing while ExpectNoAllocations is on.
+	static void            BeginFrame();
+	static AllocationStats EndFrame();
+
+	static void ExpectNoAllocations(bool bExpect);
+};
+
+#endif // _ALLOCATIONCOUNTER_H_
@@ -0,0 +1,37 @@
+//-----------------------------------------------------------------------------
+// File: BitmapFile.h
+//
+// Desc: Reads .bmp sprite masks without GDI, so the collision masks can be
+//	   built on any platform. Only uncompressed files are read, which is all
+//	   the game ships: 1, 4 and 8 bpp with a palette, 24 and 32 bpp, rows
+//	   stored either way up.
+//-----------------------------------------------------------------------------
+
+#ifndef _BITMAPFILE_H_
+#define _BITMAPFILE_H_
+
+//-----------------------------------------------------------------------------
+// BitmapFile Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "CollisionMask.h"
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : BitmapFile (Class)
+// Desc : Decoding of whole files, as read by IPlatform::LoadFile.
+//-----------------------------------------------------------------------------
+class BitmapFile
+{
+public:
+	// Fills aMask from a mask bitmap: its dark pixels (r + g + b < 384)
+	// are the ones the sprite image is drawn on, and so the opaque ones.
+	// False if aFile is not a bitmap this can read.
+	static bool DecodeMask(const std::vector<uint8_t> & aFile, CollisionMask & aMask);
+};
+
+#endif // _BITMAPFILE_H_
@@ -0,0 +1,66 @@
+//-----------------------------------------------------------------------------
+// File: Broadphase.h
+//
+// Desc: Layered broadphase. Owners register their RectangleSoA per layer
+//	   each frame; FindPairs runs the batched overlap kernel only for the
+//	   layer pairs the CollisionMatrix allows, so pairs that can never
+//	   interact are never generated.
+//-----------------------------------------------------------------------------
+
+#ifndef _BROADPHASE_H_
+#define _BROADPHASE_H_
+
+//-----------------------------------------------------------------------------
+// Broadphase Specific Includes
+//-----------------------------------------------------------------------------
+#include <vector>
+#include "CollisionLayers.h"
+#include "RectangleSoA.h"
+
+class JobSystem;
+
+//-----------------------------------------------------------------------------
+// Name : CollisionPair (Struct)
+// Desc : Candidate pair. Indices are into the stores registered for each
+//		layer; mFirstLayer <= mSecondLayer.
+//-----------------------------------------------------------------------------
+struct CollisionPair
+{
+	CollisionLayer mFirstLayer;
+	CollisionLayer mSecondLayer;
+	uint32_t       mFirst;
+	uint32_t       mSecond;
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : Broadphase (Class)
+// Desc : Generates candidate pairs between registered layers.
+//-----------------------------------------------------------------------------
+class Broadphase
+{
+public:
+	Broadphase();
+
+	CollisionMatrix &       Matrix()       { return mMatrix; }
+	const CollisionMatrix & Matrix() const { return mMatrix; }
+
+	void ClearLayers();
+	void SetLayer(CollisionLayer aLayer, const RectangleSoA * aRectangles);
+
+	// Replaces the contents of aPairs with all candidate pairs, in the
+	// same order whether or not the rows were split across aJobs.
+	void FindPairs(std::vector<CollisionPair> & aPairs, JobSystem * aJobs = nullptr);
+
+private:
+	CollisionMatrix       mMatrix;
+	const RectangleSoA *  mLayers[LAYER_COUNT];
+	std::vector<uint32_t> mHitMasks;
+
+	// Pairs found by each chunk of rows, appended in chunk order.
+	std::vector<std::vector<CollisionPair> > mChunkPairs;
+};
+
+#endif // _BROADPHASE_H_
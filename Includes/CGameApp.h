@@ -21,7 +21,20 @@ using namespace std;
 #include "CPlayer.h"
 #include "BackBuffer.h"
 #include "ImageFile.h"
-#include "../EnemyGroup.h"
+#include "GameWorld.h"
+#include "SpriteBank.h"
+#include "InputLog.h"
+#include "InputQueue.h"
+#include "LatencyHistogram.h"
+#include "Profiler.h"
+#include "FrameArena.h"
+#include "AllocationCounter.h"
+#include "JobSystem.h"
+#include "WorldSnapshot.h"
+#include "RollbackSession.h"
+#include "NetTransport.h"
+#include "UdpTransport.h"
+#include "Platform.h"
 
 //-----------------------------------------------------------------------------
 // Forward Declarations
@@ -34,8 +47,11 @@ using namespace std;
 //-----------------------------------------------------------------------------
 // Name : CGameApp (Class)
 // Desc : Central game engine, initialises the game and handles core processes.
+//		The simulation itself is the GameWorld; in a networked game this
+//		passes the session's ticks on to it, following the input to the
+//		screen on the way.
 //-----------------------------------------------------------------------------
-class CGameApp
+class CGameApp : private IRollbackWorld
 {
 public:
 	//-------------------------------------------------------------------------
@@ -61,10 +77,29 @@ private:
 	void		FrameAdvance	  ( );
 	bool		CreateDisplay	 ( );
 	void		ChangeDevice	  ( );
-	void		SetupGameState	( );
-	void		AnimateObjects	( );
-	void		DrawObjects	   ( );
-	void		ProcessInput	  ( );
+	void		ParseCommandLine  ( LPCTSTR lpCmdLine );
+	int		 RunReplay		 ( );
+	int		 RunReplayCheck	( );
+	ULONG		ReplayLog		 ( );
+	bool		OpenNetwork	   ( );
+	void		WriteTrace		( );
+	void		RunLocalTick	  ( USHORT Buttons );
+	void		DrawObjects	   ( float fAlpha );
+	USHORT		PollInput		 ( int64_t TickEnd, uint32_t Tick );
+	void		QueueKey		  ( USHORT Key, bool bDown );
+	void		InputTickRan	  ( uint32_t Tick, bool bRan );
+	void		RecordInputLatency( );
+	void		DrawBeam		  ( int Player );
+	void		DrawNetworkNotice ( );
+
+	// Player 1 is the other peer's plane, in a networked game.
+	CPlayer *	GetPlayer		 ( int Player ) const { return mWorld->GetPlayer( Player ); }
+	CPlayer *	GetLocalPlayer	( ) const { return GetPlayer( mSession ? (int)mSession->LocalPlayer() : 0 ); }
+
+	// IRollbackWorld
+	void		SaveState		 ( WorldSnapshot & Snapshot ) override;
+	bool		LoadState		 ( const WorldSnapshot & Snapshot ) override;
+	void		SimulateTick	  ( const uint16_t Buttons[], bool bReplaying ) override;
     void    DrawBackground();
 	
 	//-------------------------------------------------------------------------
@@ -76,13 +111,16 @@ private:
 	// Private Variables For This Class
 	//-------------------------------------------------------------------------
 	CTimer				  m_Timer;			// Game timer
+	float				   mLockFPS;		   // -fps <n>: frame rate cap, 0 for none
 	ULONG				   m_LastFrameRate;	// Used for making sure we update only when fps changes.
+	double				  m_TickAccumulator;  // Real time not yet simulated, seconds
 	
 	HWND					m_hWnd;			 // Main window HWND
 	HICON				   m_hIcon;			// Window Icon
 	HMENU				   m_hMenu;			// Window Menu
 	
 	bool					m_bActive;		  // Is the application active ?
+	bool					m_bForeground;	  // Does the application have the focus ?
 
 	ULONG				   m_nViewX;		   // X Position of render viewport
 	ULONG				   m_nViewY;		   // Y Position of render viewport
@@ -95,11 +133,70 @@ private:
 	CImageFile				m_imgBackground;
 
 	BackBuffer*				m_pBBuffer;
-	CPlayer*				m_pPlayer;
-  CPlayer*				m_pSecondPlayer;
+  std::unique_ptr<IPlatform> mPlatform;	// Win32 window, or headless for replays
+  std::unique_ptr<SpriteBank> mSpriteBank;
+  std::unique_ptr<GameWorld> mWorld;	// Two planes in a networked game
+
+  // Movement, broadphase rows and mask tests are spread over the workers;
+  // -threads <n> sets the total, 1 runs everything on this thread.
+  std::unique_ptr<JobSystem> mJobs;
+  unsigned mThreadCount;
+
+  // Every tick's input is recorded; with -record <file> the log is saved
+  // on exit, -replay <file> runs a saved log headless at full speed and
+  // -replaycheck records and replays a scripted session.
+  InputLog mInputLog;
+  uint64_t mSeed;
+  InputQueue mInputQueue;	// Key changes not yet seen by a tick
+  bool mKeyHeld[kPlatformKeyCount];	// Key state as of the last tick
+  uint32_t mNextInputId;
+
+  // Key events waiting for the tick that applies them (the polling tick,
+  // or with network input delay a later one) and then for the present
+  // after it. Ids below mShownInputId have had their tick run, so the
+  // next present is the first to show them; its end, less each one's
+  // arrival, is recorded. Events whose tick is frozen on the game over
+  // screen change nothing and are dropped.
+  struct TickInput
+  {
+	  InputEvent mEvent;
+	  uint32_t mTick;
+  };
+  std::vector<TickInput> mUnpresentedInput;
+  uint32_t mShownInputId;
+  uint32_t mLocalTick;	// Local game ticks so far, run or skipped
+  LatencyHistogram mInputLatency;
+  std::string mRecordFile;
+  std::string mReplayFile;
+  std::string mTraceFile;	// -trace: profiler events are saved here on exit
+  bool mReplay;
+  bool mReplayCheck;
+
+  // Transient containers come from the arena, which is reset every frame;
+  // mFrameAllocations is what the last frame took from the heap.
+  FrameArena mFrameArena;
+  AllocationStats mFrameAllocations;
+  ULONG mFrameCount;
+  bool mNoAllocations;	// -noalloc: assert allocation free frames
+
+  // INPUT_RESTART (F5, or playing again after game over) takes the world
+  // back to how it started, without reloading.
+  bool mRestartPending;	// Asked for, until the game is no longer over
+  bool mRestartSent;	// INPUT_RESTART already given to a tick
 
-  std::unique_ptr<EnemyGroup> mEnemyGroup;
-  std::vector<Bullet> mFiredBullets;
+  // Two player game over UDP: -host <port> or -join <host:port>. Both
+  // peers run the whole game from the same seed (-seed, or a fixed one)
+  // and exchange only their inputs; -delay <ticks> sets the input delay
+  // and -netsim <ms> <loss %> adds latency and loss for testing.
+  std::unique_ptr<UdpTransport> mUdp;
+  std::unique_ptr<LossyTransport> mNetShim;
+  std::unique_ptr<RollbackSession> mSession;
+  uint16_t mHostPort;
+  std::string mJoinAddress;
+  unsigned mInputDelay;
+  double mNetLatency;	// -netsim, milliseconds one way
+  double mNetLoss;		// -netsim, percent
+  bool mSeedGiven;
 };
 
 #endif // _CGAMEAPP_H_
\ No newline at end of file
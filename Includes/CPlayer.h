@@ -14,11 +14,14 @@
 // CPlayer Specific Includes
 //-----------------------------------------------------------------------------
 #include <vector>
-#include "Main.h"
-#include "Sprite.h"
-#include "Bullet.h"
+#include "Vec2.h"
+#include "SpriteBank.h"
+#include "ProjectilePool.h"
 #include "../EnemyGroup.h"
 #include "../IPlayer.h"
+#include "Broadphase.h"
+#include "Platform.h"
+#include "WorldSnapshot.h"
 
 //-----------------------------------------------------------------------------
 // Main Class Definitions
@@ -33,7 +36,13 @@ public:
 	//-------------------------------------------------------------------------
 	// Enumerators
 	//-------------------------------------------------------------------------
-	using DIRECTION = Bullet::DIRECTION;
+	enum DIRECTION
+	{
+		DIR_FORWARD = 1,
+		DIR_BACKWARD = 2,
+		DIR_LEFT = 4,
+		DIR_RIGHT = 8,
+	};
 
 	enum ESpeedStates
 	{
@@ -44,17 +53,20 @@ public:
 	//-------------------------------------------------------------------------
 	// Constructors & Destructors for This Class.
 	//-------------------------------------------------------------------------
-	CPlayer(const BackBuffer *pBackBuffer, std::vector<Bullet> & aFiredBullets);
+	CPlayer(SpriteBank *pSprites, ProjectilePool & aFiredBullets, IPlatform *pPlatform);
 	virtual ~CPlayer();
 
 	//-------------------------------------------------------------------------
 	// Public Functions for This Class.
 	//-------------------------------------------------------------------------
-	void					Update(float dt, const RECT & rectangle);
-	void					Draw();
-	void					Move(ULONG ulDirection);
+	// The plane stops at, and its bullets are dropped past, the edges of
+	// the play area.
+	void					Update(float dt, int32_t aLeft, int32_t aTop, int32_t aRight, int32_t aBottom);
+	void					Draw(float fAlpha);
+	void					Move(uint32_t ulDirection, float dt);
 	Vec2&					Position();
 	Vec2&					Velocity();
+	void					Teleport(const Vec2& position);	// Moves without interpolating
 
 	void					Explode();
 	bool					AdvanceExplosion();
@@ -62,37 +74,59 @@ public:
 
 	void Shoot();
 
-	void ShootEnemies(EnemyGroup & aEnemyGroup);
-
 	void ResetXVelocity();
 	void ResetYVelocity();
 
 	void RotateLeft();
 	void RotateRight();
 
+	Vec2 GetFacingVector() const;
+
 	int GetLives();
 	size_t GetScore();
+	void AddScore(size_t aPoints);
 
-	bool GetShot(EnemyGroup & aEnemyGroup);
+	void AddColliders(Broadphase & aBroadphase);
 
-	bool IsShot(const Bullet * aBullet) const;
+	bool IsShot(const EntityStore & aBullets, size_t aBullet) const;
 
 	void DecreaseLives();
+	void SetLives(int aLives);
+
+	// Position, motion, timers, lives and score, see WorldSnapshot. The
+	// fired bullets belong to the pool's owner and are saved there.
+	void SaveState(WorldSnapshot & aSnapshot) const;
+	bool LoadState(SnapshotReader & aReader);
 
 private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class.
+	//-------------------------------------------------------------------------
+	static SpriteId			FacingSprite(DIRECTION eDirection);
+	void					SetFacing(DIRECTION eDirection);
+	void					GetBounds(int32_t & aLeft, int32_t & aTop, int32_t & aRight, int32_t & aBottom) const;
+
 	//-------------------------------------------------------------------------
 	// Private Variables for This Class.
 	//-------------------------------------------------------------------------
-	Sprite*					m_pSprite;
+	Vec2					mPosition;
+	Vec2					mVelocity;
+	Vec2					mPreviousPosition;	// At the previous simulation tick
 	ESpeedStates			m_eSpeedState;
 	float					m_fTimer;
 
 	bool					m_bExplosion;
-	AnimatedSprite*			m_pExplosionSprite;
-	int						m_iExplosionFrame;
+	Vec2					mExplosionPosition;
+	int						m_iExplosionFrame;	// Frames shown so far
+	float					m_fExplosionTimer;	// Time into the current explosion frame
+	float					m_fShotCooldown;	// Time until the next shot is allowed
+
+	SpriteBank * mSprites;
+	ProjectilePool & mFiredBullets;
+	IPlatform * mPlatform;		// Plays the engine and explosion sounds
 
-	const BackBuffer * mBackBuffer;
-	std::vector<Bullet> & mFiredBullets;
+	RectangleSoA mPlayerRectangle;
+	RectangleSoA mBulletRectangles;
 
 	DIRECTION mFacingDirection;
 	int mLives;
@@ -14,19 +14,21 @@
 //-----------------------------------------------------------------------------
 // CTimer Specific Includes
 //-----------------------------------------------------------------------------
-#include "Main.h"
+#include <stddef.h>
+#include <stdint.h>
+#include "Platform.h"
 
 //-----------------------------------------------------------------------------
 // Definitions, Macros & Constants
 //-----------------------------------------------------------------------------
-const ULONG MAX_SAMPLE_COUNT = 50; // Maximum frame time sample count
+const uint32_t MAX_SAMPLE_COUNT = 50; // Maximum frame time sample count
 
 //-----------------------------------------------------------------------------
 // Main Class Declarations
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 // Name : CTimer (Class)
-// Desc : Game Timer class, queries performance hardware if available, and 
+// Desc : Game Timer class, reads the platform's high resolution clock, and 
 //		calculates all the various values required for frame rate based
 //		vector / value scaling.
 //-----------------------------------------------------------------------------
@@ -43,22 +45,31 @@ public:
 	// Public Functions For This Class
 	//------------------------------------------------------------
 	void			Tick( float fLockFPS = 0.0f );
-	unsigned long	GetFrameRate( LPTSTR lpszString = NULL, size_t size = 0 ) const;
+	void			Reset();
+	unsigned long	GetFrameRate( char * lpszString = NULL, size_t size = 0 ) const;
 	float			GetTimeElapsed() const;
+	float			GetRawTimeElapsed() const;
+
+	// Frame time statistics over the sample window (Seconds)
+	float			GetFrameTimeMin() const;
+	float			GetFrameTimeMax() const;
+	float			GetFrameTimePercentile( float fPercentile ) const;
 
 private:
 	//------------------------------------------------------------
 	// Private Variables For This Class
 	//------------------------------------------------------------
-	bool			m_PerfHardware;			 // Has Performance Counter
-	float			m_TimeScale;				// Amount to scale counter
+	double			m_TimeScale;				// Seconds per clock tick
 	float			m_TimeElapsed;			  // Time elapsed since previous frame
-	__int64			m_CurrentTime;			  // Current Performance Counter
-	__int64			m_LastTime;				 // Performance Counter last frame
-	__int64			m_PerfFreq;				 // Performance Frequency
+	float			m_RawTimeElapsed;		   // Same, before averaging
+	int64_t			m_CurrentTime;			  // Current clock reading
+	int64_t			m_LastTime;				 // Clock reading last frame
 
-	float			m_FrameTime[MAX_SAMPLE_COUNT];
-	ULONG			m_SampleCount;
+	float			m_FrameTime[MAX_SAMPLE_COUNT];	// Ring of recent frame times
+	uint32_t		m_SampleCount;			  // Valid samples in the ring
+	uint32_t		m_NextSample;			   // Ring slot the next sample goes in
+	double			m_SampleSum;				// Running sum of the valid samples
+	double			m_SpinMargin;			   // Limiter spins, rather than sleeps, this close to the target
 
 	unsigned long	m_FrameRate;				// Stores current framerate
 	unsigned long	m_FPSFrameCount;			// Elapsed frames in any given second
@@ -67,6 +78,8 @@ private:
 	//------------------------------------------------------------
 	// Private Functions For This Class
 	//------------------------------------------------------------
+	void			WaitUntil( int64_t Target );
+	void			AddSample( float fTimeElapsed );
 };
 
 #endif // _CTIMER_H_
\ No newline at end of file
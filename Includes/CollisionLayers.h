@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------
+// File: CollisionLayers.h
+//
+// Desc: Collision layers and the layer-pair filter matrix. Every collider
+//	   belongs to exactly one layer; the broadphase only generates pairs for
+//	   layer pairs enabled in the matrix.
+//-----------------------------------------------------------------------------
+
+#ifndef _COLLISIONLAYERS_H_
+#define _COLLISIONLAYERS_H_
+
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Enumerators
+//-----------------------------------------------------------------------------
+enum CollisionLayer
+{
+	LAYER_PLAYER,
+	LAYER_PLAYER_BULLET,
+	LAYER_ENEMY,
+	LAYER_ENEMY_BULLET,
+	LAYER_PICKUP,
+
+	LAYER_COUNT
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CollisionMatrix (Class)
+// Desc : Symmetric layer x layer table, one bit per pair.
+//-----------------------------------------------------------------------------
+class CollisionMatrix
+{
+public:
+	CollisionMatrix()
+	{
+		DisableAll();
+	}
+
+	void DisableAll()
+	{
+		for (int i = 0; i < LAYER_COUNT; ++i)
+			mMasks[i] = 0;
+	}
+
+	void Enable(CollisionLayer aFirst, CollisionLayer aSecond, bool aEnable = true)
+	{
+		if (aEnable)
+		{
+			mMasks[aFirst]  |= 1u << aSecond;
+			mMasks[aSecond] |= 1u << aFirst;
+		}
+		else
+		{
+			mMasks[aFirst]  &= ~(1u << aSecond);
+			mMasks[aSecond] &= ~(1u << aFirst);
+		}
+	}
+
+	bool CanCollide(CollisionLayer aFirst, CollisionLayer aSecond) const
+	{
+		return (mMasks[aFirst] >> aSecond) & 1u;
+	}
+
+	uint32_t GetMask(CollisionLayer aLayer) const
+	{
+		return mMasks[aLayer];
+	}
+
+private:
+	uint32_t mMasks[LAYER_COUNT];
+};
+
+#endif // _COLLISIONLAYERS_H_
@@ -0,0 +1,72 @@
+//-----------------------------------------------------------------------------
+// File: CollisionMask.h
+//
+// Desc: Bit-packed opacity mask used for pixel exact collision queries.
+//	   Rows are stored top-down, 32 pixels per word, least significant bit
+//	   first. A set bit is an opaque (collidable) pixel.
+//-----------------------------------------------------------------------------
+
+#ifndef _COLLISIONMASK_H_
+#define _COLLISIONMASK_H_
+
+//-----------------------------------------------------------------------------
+// CollisionMask Specific Includes
+//-----------------------------------------------------------------------------
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CollisionMask (Class)
+// Desc : Width x height bitmask with ray marching support.
+//-----------------------------------------------------------------------------
+class CollisionMask
+{
+public:
+	CollisionMask();
+	CollisionMask(int aWidth, int aHeight);
+
+	void Resize(int aWidth, int aHeight);
+
+	int  Width() const  { return mWidth; }
+	int  Height() const { return mHeight; }
+	bool IsEmpty() const { return mWidth == 0 || mHeight == 0; }
+
+	void SetOpaque(int aX, int aY, bool aOpaque = true);
+	bool IsOpaque(int aX, int aY) const
+	{
+		if (aX < 0 || aY < 0 || aX >= mWidth || aY >= mHeight)
+			return false;
+
+		return (mBits[aY * mRowWords + (aX >> 5)] >> (aX & 31)) & 1u;
+	}
+
+	// Copies the aWidth x aHeight block at (aX, aY); pixels outside are clear.
+	CollisionMask Crop(int aX, int aY, int aWidth, int aHeight) const;
+
+	// Tight bounds of the opaque pixels; false if there are none.
+	bool GetOpaqueBounds(int & aLeft, int & aTop, int & aRight, int & aBottom) const;
+
+	// True if any opaque pixel of aOther, placed with its top-left corner
+	// at (aOffsetX, aOffsetY) in this mask, covers an opaque pixel here.
+	bool Overlaps(const CollisionMask & aOther, int aOffsetX, int aOffsetY) const;
+
+	// Marches a ray given in mask local pixel coordinates (aDirX/aDirY must
+	// be normalised) and returns the distance to the first opaque pixel
+	// in [aMinT, aMaxT].
+	bool Raycast(float aX, float aY, float aDirX, float aDirY,
+	             float aMinT, float aMaxT, float & aHitT) const;
+
+private:
+	// 32 pixels of row aY starting at column aX (any alignment).
+	uint32_t GetBits(int aX, int aY) const;
+
+	int mWidth;
+	int mHeight;
+	int mRowWords;
+	std::vector<uint32_t> mBits;
+};
+
+#endif // _COLLISIONMASK_H_
@@ -0,0 +1,104 @@
+//-----------------------------------------------------------------------------
+// File: CompoundCollider.h
+//
+// Desc: Collider made of several independently damageable parts, each with
+//	   its own box and sub-mask, kept in a small bounding volume hierarchy.
+//	   Large sprites (bosses) use it so a bullet near them is rejected by a
+//	   couple of box tests and only ever mask-tested against one small part.
+//
+//	   All coordinates are local to the owner's top-left corner.
+//-----------------------------------------------------------------------------
+
+#ifndef _COMPOUNDCOLLIDER_H_
+#define _COMPOUNDCOLLIDER_H_
+
+//-----------------------------------------------------------------------------
+// CompoundCollider Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "CollisionMask.h"
+
+class WorldSnapshot;
+class SnapshotReader;
+
+//-----------------------------------------------------------------------------
+// Name : ColliderPart (Struct)
+// Desc : One damageable piece. mMask covers [mLeft, mRight] x [mTop, mBottom].
+//-----------------------------------------------------------------------------
+struct ColliderPart
+{
+	int32_t       mLeft;
+	int32_t       mTop;
+	int32_t       mRight;
+	int32_t       mBottom;
+	CollisionMask mMask;
+	int           mHitPoints;
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CompoundCollider (Class)
+// Desc : Parts + bounding hierarchy; destroyed parts drop out of the bounds.
+//-----------------------------------------------------------------------------
+class CompoundCollider
+{
+public:
+	CompoundCollider();
+
+	// Splits aMask into aPartSize square tiles, drops the empty ones and
+	// shrinks the rest to their opaque pixels.
+	void BuildFromMask(const CollisionMask & aMask, int aPartSize, int aHitPoints);
+
+	size_t PartCount() const     { return mParts.size(); }
+	size_t LivePartCount() const { return mLiveParts; }
+	bool   IsDestroyed() const   { return mLiveParts == 0; }
+
+	const ColliderPart & GetPart(size_t aIndex) const { return mParts[aIndex]; }
+
+	// First live part whose mask overlaps aOther placed at (aOffsetX,
+	// aOffsetY), or -1.
+	int HitTest(const CollisionMask & aOther, int aOffsetX, int aOffsetY) const;
+
+	// Nearest live part along a ray (aDir normalised) within [aMinT,
+	// aMaxT]. Returns the part and sets aHitT to its first opaque pixel,
+	// or -1 if the ray only meets destroyed parts or misses.
+	int Raycast(float aX, float aY, float aDirX, float aDirY,
+	            float aMinT, float aMaxT, float & aHitT) const;
+
+	// Live part closest to a point, or -1 if everything is destroyed.
+	int PartNear(int aX, int aY) const;
+
+	// Returns true if this destroyed the part.
+	bool Damage(int aPart, int aAmount);
+
+	// Part hit points only, see WorldSnapshot; the parts themselves come
+	// from the mask. Loading needs a collider built from the same mask.
+	void SaveState(WorldSnapshot & aSnapshot) const;
+	bool LoadState(SnapshotReader & aReader);
+
+private:
+	struct Node
+	{
+		int32_t mLeft;
+		int32_t mTop;
+		int32_t mRight;
+		int32_t mBottom;
+		int32_t mFirst;		// First entry in mOrder (leaves)
+		int32_t mCount;		// Part count, 0 for inner nodes
+		int32_t mRightChild;	// Left child is always the next node
+	};
+
+	int32_t BuildNode(int32_t aFirst, int32_t aCount);
+	void    Refit(int32_t aNode);
+
+	std::vector<ColliderPart> mParts;
+	std::vector<Node>         mNodes;
+	std::vector<int32_t>      mOrder;
+	size_t                    mLiveParts;
+};
+
+#endif // _COMPOUNDCOLLIDER_H_
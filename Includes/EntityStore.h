@@ -0,0 +1,131 @@
+//-----------------------------------------------------------------------------
+// File: EntityStore.h
+//
+// Desc: Structure-of-arrays storage for the many small game objects (enemies
+//	   and projectiles). Each component lives in its own tightly packed
+//	   array and entities are kept dense, so update, draw and broadphase
+//	   passes are straight sweeps with no pointer chasing.
+//
+//	   Removal swaps the last entity into the hole: indices are only valid
+//	   until the store is next modified.
+//-----------------------------------------------------------------------------
+
+#ifndef _ENTITYSTORE_H_
+#define _ENTITYSTORE_H_
+
+//-----------------------------------------------------------------------------
+// EntityStore Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "RectangleSoA.h"
+
+class JobSystem;
+class WorldSnapshot;
+class SnapshotReader;
+
+//-----------------------------------------------------------------------------
+// Enumerators
+//-----------------------------------------------------------------------------
+// Values of the owner component.
+enum EntityOwner
+{
+	OWNER_NONE,
+	OWNER_PLAYER,
+	OWNER_ENEMY
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : EntityStore (Class)
+// Desc : Position, velocity, sprite id, collider and owner components,
+//		plus the position at the previous simulation tick for drawing
+//		between ticks. The collider is the half extent of the entity's box plus an
+//		optional index into a compound collider table (-1 = sprite mask).
+//-----------------------------------------------------------------------------
+class EntityStore
+{
+public:
+	EntityStore();
+
+	void   Clear();
+	void   Reserve(size_t aCount);
+
+	size_t Add(float aX, float aY, float aVelocityX, float aVelocityY,
+	           uint16_t aSprite, int32_t aHalfWidth, int32_t aHalfHeight,
+	           uint16_t aOwner = 0, int32_t aCollider = -1);
+	void   Remove(size_t aIndex);
+
+	// Removes every entity for which aPredicate(index) is true. Indices
+	// passed to the predicate are the ones from before the call.
+	template <typename Predicate>
+	void RemoveIf(Predicate aPredicate)
+	{
+		for (size_t i = mX.size(); i-- > 0;)
+		{
+			if (aPredicate(i))
+				Remove(i);
+		}
+	}
+
+	size_t Size() const    { return mX.size(); }
+	bool   IsEmpty() const { return mX.empty(); }
+
+	// Moves every entity along its velocity, split across aJobs if given.
+	void Integrate(float aTimeElapsed, JobSystem * aJobs = nullptr);
+
+	// Copies the current positions to the previous tick positions; called
+	// once at the start of every simulation tick.
+	void StorePrevious();
+
+	// Box of one entity, same rounding as Sprite::GetRectangle.
+	void GetBounds(size_t aIndex, int32_t & aLeft, int32_t & aTop,
+	               int32_t & aRight, int32_t & aBottom) const;
+
+	// Rebuilds aRectangles with one box per entity, in store order.
+	void BuildRectangles(RectangleSoA & aRectangles) const;
+
+	// Every component array, see WorldSnapshot.
+	void SaveState(WorldSnapshot & aSnapshot) const;
+	bool LoadState(SnapshotReader & aReader);
+
+	float *    X()         { return mX.data(); }
+	float *    Y()         { return mY.data(); }
+	float *    PreviousX() { return mPreviousX.data(); }
+	float *    PreviousY() { return mPreviousY.data(); }
+	float *    VelocityX() { return mVelocityX.data(); }
+	float *    VelocityY() { return mVelocityY.data(); }
+	uint16_t * Sprite()    { return mSprite.data(); }
+	uint16_t * Owner()     { return mOwner.data(); }
+	int32_t *  Collider()  { return mCollider.data(); }
+
+	const float *    X() const          { return mX.data(); }
+	const float *    Y() const          { return mY.data(); }
+	const float *    PreviousX() const  { return mPreviousX.data(); }
+	const float *    PreviousY() const  { return mPreviousY.data(); }
+	const float *    VelocityX() const  { return mVelocityX.data(); }
+	const float *    VelocityY() const  { return mVelocityY.data(); }
+	const uint16_t * Sprite() const     { return mSprite.data(); }
+	const uint16_t * Owner() const      { return mOwner.data(); }
+	const int32_t *  Collider() const   { return mCollider.data(); }
+	const int32_t *  HalfWidth() const  { return mHalfWidth.data(); }
+	const int32_t *  HalfHeight() const { return mHalfHeight.data(); }
+
+private:
+	std::vector<float>    mX;
+	std::vector<float>    mY;
+	std::vector<float>    mPreviousX;
+	std::vector<float>    mPreviousY;
+	std::vector<float>    mVelocityX;
+	std::vector<float>    mVelocityY;
+	std::vector<int32_t>  mHalfWidth;
+	std::vector<int32_t>  mHalfHeight;
+	std::vector<uint16_t> mSprite;
+	std::vector<uint16_t> mOwner;
+	std::vector<int32_t>  mCollider;
+};
+
+#endif // _ENTITYSTORE_H_
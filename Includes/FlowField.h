@@ -0,0 +1,92 @@
+//-----------------------------------------------------------------------------
+// File: FlowField.h
+//
+// Desc: Coarse grid flow field toward a few targets (the players), shared
+//	   by every enemy that chases them.
+//
+//	   Each cell holds its distance to the nearest target cell and the
+//	   direction to the neighbour that gets closest to one. Building it is
+//	   two raster passes over the grid (a 5-7 chamfer distance transform:
+//	   between 1% under and 7.7% over the straight line distance, the worst
+//	   at a slope of 0.4), so its cost depends on the screen size, not on
+//	   how many enemies follow it. It is rebuilt only when a target moves
+//	   into another cell; in between, and for any number of enemies,
+//	   steering is one cell lookup per enemy. The error only bends paths
+//	   slightly and inflates the stand-off distance off-axis; it does not
+//	   matter for steering toward the nearest target.
+//
+//	   The field is a function of the area and the target cells alone, so
+//	   it never needs to be part of a snapshot: a restored world rebuilds
+//	   the same one on its next Update. That holds only while the area is
+//	   part of the simulation too; the game passes its fixed play area,
+//	   never the window size, which differs between machines.
+//-----------------------------------------------------------------------------
+
+#ifndef _FLOWFIELD_H_
+#define _FLOWFIELD_H_
+
+//-----------------------------------------------------------------------------
+// FlowField Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class JobSystem;
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : FlowField (Class)
+// Desc : Distance and direction per cell toward the nearest target.
+//-----------------------------------------------------------------------------
+class FlowField
+{
+public:
+	static const size_t kMaxTargets = 4;
+
+	explicit FlowField(int32_t aCellSize = 32);
+
+	// Covers [aLeft, aRight) x [aTop, aBottom) and points at the targets
+	// (at most kMaxTargets, the rest are ignored; positions outside are
+	// clamped). Rebuilds only if the area or a target's cell changed and
+	// returns whether it did.
+	bool Update(int32_t aLeft, int32_t aTop, int32_t aRight, int32_t aBottom,
+	            const float * aTargetX, const float * aTargetY, size_t aTargetCount);
+
+	bool   HasTargets() const { return mTargetCount != 0; }
+	size_t Rebuilds() const   { return mRebuilds; }
+
+	// O(1): the unit direction to follow from (aX, aY), zero on a target
+	// cell or with no targets, and the distance to the nearest target in
+	// pixels, measured between cell centres.
+	float Sample(float aX, float aY, float & aDirX, float & aDirY) const;
+
+	// Moves every point's anchor (aAnchorX / aAnchorY) aStep pixels along
+	// the flow sampled at the point's position (aX / aY); points within
+	// aStandOff pixels of a target stay where they are. Split across
+	// aJobs if given.
+	void Steer(const float * aX, const float * aY, size_t aCount, float aStep, float aStandOff,
+	           float * aAnchorX, float * aAnchorY, JobSystem * aJobs = nullptr) const;
+
+private:
+	size_t CellAt(float aX, float aY) const;
+	void   Rebuild();
+
+	int32_t mCellSize;
+	int32_t mLeft;
+	int32_t mTop;
+	int32_t mColumns;
+	int32_t mRows;
+
+	// The cells the field was built for, in target order.
+	size_t  mTargetCells[kMaxTargets];
+	size_t  mTargetCount;
+	size_t  mRebuilds;
+
+	std::vector<uint16_t> mDistance;	// Chamfer units, 5 per cell step
+	std::vector<uint8_t>  mDirection;	// Index into the neighbour table, 8 for none
+};
+
+#endif // _FLOWFIELD_H_
@@ -0,0 +1,128 @@
+//-----------------------------------------------------------------------------
+// File: Formation.h
+//
+// Desc: Movement pattern engine for enemy waves. Each enemy follows one of a
+//	   small table of parametric paths (hold, sine sweep, dive-bomb, looping
+//	   spline) offset from its formation slot, evaluated from the wave clock.
+//
+//	   There is no per-enemy update call: enemies are bucketed by path and
+//	   every bucket is evaluated as one batch (gather, evaluate with SIMD,
+//	   scatter straight into the entity position arrays).
+//
+//	   Per enemy arrays are kept parallel to the owner's EntityStore: the
+//	   owner mirrors every Add / Remove.
+//-----------------------------------------------------------------------------
+
+#ifndef _FORMATION_H_
+#define _FORMATION_H_
+
+//-----------------------------------------------------------------------------
+// Formation Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class JobSystem;
+class WorldSnapshot;
+class SnapshotReader;
+
+//-----------------------------------------------------------------------------
+// Enumerators
+//-----------------------------------------------------------------------------
+enum PathType
+{
+	PATH_HOLD,		// Stays on its slot
+	PATH_SINE,		// Figure eight sweep around the slot
+	PATH_DIVE,		// Waits, dives off the bottom, comes back, repeats
+	PATH_SPLINE		// Closed Catmull-Rom loop through offsets from the slot
+};
+
+//-----------------------------------------------------------------------------
+// Name : FormationPath (Struct)
+// Desc : Parameters of one path. Unused fields are ignored by the type.
+//-----------------------------------------------------------------------------
+struct FormationPath
+{
+	PathType mType;
+	float    mAmplitudeX;	// Sine / dive sway, pixels
+	float    mAmplitudeY;	// Sine, pixels
+	float    mFrequency;	// Sine / dive sway radians per second, spline segments per second
+	float    mAcceleration;	// Dive, pixels per second squared
+	float    mDelay;		// Dive, seconds on the slot before diving
+	float    mPeriod;		// Dive, seconds per dive cycle
+	uint32_t mFirstPoint;	// Spline control points
+	uint32_t mPointCount;
+
+	static FormationPath Hold();
+	static FormationPath Sine(float aAmplitudeX, float aAmplitudeY, float aFrequency);
+	static FormationPath Dive(float aDelay, float aAcceleration, float aPeriod,
+	                          float aSway, float aSwayFrequency);
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : Formation (Class)
+// Desc : Path table plus per enemy path id, slot and time offset.
+//-----------------------------------------------------------------------------
+class Formation
+{
+public:
+	Formation();
+
+	// Path table, shared by all waves.
+	uint16_t AddPath(const FormationPath & aPath);
+	uint16_t AddSpline(const float * aPointsX, const float * aPointsY, uint32_t aCount,
+	                   float aSegmentsPerSecond);
+	size_t   PathCount() const { return mPaths.size(); }
+
+	// Per enemy data, parallel to the owner's store.
+	void   Add(uint16_t aPath, float aSlotX, float aSlotY, float aTimeOffset);
+	void   Remove(size_t aIndex);
+	void   Clear();
+	void   Reserve(size_t aCount);
+	size_t Size() const { return mPath.size(); }
+
+	// Formation slots, for steering the whole formation of each enemy.
+	float * SlotX() { return mSlotX.data(); }
+	float * SlotY() { return mSlotY.data(); }
+
+	// Per enemy data, see WorldSnapshot; the path table is not included.
+	void SaveState(WorldSnapshot & aSnapshot) const;
+	bool LoadState(SnapshotReader & aReader);
+
+	// Writes every enemy's position at wave time aTime into aX / aY,
+	// split across aJobs if given.
+	void Evaluate(float aTime, float * aX, float * aY, JobSystem * aJobs = nullptr);
+
+private:
+	void RebuildBuckets();
+	void EvaluateRange(size_t aBegin, size_t aEnd, float aTime, float * aX, float * aY);
+	void EvaluateBucket(const FormationPath & aPath, size_t aFirst, size_t aCount,
+	                    float aTime, float * aX, float * aY);
+
+	std::vector<FormationPath> mPaths;
+	std::vector<float>         mPointX;
+	std::vector<float>         mPointY;
+
+	std::vector<uint16_t> mPath;
+	std::vector<float>    mSlotX;
+	std::vector<float>    mSlotY;
+	std::vector<float>    mTimeOffset;
+
+	// Enemy indices grouped by path, rebuilt only when enemies come or go.
+	std::vector<uint32_t> mOrder;
+	std::vector<uint32_t> mBucketStart;
+	std::vector<uint32_t> mBucketCursor;	// Scratch for the rebuild
+	bool                  mBucketsDirty;
+
+	// Gathered batch inputs / outputs, parallel to mOrder so every chunk
+	// of a parallel evaluation has its own slice; reused every frame.
+	std::vector<float> mTime;
+	std::vector<float> mOutX;
+	std::vector<float> mOutY;
+};
+
+#endif // _FORMATION_H_
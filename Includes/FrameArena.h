@@ -0,0 +1,110 @@
+//-----------------------------------------------------------------------------
+// File: FrameArena.h
+//
+// Desc: Linear allocator for memory that only lives until the end of the
+//	   frame. Allocation bumps an offset in one block reserved up front,
+//	   freeing is a no-op, and Reset at the end of the frame takes the
+//	   offset back to zero, so transient containers cost no heap traffic.
+//
+//	   ArenaVector<T> is a std::vector that allocates from an arena. Reserve
+//	   it up front where the size is known: growing leaves the old buffer
+//	   behind until the reset.
+//
+//	   A request that does not fit falls back to the heap and is counted,
+//	   so an undersized arena shows up in the stats instead of failing.
+//-----------------------------------------------------------------------------
+
+#ifndef _FRAMEARENA_H_
+#define _FRAMEARENA_H_
+
+//-----------------------------------------------------------------------------
+// FrameArena Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : FrameArena (Class)
+// Desc : One fixed block, bump allocated, reset once per frame.
+//-----------------------------------------------------------------------------
+class FrameArena
+{
+public:
+	explicit FrameArena(size_t aCapacity);
+	~FrameArena();
+
+	void * Allocate(size_t aSize, size_t aAlignment);
+	void   Deallocate(void * aPointer);
+
+	// Everything allocated since the last reset is released at once.
+	void   Reset();
+
+	size_t Used() const      { return mUsed; }
+	size_t Capacity() const  { return mCapacity; }
+	size_t HighWater() const { return mHighWater; }
+	size_t Overflows() const { return mOverflows; }	// Heap fallbacks, ever
+
+private:
+	FrameArena(const FrameArena &);
+	FrameArena & operator=(const FrameArena &);
+
+	bool Owns(const void * aPointer) const;
+
+	uint8_t * mBlock;
+	size_t    mCapacity;
+	size_t    mUsed;
+	size_t    mHighWater;
+	size_t    mOverflows;
+};
+
+//-----------------------------------------------------------------------------
+// Name : ArenaAllocator (Class)
+// Desc : Standard allocator over a FrameArena.
+//-----------------------------------------------------------------------------
+template <typename T>
+class ArenaAllocator
+{
+public:
+	typedef T value_type;
+
+	explicit ArenaAllocator(FrameArena & aArena) : mArena(&aArena) {}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U> & aOther) : mArena(aOther.Arena()) {}
+
+	T * allocate(size_t aCount)
+	{
+		return static_cast<T *>(mArena->Allocate(aCount * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T * aPointer, size_t)
+	{
+		mArena->Deallocate(aPointer);
+	}
+
+	FrameArena * Arena() const { return mArena; }
+
+private:
+	FrameArena * mArena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> & aFirst, const ArenaAllocator<U> & aSecond)
+{
+	return aFirst.Arena() == aSecond.Arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> & aFirst, const ArenaAllocator<U> & aSecond)
+{
+	return !(aFirst == aSecond);
+}
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+
+#endif // _FRAMEARENA_H_
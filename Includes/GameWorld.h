@@ -0,0 +1,148 @@
+//-----------------------------------------------------------------------------
+// File: GameWorld.h
+//
+// Desc: The simulated game: the planes and their bullets, the enemy waves,
+//	   the collisions between them, beams and bombs, and restarting. A tick
+//	   depends only on the buttons and the seed, so replays, both peers of
+//	   a networked game and the benchmarks all run this same code; it
+//	   draws and plays sounds only through IPlatform and needs no window.
+//
+//	   The world takes its transient containers from a FrameArena that its
+//	   owner resets once per frame. Ticks re-simulated after a rollback
+//	   each reset it themselves, since one frame can run several.
+//-----------------------------------------------------------------------------
+
+#ifndef _GAMEWORLD_H_
+#define _GAMEWORLD_H_
+
+//-----------------------------------------------------------------------------
+// GameWorld Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Vec2.h"
+#include "CPlayer.h"
+#include "../EnemyGroup.h"
+#include "Broadphase.h"
+#include "FrameArena.h"
+#include "InputLog.h"
+#include "JobSystem.h"
+#include "Platform.h"
+#include "ProjectilePool.h"
+#include "RollbackSession.h"
+#include "SpriteBank.h"
+#include "WaveScript.h"
+#include "WorldSnapshot.h"
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : GameWorld (Class)
+// Desc : One or two planes against the enemy waves, a fixed tick at a time.
+//-----------------------------------------------------------------------------
+class GameWorld : public IRollbackWorld
+{
+public:
+	static const int kMaxPlayers = 2;
+
+	// Every tick advances the world by this much.
+	static const float kTickTime;
+
+	// The world the simulation runs in, the same on every machine and in
+	// every replay whatever the window is.
+	static const int32_t kPlayWidth  = 800;
+	static const int32_t kPlayHeight = 600;
+
+	// aSprites must be loaded. aJobs, if given, spreads movement and the
+	// collision tests over its workers; the results do not depend on it.
+	// aEnemyBullets caps the enemy bullets alive at once.
+	GameWorld(IPlatform & aPlatform, SpriteBank & aSprites, FrameArena & aFrameArena, JobSystem * aJobs,
+		int aPlayerCount, uint64_t aSeed, size_t aEnemyBullets = EnemyGroup::kDefaultMaxBullets);
+
+	// Loads the waves (the file through the platform) and places the
+	// planes; the world as it is then is what Restart goes back to.
+	// Returns false and leaves the reason in aError on failure.
+	bool LoadWaves(const char * szFileName, std::string & aError);
+
+	// The same from a script that compiled.
+	void SetWaves(const WaveScript & aScript);
+
+	// Back to the world as it was when the waves were loaded.
+	void Restart();
+
+	// One fixed tick. aSecondButtons are the second plane's. INPUT_RESTART
+	// from either player takes the whole tick; once the game is over
+	// nothing else moves.
+	void SimulateTick(uint16_t aButtons, uint16_t aSecondButtons = 0);
+
+	// The phases of SimulateTick, in the order it runs them, for callers
+	// that time them apart.
+	void ApplyInputs(uint16_t aButtons, uint16_t aSecondButtons);
+	void AnimateObjects(float aTimeStep);
+	void ResolveCollisions();
+
+	// Planes, bullets and enemies at aAlpha (0 .. 1) of the way from the
+	// previous tick to the current one. Beams are left to the caller.
+	void Draw(float aAlpha);
+
+	// Every plane is out of lives.
+	bool IsGameOver() const;
+
+	// Hash of the whole simulated state, for replay and desync checks.
+	uint64_t Hash() const;
+
+	int                    PlayerCount() const              { return mPlayerCount; }
+	CPlayer *              GetPlayer(int aPlayer) const     { return mPlayers[aPlayer].get(); }
+	const ProjectilePool & GetPlayerBullets(int aPlayer) const { return *mBullets[aPlayer]; }
+	const EnemyGroup &     GetEnemyGroup() const            { return mEnemyGroup; }
+
+	// The beam a player held this tick, from the plane to what it hit.
+	bool         IsBeamActive(int aPlayer) const { return mBeamActive[aPlayer]; }
+	const Vec2 & BeamStart(int aPlayer) const    { return mBeamStart[aPlayer]; }
+	const Vec2 & BeamEnd(int aPlayer) const      { return mBeamEnd[aPlayer]; }
+
+	// IRollbackWorld. Re-simulated ticks are muted.
+	void SaveState(WorldSnapshot & aSnapshot) override;
+	bool LoadState(const WorldSnapshot & aSnapshot) override;
+	void SimulateTick(const uint16_t aButtons[], bool aReplaying) override;
+
+private:
+	void SaveWorld(WorldSnapshot & aSnapshot) const;
+	bool RestoreWorld(const WorldSnapshot & aSnapshot);
+	void KeepStartState();
+	Vec2 SpawnPoint(int aPlayer) const;
+
+	void ApplyInput(int aPlayer, uint16_t aButtons, float aTimeStep);
+	void ResolvePlayerCollisions(int aPlayer);
+	void FireBeam(int aPlayer);
+	void DetonateBomb(int aPlayer);
+
+	IPlatform &  mPlatform;
+	SpriteBank & mSprites;
+	FrameArena & mFrameArena;
+	JobSystem *  mJobs;
+	int          mPlayerCount;
+
+	// Player 0 fires into mBullets[0], player 1 into mBullets[1].
+	std::unique_ptr<ProjectilePool> mBullets[kMaxPlayers];
+	std::unique_ptr<CPlayer>        mPlayers[kMaxPlayers];
+	EnemyGroup                      mEnemyGroup;
+
+	Broadphase                 mBroadphase;
+	std::vector<CollisionPair> mCollisionPairs;
+	std::vector<size_t>        mBombTargets;
+
+	float mBombCooldown[kMaxPlayers];
+	bool  mBeamActive[kMaxPlayers];
+	Vec2  mBeamStart[kMaxPlayers];
+	Vec2  mBeamEnd[kMaxPlayers];
+
+	// The world as it was when the waves were loaded.
+	WorldSnapshot mStartState;
+};
+
+#endif // _GAMEWORLD_H_
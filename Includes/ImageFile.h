@@ -3,6 +3,7 @@
 // by Mihai Popescu
 // March 2009
 #include "main.h"
+#include "Profiler.h"
 
 
 typedef BYTE (*RGBQUAD_TO_BYTE)(const RGBQUAD &q);
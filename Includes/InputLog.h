@@ -0,0 +1,103 @@
+//-----------------------------------------------------------------------------
+// File: InputLog.h
+//
+// Desc: Per tick record of the player's input, bit packed. A tick whose
+//	   buttons match the previous tick costs a single bit, a change costs
+//	   one bit plus the new button state, so a typical minute of play fits
+//	   in well under a kilobyte.
+//
+//	   Together with the session seed this is all that is needed to replay a
+//	   run tick for tick. The log can also carry the score and world hash
+//	   the session ended with, so a replay can tell whether it got there.
+//-----------------------------------------------------------------------------
+
+#ifndef _INPUTLOG_H_
+#define _INPUTLOG_H_
+
+//-----------------------------------------------------------------------------
+// InputLog Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Forward Declarations
+//-----------------------------------------------------------------------------
+class IPlatform;
+
+//-----------------------------------------------------------------------------
+// Enumerators
+//-----------------------------------------------------------------------------
+// Buttons sampled each simulation tick. The first four are held states,
+// the rest are presses since the previous tick.
+enum InputButton
+{
+	INPUT_UP             = 1 << 0,
+	INPUT_DOWN           = 1 << 1,
+	INPUT_LEFT           = 1 << 2,
+	INPUT_RIGHT          = 1 << 3,
+	INPUT_BEAM           = 1 << 4,
+	INPUT_FIRE           = 1 << 5,
+	INPUT_ROTATE_LEFT    = 1 << 6,
+	INPUT_ROTATE_RIGHT   = 1 << 7,
+	INPUT_BOMB           = 1 << 8,
+	INPUT_SELF_DESTRUCT  = 1 << 9,
+	INPUT_RESTART        = 1 << 10	// Back to the state the game started in
+};
+
+const int kInputButtonBits = 11;
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : InputLog (Class)
+// Desc : Append only while recording; read back in order with a cursor.
+//-----------------------------------------------------------------------------
+class InputLog
+{
+public:
+	InputLog();
+
+	// Starts a new, empty log for a session seeded with aSeed.
+	void Clear(uint64_t aSeed);
+	void Record(uint16_t aButtons);
+
+	// Read cursor; Read returns false once every tick has been read.
+	void Rewind();
+	bool Read(uint16_t & aButtons);
+
+	// Through aPlatform's file access.
+	bool SaveToFile(IPlatform & aPlatform, const char * szFileName) const;
+	bool LoadFromFile(IPlatform & aPlatform, const char * szFileName);
+
+	// What the recorded session ended with; cleared by Clear.
+	void     SetOutcome(uint32_t aScore, uint64_t aStateHash);
+	bool     HasOutcome() const   { return mHasOutcome; }
+	uint32_t OutcomeScore() const { return mOutcomeScore; }
+	uint64_t OutcomeHash() const  { return mOutcomeHash; }
+
+	uint64_t GetSeed() const   { return mSeed; }
+	uint32_t TickCount() const { return mTickCount; }
+	size_t   ByteSize() const  { return mBytes.size(); }
+
+private:
+	void     WriteBits(uint32_t aValue, int aCount);
+	uint32_t ReadBits(int aCount);
+
+	std::vector<uint8_t> mBytes;
+	size_t               mBitCount;
+	uint64_t             mSeed;
+	uint32_t             mTickCount;
+	uint16_t             mLastRecorded;
+	bool                 mHasOutcome;
+	uint32_t             mOutcomeScore;
+	uint64_t             mOutcomeHash;
+
+	size_t               mReadBit;
+	uint32_t             mReadTick;
+	uint16_t             mLastRead;
+};
+
+#endif // _INPUTLOG_H_
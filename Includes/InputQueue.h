@@ -0,0 +1,72 @@
+//-----------------------------------------------------------------------------
+// File: InputQueue.h
+//
+// Desc: Timestamped key events on their way from the window procedure to
+//	   the simulation. The message handler pushes each key change as it
+//	   arrives, stamped with the platform clock; the frame loop pops them in
+//	   order and hands every event to the tick whose time span contains it,
+//	   so a press is neither lost nor delayed to the next frame when a frame
+//	   runs long.
+//
+//	   Single producer, single consumer, lock free: the two sides only share
+//	   the head and tail counters, so the producer may move to its own
+//	   thread without changing the consumer.
+//-----------------------------------------------------------------------------
+
+#ifndef _INPUTQUEUE_H_
+#define _INPUTQUEUE_H_
+
+//-----------------------------------------------------------------------------
+// InputQueue Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+//-----------------------------------------------------------------------------
+// Main Structure Declarations
+//-----------------------------------------------------------------------------
+struct InputEvent
+{
+	uint32_t mId;		// Sequence number, for following one event through
+	int64_t  mTime;		// PlatformClock::Ticks() when the event arrived
+	uint16_t mKey;		// Virtual key code
+	bool     mDown;		// Pressed (or auto repeated) rather than released
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : InputQueue (Class)
+// Desc : Fixed capacity ring of InputEvents. A push into a full queue is
+//		dropped and counted.
+//-----------------------------------------------------------------------------
+class InputQueue
+{
+public:
+	static const uint32_t kCapacity = 256;	// Power of two
+
+	InputQueue();
+
+	// Producer side.
+	bool Push(const InputEvent & aEvent);
+
+	// Consumer side. Peek leaves the event queued, Pop removes it.
+	bool Peek(InputEvent & aEvent) const;
+	bool Pop(InputEvent & aEvent);
+
+	uint32_t Size() const;
+	uint32_t Dropped() const { return mDropped.load(std::memory_order_relaxed); }
+
+private:
+	InputQueue(const InputQueue &);
+	InputQueue & operator=(const InputQueue &);
+
+	InputEvent            mEvents[kCapacity];
+	std::atomic<uint32_t> mHead;		// Next slot to write, producer owned
+	std::atomic<uint32_t> mTail;		// Next slot to read, consumer owned
+	std::atomic<uint32_t> mDropped;
+};
+
+#endif // _INPUTQUEUE_H_
@@ -0,0 +1,167 @@
+//-----------------------------------------------------------------------------
+// File: JobSystem.h
+//
+// Desc: Fork/join parallel loops on a fixed pool of worker threads.
+//
+//	   ParallelFor cuts [0, aCount) into chunks of aGrain items. The whole
+//	   chunk range starts on the caller's queue; whoever holds a range
+//	   keeps halving it, running the lower half and pushing the upper half
+//	   onto its own queue. Owners take work back from the newest end of
+//	   their queue, idle threads steal from the oldest end, so a thief
+//	   always walks off with the biggest piece left. The caller works too
+//	   and returns once every chunk has run.
+//
+//	   The chunk boundaries depend only on aCount and aGrain, never on the
+//	   thread count or on who ran what. Bodies that write per chunk output
+//	   (indexed by the chunk number they are given) and merge it in chunk
+//	   order afterwards get the same result on one thread or eight.
+//
+//	   One loop runs at a time: ParallelFor is called from a single thread,
+//	   and a ParallelFor issued from inside a body runs inline.
+//-----------------------------------------------------------------------------
+
+#ifndef _JOBSYSTEM_H_
+#define _JOBSYSTEM_H_
+
+//-----------------------------------------------------------------------------
+// JobSystem Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : JobSystem (Class)
+// Desc : Worker threads with one work-stealing queue each.
+//-----------------------------------------------------------------------------
+class JobSystem
+{
+public:
+	static const unsigned kAutoWorkers = ~0u;	// One per hardware thread beyond the caller's
+	static const unsigned kMaxThreads  = 64;	// Caller included
+
+	explicit JobSystem(unsigned aWorkerCount = kAutoWorkers);
+	~JobSystem();
+
+	// Threads that run chunks, the caller included.
+	unsigned ThreadCount() const { return mThreadCount; }
+
+	// Number of chunks ParallelFor cuts aCount items into.
+	static size_t ChunkCount(size_t aCount, size_t aGrain)
+	{
+		aGrain = aGrain ? aGrain : 1;
+		return (aCount + aGrain - 1) / aGrain;
+	}
+
+	// Calls aBody(aBegin, aEnd, aChunk) once per chunk of [0, aCount), on
+	// any thread, and returns when all of them are done.
+	template <typename Body>
+	void ParallelFor(size_t aCount, size_t aGrain, const Body & aBody)
+	{
+		const size_t chunks = ChunkCount(aCount, aGrain);
+		if (chunks == 0)
+			return;
+
+		aGrain = aGrain ? aGrain : 1;
+		if (chunks == 1 || mThreadCount == 1 || tInsideJob)
+		{
+			RunInline(aCount, aGrain, aBody);
+			return;
+		}
+
+		Run(aCount, aGrain, chunks, &CallBody<Body>, &aBody);
+	}
+
+	// Same chunks, all on the calling thread.
+	template <typename Body>
+	static void RunInline(size_t aCount, size_t aGrain, const Body & aBody)
+	{
+		aGrain = aGrain ? aGrain : 1;
+		for (size_t begin = 0, chunk = 0; begin < aCount; begin += aGrain, ++chunk)
+			aBody(begin, begin + aGrain < aCount ? begin + aGrain : aCount, chunk);
+	}
+
+private:
+	JobSystem(const JobSystem &);
+	JobSystem & operator=(const JobSystem &);
+
+	typedef void (*ChunkFunction)(const void * aBody, size_t aBegin, size_t aEnd, size_t aChunk);
+
+	template <typename Body>
+	static void CallBody(const void * aBody, size_t aBegin, size_t aEnd, size_t aChunk)
+	{
+		(*static_cast<const Body *>(aBody))(aBegin, aEnd, aChunk);
+	}
+
+	// Half open range of chunk numbers.
+	struct ChunkRange
+	{
+		size_t mFirst;
+		size_t mLast;
+	};
+
+	// Fixed ring: ranges only ever halve, so a queue holds at most one
+	// entry per halving, far fewer than kCapacity.
+	struct WorkQueue
+	{
+		static const size_t kCapacity = 128;
+
+		std::mutex mLock;
+		ChunkRange mRanges[kCapacity];
+		size_t     mHead;	// Oldest, where thieves take from
+		size_t     mTail;	// Newest, where the owner pushes and pops
+
+		WorkQueue() : mHead(0), mTail(0) {}
+	};
+
+	void Run(size_t aCount, size_t aGrain, size_t aChunks, ChunkFunction aFunction, const void * aBody);
+	void WorkerMain(unsigned aQueue);
+	void Work(unsigned aQueue);
+	bool Pop(unsigned aQueue, ChunkRange & aRange);
+	bool Steal(unsigned aQueue, ChunkRange & aRange);
+	bool Push(unsigned aQueue, const ChunkRange & aRange);
+	void Execute(unsigned aQueue, ChunkRange aRange);
+
+	unsigned                     mThreadCount;
+	std::unique_ptr<WorkQueue[]> mQueues;	// 0 is the caller's, i is worker i - 1's
+	std::vector<std::thread>     mWorkers;
+
+	// The loop being run; set before its first range is pushed.
+	ChunkFunction       mFunction;
+	const void *        mBody;
+	size_t              mCount;
+	size_t              mGrain;
+	std::atomic<size_t> mRemaining;	// Chunks not yet finished
+
+	// Workers sleep here between loops.
+	std::mutex              mWakeLock;
+	std::condition_variable mWake;
+	uint64_t                mGeneration;	// Bumped for every loop
+	bool                    mShutdown;
+
+	static thread_local bool tInsideJob;
+};
+
+//-----------------------------------------------------------------------------
+// Name : ParallelFor ()
+// Desc : JobSystem::ParallelFor on aJobs, or the same chunks inline when
+//		there is none, so results never depend on which one ran.
+//-----------------------------------------------------------------------------
+template <typename Body>
+inline void ParallelFor(JobSystem * aJobs, size_t aCount, size_t aGrain, const Body & aBody)
+{
+	if (aJobs)
+		aJobs->ParallelFor(aCount, aGrain, aBody);
+	else
+		JobSystem::RunInline(aCount, aGrain, aBody);
+}
+
+#endif // _JOBSYSTEM_H_
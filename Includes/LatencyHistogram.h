@@ -0,0 +1,52 @@
+//-----------------------------------------------------------------------------
+// File: LatencyHistogram.h
+//
+// Desc: Fixed bucket histogram of latencies. Recording is a single counter
+//	   increment, so it can stay on in release builds; percentiles are read
+//	   back at bucket resolution (0.1 ms up to 100 ms, one overflow bucket
+//	   past that).
+//-----------------------------------------------------------------------------
+
+#ifndef _LATENCYHISTOGRAM_H_
+#define _LATENCYHISTOGRAM_H_
+
+//-----------------------------------------------------------------------------
+// LatencyHistogram Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : LatencyHistogram (Class)
+// Desc : Counts of latencies in milliseconds.
+//-----------------------------------------------------------------------------
+class LatencyHistogram
+{
+public:
+	static const int    kBucketCount = 1000;	// Plus one overflow bucket
+	static const double kBucketWidth;			// Milliseconds per bucket
+
+	LatencyHistogram();
+
+	void Clear();
+	void Record(double aMilliseconds);
+
+	// Upper edge of the bucket holding the aPercentile'th sample (0-100),
+	// capped at Maximum(); 0 when nothing has been recorded.
+	double Percentile(double aPercentile) const;
+
+	uint32_t Count() const   { return mCount; }
+	double   Mean() const    { return mCount ? mTotal / mCount : 0.0; }
+	double   Maximum() const { return mMaximum; }
+
+private:
+	uint32_t mBuckets[kBucketCount + 1];
+	uint32_t mCount;
+	double   mTotal;
+	double   mMaximum;
+};
+
+#endif // _LATENCYHISTOGRAM_H_
@@ -0,0 +1,139 @@
+//-----------------------------------------------------------------------------
+// File: NetTransport.h
+//
+// Desc: Unreliable datagram links between two peers.
+//
+//	   INetTransport has UDP semantics: a datagram arrives whole or not at
+//	   all, possibly late and out of order, and nothing is resent. The
+//	   rollback session builds everything it needs (redundancy, acks) on
+//	   top of that, so any backend that can lose packets will do:
+//
+//		   UdpTransport       - real sockets (UdpTransport.h)
+//		   LoopbackTransport  - two endpoints in one process, for tests
+//		   LossyTransport     - wraps another and adds latency, jitter and
+//								packet loss, to try bad networks locally
+//
+//	   None of them are thread safe; send and receive from one thread.
+//-----------------------------------------------------------------------------
+
+#ifndef _NETTRANSPORT_H_
+#define _NETTRANSPORT_H_
+
+//-----------------------------------------------------------------------------
+// NetTransport Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "Random.h"
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : INetTransport (Class)
+// Desc : Sends and receives whole datagrams to and from one peer.
+//-----------------------------------------------------------------------------
+class INetTransport
+{
+public:
+	static const size_t kMaxDatagram = 512;	// Larger datagrams are refused
+
+	INetTransport() = default;
+
+	virtual ~INetTransport() = default;
+
+	// Queues one datagram for the peer. False if it was refused outright;
+	// true only means it left, not that it will arrive.
+	virtual bool   Send(const void * aData, size_t aSize) = 0;
+
+	// Copies the next waiting datagram into aBuffer and returns its size,
+	// or 0 when none is waiting. Never blocks.
+	virtual size_t Receive(void * aBuffer, size_t aCapacity) = 0;
+
+private:
+	INetTransport(const INetTransport &);
+	INetTransport & operator=(const INetTransport &);
+};
+
+//-----------------------------------------------------------------------------
+// Name : LoopbackTransport (Class)
+// Desc : In-process endpoint; what one of a connected pair sends, the other
+//		receives, in order. A full inbox drops, like a socket buffer.
+//-----------------------------------------------------------------------------
+class LoopbackTransport : public INetTransport
+{
+public:
+	static const size_t kCapacity = 256;	// Datagrams waiting per endpoint
+
+	LoopbackTransport();
+	~LoopbackTransport();
+
+	static void Connect(LoopbackTransport & aFirst, LoopbackTransport & aSecond);
+
+	bool   Send(const void * aData, size_t aSize) override;
+	size_t Receive(void * aBuffer, size_t aCapacity) override;
+
+	uint32_t Dropped() const { return mDropped; }
+
+private:
+	struct Datagram
+	{
+		uint32_t mSize;
+		uint8_t  mData[kMaxDatagram];
+	};
+
+	LoopbackTransport *   mPeer;
+	std::vector<Datagram> mInbox;	// Ring of kCapacity, filled by the peer
+	size_t                mHead;
+	size_t                mTail;
+	uint32_t              mDropped;
+};
+
+//-----------------------------------------------------------------------------
+// Name : LossyTransport (Class)
+// Desc : Network conditions shim. Each datagram sent is dropped with the
+//		loss rate, or held back for the latency plus up to the jitter
+//		(so it may overtake earlier ones) before going to the wrapped
+//		transport. Time is the real clock unless SetTime drives it.
+//-----------------------------------------------------------------------------
+class LossyTransport : public INetTransport
+{
+public:
+	// aLatency and aJitter in seconds, aLossRate in [0, 1].
+	LossyTransport(INetTransport & aInner, double aLatency, double aJitter, float aLossRate, uint64_t aSeed);
+
+	bool   Send(const void * aData, size_t aSize) override;
+	size_t Receive(void * aBuffer, size_t aCapacity) override;
+
+	// Switches to simulated time, for runs faster than real time.
+	void   SetTime(double aSeconds);
+
+	// Passes on every held datagram that is due.
+	void   Flush();
+
+	uint32_t Sent() const    { return mSent; }
+	uint32_t Dropped() const { return mDropped; }
+
+private:
+	struct Pending
+	{
+		double               mDueTime;
+		std::vector<uint8_t> mData;
+	};
+
+	double Now() const;
+
+	INetTransport &      mInner;
+	double               mLatency;
+	double               mJitter;
+	float                mLossRate;
+	Random               mRandom;
+	std::vector<Pending> mPending;
+	bool                 mManualTime;
+	double               mTime;
+	uint32_t             mSent;
+	uint32_t             mDropped;
+};
+
+#endif // _NETTRANSPORT_H_
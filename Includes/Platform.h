@@ -0,0 +1,120 @@
+//-----------------------------------------------------------------------------
+// File: Platform.h
+//
+// Desc: The services the game needs from the operating system: a window to
+//	   draw sprites into and present, a high resolution clock, sound output
+//	   and file access.
+//
+//	   The clock is picked at compile time (QueryPerformanceCounter on
+//	   Windows, clock_gettime elsewhere). Everything else goes through an
+//	   IPlatform backend chosen at run time: Win32Platform drives the real
+//	   window, HeadlessPlatform keeps its frames in memory and plays no
+//	   sound, for replays, benchmarks and non Windows builds.
+//
+//	   Keyboard input does not come through here: the window procedure
+//	   timestamps each key change into an InputQueue as it arrives, which
+//	   a once per frame poll of the keyboard state could not do.
+//-----------------------------------------------------------------------------
+
+#ifndef _PLATFORM_H_
+#define _PLATFORM_H_
+
+//-----------------------------------------------------------------------------
+// Platform Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const int kPlatformKeyCount  = 256;	// Key codes, virtual keys on Windows
+const int kSpriteFramesPerRow = 4;		// Animation frames per row of a sheet, as AnimatedSprite lays them out
+
+//-----------------------------------------------------------------------------
+// Forward Declarations
+//-----------------------------------------------------------------------------
+class CollisionMask;
+
+//-----------------------------------------------------------------------------
+// Name : SpriteSheet (Struct)
+// Desc : The files of one sprite. An animated sprite's image holds
+//		mFrameCount frames of mFrameWidth x mFrameHeight, left to right and
+//		kSpriteFramesPerRow to a row; a still one is a single frame.
+//-----------------------------------------------------------------------------
+struct SpriteSheet
+{
+	const char * mImageFile;
+	const char * mMaskFile;
+	int          mFrameWidth;
+	int          mFrameHeight;
+	int          mFrameCount;
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : PlatformClock (Class)
+// Desc : Monotonic high resolution clock. Ticks are only meaningful as
+//		differences; divide by Frequency() for seconds.
+//-----------------------------------------------------------------------------
+class PlatformClock
+{
+public:
+	static int64_t Ticks();
+	static int64_t Frequency();
+
+	// Seconds between two Ticks() readings.
+	static double  Seconds(int64_t aStart, int64_t aEnd);
+
+	// Gives up the CPU for about aSeconds. Wakes late by up to the
+	// scheduler's granularity (around 1 ms once CTimer has asked Windows
+	// for it, 15.6 ms otherwise), never early.
+	static void    SleepFor(double aSeconds);
+};
+
+//-----------------------------------------------------------------------------
+// Name : IPlatform (Class)
+// Desc : Window, audio and file services of one backend.
+//-----------------------------------------------------------------------------
+class IPlatform
+{
+public:
+	IPlatform() : mAudioMuted(false) {}
+
+	virtual ~IPlatform() = default;
+
+	// Makes aSheet drawable as aSprite. aMask is its mask file, already
+	// decoded, for backends that draw from it. False if the files cannot
+	// be loaded.
+	virtual bool LoadSprite(uint16_t aSprite, const SpriteSheet & aSheet, const CollisionMask & aMask) = 0;
+
+	// Draws frame aFrame of a loaded sprite centred on (aX, aY).
+	virtual void DrawSprite(uint16_t aSprite, int aFrame, float aX, float aY) = 0;
+
+	// Shows the frame drawn since the previous call.
+	virtual void Present() = 0;
+
+	// Starts playing a sound file, cutting off whatever was playing.
+	// Nothing plays while muted.
+	virtual void PlayAudio(const char * szFileName) = 0;
+
+	// Ticks simulated a second time after a rollback run muted, so their
+	// sounds are not heard twice.
+	void SetAudioMuted(bool aMuted) { mAudioMuted = aMuted; }
+	bool IsAudioMuted() const       { return mAudioMuted; }
+
+	// Whole file reads and writes; the defaults go straight to disk.
+	virtual bool LoadFile(const char * szFileName, std::vector<uint8_t> & aData);
+	virtual bool SaveFile(const char * szFileName, const void * aData, size_t aSize);
+
+private:
+	IPlatform(const IPlatform &);
+	IPlatform & operator=(const IPlatform &);
+
+	bool mAudioMuted;
+};
+
+#endif // _PLATFORM_H_
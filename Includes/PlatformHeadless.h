@@ -0,0 +1,76 @@
+//-----------------------------------------------------------------------------
+// File: PlatformHeadless.h
+//
+// Desc: Platform backend with no window and no sound. Sprites are drawn
+//	   into an in-memory 32 bit surface, each as its mask in a flat colour,
+//	   and files written can be kept in memory so a run leaves nothing
+//	   behind. Used by replays and the benchmarks, and builds anywhere
+//	   clock_gettime does.
+//-----------------------------------------------------------------------------
+
+#ifndef _PLATFORMHEADLESS_H_
+#define _PLATFORMHEADLESS_H_
+
+//-----------------------------------------------------------------------------
+// PlatformHeadless Specific Includes
+//-----------------------------------------------------------------------------
+#include <map>
+#include <string>
+#include "Platform.h"
+#include "CollisionMask.h"
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : HeadlessPlatform (Class)
+// Desc : In-memory surface, silent audio.
+//-----------------------------------------------------------------------------
+class HeadlessPlatform : public IPlatform
+{
+public:
+	// With aFilesInMemory, files saved are only kept for LoadFile to
+	// serve back; otherwise they go to disk like any other backend's.
+	HeadlessPlatform(int aWidth, int aHeight, bool aFilesInMemory = true);
+
+	bool LoadSprite(uint16_t aSprite, const SpriteSheet & aSheet, const CollisionMask & aMask) override;
+	void DrawSprite(uint16_t aSprite, int aFrame, float aX, float aY) override;
+	void Present() override;
+	void PlayAudio(const char * szFileName) override;
+
+	// Files saved here are served back by LoadFile; anything else is read
+	// from disk.
+	bool LoadFile(const char * szFileName, std::vector<uint8_t> & aData) override;
+	bool SaveFile(const char * szFileName, const void * aData, size_t aSize) override;
+
+	// Row major ARGB pixels, Width() per row.
+	int              Width() const  { return mWidth; }
+	int              Height() const { return mHeight; }
+	uint32_t *       Pixels()       { return mPixels.data(); }
+	const uint32_t * Pixels() const { return mPixels.data(); }
+
+	uint32_t PresentCount() const { return mPresentCount; }
+	uint32_t SoundCount() const   { return mSoundCount; }	// Muted ones not counted
+
+private:
+	struct HeadlessSprite
+	{
+		CollisionMask mMask;	// The whole sheet
+		int           mFrameWidth;
+		int           mFrameHeight;
+		uint32_t      mColour;
+	};
+
+	int                   mWidth;
+	int                   mHeight;
+	std::vector<uint32_t> mPixels;
+	uint32_t              mPresentCount;
+	uint32_t              mSoundCount;
+
+	std::vector<HeadlessSprite> mSprites;
+
+	bool mFilesInMemory;
+	std::map<std::string, std::vector<uint8_t> > mFiles;
+};
+
+#endif // _PLATFORMHEADLESS_H_
@@ -0,0 +1,50 @@
+//-----------------------------------------------------------------------------
+// File: PlatformWin32.h
+//
+// Desc: Platform backend for the game window: GDI sprites drawn into a
+//	   back buffer and PlaySound for audio.
+//-----------------------------------------------------------------------------
+
+#ifndef _PLATFORMWIN32_H_
+#define _PLATFORMWIN32_H_
+
+//-----------------------------------------------------------------------------
+// PlatformWin32 Specific Includes
+//-----------------------------------------------------------------------------
+#include <memory>
+#include <vector>
+#include "Main.h"
+#include "BackBuffer.h"
+#include "Sprite.h"
+#include "Platform.h"
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : Win32Platform (Class)
+// Desc : Presents a BackBuffer owned by the caller into its window.
+//-----------------------------------------------------------------------------
+class Win32Platform : public IPlatform
+{
+public:
+	explicit Win32Platform(BackBuffer * pBackBuffer);
+
+	bool LoadSprite(uint16_t aSprite, const SpriteSheet & aSheet, const CollisionMask & aMask) override;
+	void DrawSprite(uint16_t aSprite, int aFrame, float aX, float aY) override;
+	void Present() override;
+	void PlayAudio(const char * szFileName) override;
+
+private:
+	// One GDI sprite per id; mAnimation is set for animated ones.
+	struct LoadedSprite
+	{
+		std::unique_ptr<Sprite> mSprite;
+		AnimatedSprite *        mAnimation;
+	};
+
+	BackBuffer * mBackBuffer;
+	std::vector<LoadedSprite> mSprites;
+};
+
+#endif // _PLATFORMWIN32_H_
@@ -0,0 +1,98 @@
+//-----------------------------------------------------------------------------
+// File: Profiler.h
+//
+// Desc: Scoped timing markers. PROFILE_SCOPE("Name") times the rest of the
+//	   enclosing block; nested scopes nest in the trace. Each thread records
+//	   into its own fixed ring of events, so recording takes no lock and a
+//	   long session keeps its most recent events rather than growing.
+//
+//	   Profiler::WriteChromeTrace saves everything recorded as trace event
+//	   JSON, which chrome://tracing and ui.perfetto.dev open directly.
+//
+//	   The markers are compiled in for debug builds and compiled out for
+//	   release ones; define ENABLE_PROFILER to keep them in a release build.
+//-----------------------------------------------------------------------------
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+//-----------------------------------------------------------------------------
+// Profiler Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include "Platform.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+#if !defined(NDEBUG) || defined(ENABLE_PROFILER)
+#define PROFILER_ENABLED 1
+#endif
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if defined(PROFILER_ENABLED)
+#define PROFILE_SCOPE(szName) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(szName)
+#else
+#define PROFILE_SCOPE(szName) ((void)0)
+#endif
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : Profiler (Class)
+// Desc : Per thread event rings and the trace export.
+//-----------------------------------------------------------------------------
+class Profiler
+{
+public:
+	static const uint32_t kEventsPerThread = 1 << 16;
+
+	// Names must outlive the profiler; string literals are the usual case.
+	static void Record(const char * szName, int64_t aStart, int64_t aEnd, uint32_t aDepth);
+
+	// Shown as the calling thread's name in the trace.
+	static void SetThreadName(const char * szName);
+
+	// Recording on every thread should be paused while these run. The
+	// trace is saved through aPlatform.
+	static bool WriteChromeTrace(IPlatform & aPlatform, const char * szFileName);
+	static void Clear();
+};
+
+//-----------------------------------------------------------------------------
+// Name : ProfileScope (Class)
+// Desc : Records one event covering its own lifetime. Use PROFILE_SCOPE.
+//-----------------------------------------------------------------------------
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const char * szName)
+		: mName(szName)
+		, mDepth(sDepth++)
+		, mStart(PlatformClock::Ticks())
+	{
+	}
+
+	~ProfileScope()
+	{
+		const int64_t end = PlatformClock::Ticks();
+		--sDepth;
+		Profiler::Record(mName, mStart, end, mDepth);
+	}
+
+private:
+	ProfileScope(const ProfileScope &);
+	ProfileScope & operator=(const ProfileScope &);
+
+	static thread_local uint32_t sDepth;
+
+	const char * mName;
+	uint32_t     mDepth;
+	int64_t      mStart;
+};
+
+#endif // _PROFILER_H_
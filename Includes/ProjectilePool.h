@@ -0,0 +1,92 @@
+//-----------------------------------------------------------------------------
+// File: ProjectilePool.h
+//
+// Desc: Fixed capacity projectile storage. All memory is reserved up front,
+//	   so spawning and retiring a projectile never touches the heap; when
+//	   the pool is full the shot is dropped and counted instead.
+//
+//	   Live projectiles stay dense in an EntityStore for the per frame
+//	   sweeps; handles go through a SlotMap, so a handle to a retired
+//	   projectile is detected instead of aliasing whatever reused the slot.
+//-----------------------------------------------------------------------------
+
+#ifndef _PROJECTILEPOOL_H_
+#define _PROJECTILEPOOL_H_
+
+//-----------------------------------------------------------------------------
+// ProjectilePool Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include "EntityStore.h"
+#include "SlotMap.h"
+
+typedef SlotHandle ProjectileHandle;
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : ProjectilePool (Class)
+// Desc : Slot map over a dense, preallocated EntityStore.
+//-----------------------------------------------------------------------------
+class ProjectilePool
+{
+public:
+	static const size_t kInvalidIndex = SlotMap::kInvalidIndex;
+
+	explicit ProjectilePool(size_t aCapacity);
+
+	// Returns a null handle (and counts a drop) when the pool is full.
+	ProjectileHandle Spawn(float aX, float aY, float aVelocityX, float aVelocityY,
+	                       uint16_t aSprite, int32_t aHalfWidth, int32_t aHalfHeight,
+	                       uint16_t aOwner);
+
+	// False if the handle was already stale.
+	bool Release(ProjectileHandle aHandle);
+	void ReleaseAt(size_t aIndex);
+
+	// Releases every projectile for which aPredicate(index) is true. Indices
+	// passed to the predicate are the ones from before the call.
+	template <typename Predicate>
+	void ReleaseIf(Predicate aPredicate)
+	{
+		for (size_t i = mEntities.Size(); i-- > 0;)
+		{
+			if (aPredicate(i))
+				ReleaseAt(i);
+		}
+	}
+
+	void Clear();
+
+	// Live projectiles and their handles, see WorldSnapshot. The drop and
+	// high water statistics are not part of the state.
+	void SaveState(WorldSnapshot & aSnapshot) const;
+	bool LoadState(SnapshotReader & aReader);
+
+	bool             IsAlive(ProjectileHandle aHandle) const { return mSlots.IsAlive(aHandle); }
+	size_t           IndexOf(ProjectileHandle aHandle) const { return mSlots.IndexOf(aHandle); }
+	ProjectileHandle HandleAt(size_t aIndex) const           { return mSlots.HandleAt(aIndex); }
+
+	void Integrate(float aTimeElapsed, JobSystem * aJobs = nullptr) { mEntities.Integrate(aTimeElapsed, aJobs); }
+	void StorePrevious()                                            { mEntities.StorePrevious(); }
+
+	// Dense view of the live projectiles, indices 0 .. Size() - 1.
+	const EntityStore & Entities() const { return mEntities; }
+
+	size_t Size() const      { return mEntities.Size(); }
+	bool   IsEmpty() const   { return mEntities.IsEmpty(); }
+	size_t Capacity() const  { return mCapacity; }
+	size_t HighWater() const { return mHighWater; }
+	size_t Dropped() const   { return mDropped; }
+
+private:
+	EntityStore mEntities;
+	SlotMap     mSlots;
+	size_t      mCapacity;
+	size_t      mHighWater;
+	size_t      mDropped;
+};
+
+#endif // _PROJECTILEPOOL_H_
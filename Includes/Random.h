@@ -0,0 +1,43 @@
+//-----------------------------------------------------------------------------
+// File: Random.h
+//
+// Desc: Small seeded random number generator (PCG32). Each system that needs
+//	   randomness owns one, so a run is reproduced exactly from its seed and
+//	   one system drawing more numbers never shifts another's sequence.
+//-----------------------------------------------------------------------------
+
+#ifndef _RANDOM_H_
+#define _RANDOM_H_
+
+//-----------------------------------------------------------------------------
+// Random Specific Includes
+//-----------------------------------------------------------------------------
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : Random (Class)
+// Desc : PCG32 generator; 64 bits of state, 32 bit outputs.
+//-----------------------------------------------------------------------------
+class Random
+{
+public:
+	explicit Random(uint64_t aSeed = 0);
+
+	void     Seed(uint64_t aSeed);
+
+	uint32_t Next();
+	uint32_t NextBelow(uint32_t aBound);	// [0, aBound), aBound > 0
+	float    NextFloat();					// [0, 1)
+
+	// Raw generator state, for saving and restoring a run mid way.
+	uint64_t GetState() const           { return mState; }
+	void     SetState(uint64_t aState)  { mState = aState; }
+
+private:
+	uint64_t mState;
+};
+
+#endif // _RANDOM_H_
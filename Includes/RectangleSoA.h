@@ -0,0 +1,87 @@
+//-----------------------------------------------------------------------------
+// File: RectangleSoA.h
+//
+// Desc: Structure-of-arrays rectangle store and the batched overlap kernels
+//	   built on it. Edges are kept in separate int32 arrays, padded to a
+//	   multiple of four, so one SSE2 compare tests four rectangles at once.
+//	   Results are returned as bitmasks (bit i set = rectangle i overlaps).
+//
+//	   Overlap uses the same inclusive rule as RectangleUtil::AreIntersecting.
+//
+//	   IntersectOne never allocates; IntersectMany only grows caller-owned
+//	   scratch. Hit masks are kept as a member and reused from frame to
+//	   frame (see Broadphase), so a frame's sweeps cost no heap traffic
+//	   once the masks have grown.
+//-----------------------------------------------------------------------------
+
+#ifndef _RECTANGLESOA_H_
+#define _RECTANGLESOA_H_
+
+//-----------------------------------------------------------------------------
+// RectangleSoA Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : RectangleSoA (Class)
+// Desc : Axis aligned rectangles stored as left/top/right/bottom arrays.
+//-----------------------------------------------------------------------------
+class RectangleSoA
+{
+public:
+	RectangleSoA();
+
+	void   Clear();
+	void   Reserve(size_t aCount);
+
+	size_t Add(int32_t aLeft, int32_t aTop, int32_t aRight, int32_t aBottom);
+	void   Set(size_t aIndex, int32_t aLeft, int32_t aTop, int32_t aRight, int32_t aBottom);
+	void   RemoveSwap(size_t aIndex);
+
+	size_t Size() const { return mSize; }
+	bool   IsEmpty() const { return mSize == 0; }
+
+	// Number of 32 bit words needed for a hit mask over this store.
+	size_t MaskWords() const { return (mSize + 31) / 32; }
+
+	const int32_t * Left() const   { return mLeft.data(); }
+	const int32_t * Top() const    { return mTop.data(); }
+	const int32_t * Right() const  { return mRight.data(); }
+	const int32_t * Bottom() const { return mBottom.data(); }
+
+private:
+	void ResetPadding(size_t aIndex);
+
+	std::vector<int32_t> mLeft;
+	std::vector<int32_t> mTop;
+	std::vector<int32_t> mRight;
+	std::vector<int32_t> mBottom;
+	size_t mSize;
+};
+
+//-----------------------------------------------------------------------------
+// Batched overlap kernels
+//-----------------------------------------------------------------------------
+namespace RectangleBatch
+{
+	// One rectangle against every rectangle in aStore. aHitMask must hold
+	// aStore.MaskWords() words; it is cleared first. Returns the number of
+	// hits.
+	size_t IntersectOne(const RectangleSoA & aStore,
+	                    int32_t aLeft, int32_t aTop, int32_t aRight, int32_t aBottom,
+	                    uint32_t * aHitMask);
+
+	// Every rectangle of aFirst against every rectangle of aSecond. aHitMasks
+	// is resized to aFirst.Size() rows of aSecond.MaskWords() words each,
+	// which only allocates while it is still growing.
+	// Returns the total number of overlapping pairs.
+	size_t IntersectMany(const RectangleSoA & aFirst, const RectangleSoA & aSecond,
+	                     std::vector<uint32_t> & aHitMasks);
+}
+
+#endif // _RECTANGLESOA_H_
@@ -0,0 +1,232 @@
+//-----------------------------------------------------------------------------
+// File: RollbackSession.h
+//
+// Desc: Two player lockstep with prediction and rollback.
+//
+//	   Both peers run the whole simulation; only inputs cross the network.
+//	   A tick never waits for the remote input: the session predicts it
+//	   (the last remote input seen, with the one-shot buttons cleared) and
+//	   runs on. When the real input arrives and differs from what was
+//	   used, the world goes back to the snapshot taken before that tick
+//	   and the ticks since are simulated again with the corrected inputs,
+//	   all before the next frame is drawn.
+//
+//	   A peer never gets more than kMaxRollback ticks ahead of the last
+//	   input it has from the other, which bounds both the snapshots kept
+//	   and the work of one rollback. Local input is applied aInputDelay
+//	   ticks after it is sampled; a tick or two of delay hides most of
+//	   the round trip and makes rollbacks shorter and rarer. A peer whose
+//	   clock runs ahead of the other's (it started first, or its frames
+//	   run fast) skips ticks until they line up again, so neither ends up
+//	   predicting further than the latency makes it.
+//
+//	   Every datagram carries all the local inputs the peer has not
+//	   acknowledged yet, so a lost one costs nothing once the next gets
+//	   through. It also carries the hash of the newest world state that
+//	   both peers have final inputs for; a peer that computes a different
+//	   hash for the same tick reports a desync.
+//
+//	   The match ends when either peer leaves (Disconnect tells the other)
+//	   or nothing has arrived from the other for the timeout; from then
+//	   on the session neither advances nor sends, and End() says why.
+//-----------------------------------------------------------------------------
+
+#ifndef _ROLLBACKSESSION_H_
+#define _ROLLBACKSESSION_H_
+
+//-----------------------------------------------------------------------------
+// RollbackSession Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include "WorldSnapshot.h"
+
+//-----------------------------------------------------------------------------
+// Forward Declarations
+//-----------------------------------------------------------------------------
+class INetTransport;
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : IRollbackWorld (Class)
+// Desc : What the session needs from the game: save and restore the whole
+//		simulation, and advance it by one tick.
+//-----------------------------------------------------------------------------
+class IRollbackWorld
+{
+public:
+	IRollbackWorld() = default;
+
+	virtual ~IRollbackWorld() = default;
+
+	virtual void SaveState(WorldSnapshot & aSnapshot) = 0;
+	virtual bool LoadState(const WorldSnapshot & aSnapshot) = 0;
+
+	// One tick with each player's buttons, indexed by player. aReplaying is
+	// set while ticks are re-simulated after a rollback, which should not
+	// be heard a second time.
+	virtual void SimulateTick(const uint16_t aButtons[], bool aReplaying) = 0;
+
+private:
+	IRollbackWorld(const IRollbackWorld &);
+	IRollbackWorld & operator=(const IRollbackWorld &);
+};
+
+//-----------------------------------------------------------------------------
+// Enumerators
+//-----------------------------------------------------------------------------
+enum SessionEnd
+{
+	SESSION_RUNNING,
+	SESSION_LEFT,			// This peer disconnected
+	SESSION_PEER_LEFT,		// The other peer said it was leaving
+	SESSION_TIMED_OUT		// The other peer went silent
+};
+
+//-----------------------------------------------------------------------------
+// Name : RollbackStats (Struct)
+// Desc : Running totals, for the title bar and the benchmark.
+//-----------------------------------------------------------------------------
+struct RollbackStats
+{
+	uint32_t mRollbacks;		// Times the world went back
+	uint32_t mReplayedTicks;	// Ticks simulated again, over all rollbacks
+	uint32_t mMaxDepth;			// Most ticks simulated again at once
+	uint32_t mStalls;			// Polls spent waiting on the remote input
+	uint32_t mPacketsSent;
+	uint32_t mPacketsReceived;
+	double   mLastRollbackSeconds;	// Restore plus re-simulation
+	double   mMaxRollbackSeconds;
+};
+
+//-----------------------------------------------------------------------------
+// Name : RollbackSession (Class)
+// Desc : One peer's view of a two player game.
+//-----------------------------------------------------------------------------
+class RollbackSession
+{
+public:
+	static const uint32_t kPlayerCount = 2;
+	static const uint32_t kMaxRollback = 8;		// Ticks of prediction allowed
+	static const uint32_t kMaxInputDelay = 8;
+
+	// aLocalPlayer is 0 or 1, the other peer must use the other one.
+	RollbackSession(IRollbackWorld & aWorld, INetTransport & aTransport, uint32_t aLocalPlayer, uint32_t aInputDelay);
+
+	// Buttons that stay down between ticks; the others (presses) are
+	// predicted released. Defaults to none, so every prediction is idle.
+	void SetHeldButtons(uint16_t aMask) { mHeldButtons = aMask; }
+
+	// Seconds without a datagram, once the peer has been heard from, that
+	// end the match. Before that the session waits for it indefinitely.
+	void SetTimeout(double aSeconds)    { mTimeout = aSeconds; }
+
+	// Time is the real clock unless SetTime drives it.
+	void SetTime(double aSeconds);
+
+	// Tells the peer this one is leaving and ends the match. Sent a few
+	// times over, since any one datagram may be lost.
+	void Disconnect();
+
+	// Reads every waiting datagram and, if a remote input turned out
+	// different from its prediction, rolls back and catches up.
+	void Poll();
+
+	// False while this peer is kMaxRollback ticks ahead of the remote
+	// input, or ahead of the other peer's clock; the caller should skip
+	// the tick and try again next frame.
+	bool CanAdvance() const;
+
+	// Samples aButtons as the local input for aInputDelay ticks from now,
+	// simulates the current tick and sends the inputs.
+	void Advance(uint16_t aButtons);
+
+	uint32_t Tick() const           { return mTick; }
+
+	// Tick the next Advance's input will be simulated in.
+	uint32_t InputTick() const      { return mLocalCount; }
+	uint32_t LocalPlayer() const    { return mLocalPlayer; }
+
+	// Ticks for which the remote input has arrived.
+	uint32_t RemoteInputCount() const { return mRemoteCount; }
+
+	// Ticks this peer is ahead of the remote input.
+	uint32_t PredictedTicks() const { return mTick > mRemoteCount ? mTick - mRemoteCount : 0; }
+
+	// Set once both peers computed different worlds for the same tick.
+	bool     IsDesynced() const     { return mDesynced; }
+	bool     HasRemote() const      { return mStats.mPacketsReceived != 0; }
+
+	SessionEnd End() const          { return mEnd; }
+	bool     IsOver() const         { return mEnd != SESSION_RUNNING; }
+
+	const RollbackStats & Stats() const { return mStats; }
+
+private:
+	RollbackSession(const RollbackSession &);
+	RollbackSession & operator=(const RollbackSession &);
+
+	static const uint32_t kInputHistory = 64;	// Ticks of input kept, a power of two
+	static const uint32_t kSnapshotCount = kMaxRollback + 2;
+	static const uint32_t kSyncHistory = 32;	// Hashes of final states kept
+	static const uint32_t kSyncInterval = 16;	// Ticks between hashed states
+	static const uint32_t kMaxPacketInputs = 32;
+	static const int32_t  kMaxLead = 2;			// Ticks ahead of the peer's clock before waiting
+	static const uint32_t kQuitRepeats = 4;		// Copies of the leaving datagram
+
+	double  Now() const;
+	int32_t LocalAdvantage() const;
+	int32_t TicksAhead() const;
+	void SimulateOne(uint32_t aTick, bool aReplaying);
+	void Rollback(uint32_t aFirstTick);
+	void ReadDatagram(const uint8_t * aData, size_t aSize);
+	void ConfirmRemote(uint32_t aTick, uint16_t aButtons);
+	void UpdateSyncHash();
+	void CheckSync(uint32_t aTick, uint64_t aHash);
+	void SendInputs();
+
+	IRollbackWorld & mWorld;
+	INetTransport &  mTransport;
+	uint32_t         mLocalPlayer;
+	uint32_t         mInputDelay;
+	uint16_t         mHeldButtons;
+
+	uint32_t mTick;				// Next tick to simulate
+	uint32_t mLocalCount;		// Ticks with a local input
+	uint32_t mRemoteCount;		// Ticks with the remote input, all of them contiguous
+	uint32_t mRemoteAcked;		// Local inputs the peer has
+	uint32_t mRollbackFrom;		// Earliest mispredicted tick, mTick if none
+	uint32_t mPeerTick;			// The peer's clock, as last reported
+	int32_t  mPeerAdvantage;	// And how far ahead it thought it was then
+
+	uint16_t mLocalInput[kInputHistory];
+	uint16_t mRemoteInput[kInputHistory];	// Confirmed
+	uint16_t mRemoteUsed[kInputHistory];	// What the simulated tick used
+
+	// World at the start of tick t in mSnapshots[t % kSnapshotCount].
+	WorldSnapshot mSnapshots[kSnapshotCount];
+
+	// Hashes of every kSyncInterval'th final state; the newest is sent
+	// with every datagram.
+	uint32_t mSyncTick[kSyncHistory];
+	uint64_t mSyncHash[kSyncHistory];
+	uint32_t mSyncCount;			// States hashed, newest at mSyncCount - 1
+	uint32_t mFinalTick;			// States before this one have been looked at
+	uint32_t mPeerSyncTick;			// Newest hash from the peer not yet checked
+	uint64_t mPeerSyncHash;
+	bool     mPeerSyncPending;
+	bool     mDesynced;
+	bool     mSentSincePoll;
+
+	SessionEnd mEnd;
+	double   mTimeout;
+	bool     mManualTime;
+	double   mTime;
+	double   mLastReceived;		// When the newest datagram arrived
+
+	RollbackStats mStats;
+};
+
+#endif // _ROLLBACKSESSION_H_
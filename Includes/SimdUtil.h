@@ -0,0 +1,74 @@
+//-----------------------------------------------------------------------------
+// File: SimdUtil.h
+//
+// Desc: Small helpers shared by the batched (SIMD) kernels. Selects the SSE2
+//	   code paths when the compiler targets them and provides portable bit
+//	   scanning for walking hit bitmasks.
+//-----------------------------------------------------------------------------
+
+#ifndef _SIMDUTIL_H_
+#define _SIMDUTIL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace SimdUtil
+{
+	//-------------------------------------------------------------------------
+	// Name : CountTrailingZeros ()
+	// Desc : Index of the lowest set bit. aValue must not be zero.
+	//-------------------------------------------------------------------------
+	inline unsigned CountTrailingZeros(uint32_t aValue)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, aValue);
+		return (unsigned)index;
+#else
+		return (unsigned)__builtin_ctz(aValue);
+#endif
+	}
+
+	//-------------------------------------------------------------------------
+	// Name : PopCount ()
+	// Desc : Number of set bits.
+	//-------------------------------------------------------------------------
+	inline unsigned PopCount(uint32_t aValue)
+	{
+		aValue = aValue - ((aValue >> 1) & 0x55555555u);
+		aValue = (aValue & 0x33333333u) + ((aValue >> 2) & 0x33333333u);
+		return (((aValue + (aValue >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+	}
+
+	//-------------------------------------------------------------------------
+	// Name : ForEachSetBit ()
+	// Desc : Calls aFunc(index) for every set bit of a multi-word bitmask.
+	//-------------------------------------------------------------------------
+	template <typename Func>
+	inline void ForEachSetBit(const uint32_t * aMask, size_t aWords, Func aFunc)
+	{
+		for (size_t w = 0; w < aWords; ++w)
+		{
+			uint32_t bits = aMask[w];
+			while (bits)
+			{
+				aFunc(w * 32 + CountTrailingZeros(bits));
+				bits &= bits - 1;
+			}
+		}
+	}
+}
+
+#endif // _SIMDUTIL_H_
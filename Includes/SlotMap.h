@@ -0,0 +1,94 @@
+//-----------------------------------------------------------------------------
+// File: SlotMap.h
+//
+// Desc: Stable handles for densely packed collections. The owner keeps its
+//	   data in dense arrays and removes by moving the last element into the
+//	   hole; SlotMap mirrors those moves in a sparse slot table so a handle
+//	   always resolves to the current dense index in O(1).
+//
+//	   Every slot carries a generation that is bumped when its element is
+//	   erased, so handles to erased elements are detected, never aliased.
+//-----------------------------------------------------------------------------
+
+#ifndef _SLOTMAP_H_
+#define _SLOTMAP_H_
+
+//-----------------------------------------------------------------------------
+// SlotMap Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class WorldSnapshot;
+class SnapshotReader;
+
+//-----------------------------------------------------------------------------
+// Name : SlotHandle (Struct)
+// Desc : Slot + generation. A default constructed handle is never valid.
+//-----------------------------------------------------------------------------
+struct SlotHandle
+{
+	uint32_t mSlot;
+	uint32_t mGeneration;
+
+	SlotHandle() : mSlot(0), mGeneration(0) {}
+	SlotHandle(uint32_t aSlot, uint32_t aGeneration) : mSlot(aSlot), mGeneration(aGeneration) {}
+
+	bool IsNull() const { return mGeneration == 0; }
+
+	bool operator==(const SlotHandle & aOther) const
+	{
+		return mSlot == aOther.mSlot && mGeneration == aOther.mGeneration;
+	}
+	bool operator!=(const SlotHandle & aOther) const { return !(*this == aOther); }
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : SlotMap (Class)
+// Desc : Dense index <-> slot bookkeeping with a free list of slots.
+//-----------------------------------------------------------------------------
+class SlotMap
+{
+public:
+	static const size_t kInvalidIndex = (size_t)-1;
+
+	SlotMap();
+
+	// Reserving up front makes Insert / EraseAt allocation free.
+	void Reserve(size_t aCount);
+	void Clear();
+
+	// Slots, generations and free list, see WorldSnapshot.
+	void SaveState(WorldSnapshot & aSnapshot) const;
+	bool LoadState(SnapshotReader & aReader);
+
+	// Registers a new element the owner has appended at index Size().
+	SlotHandle Insert();
+
+	// Forgets the element at aIndex. The owner must move its last element
+	// into aIndex (or just pop it when aIndex is the last one).
+	void EraseAt(size_t aIndex);
+
+	size_t     IndexOf(SlotHandle aHandle) const;
+	SlotHandle HandleAt(size_t aIndex) const;
+	bool       IsAlive(SlotHandle aHandle) const { return IndexOf(aHandle) != kInvalidIndex; }
+
+	size_t Size() const { return mSlotOfIndex.size(); }
+
+private:
+	struct Slot
+	{
+		uint32_t mIndex;		// Dense index while alive
+		uint32_t mGeneration;	// Bumped on erase, never 0
+	};
+
+	std::vector<Slot>     mSlots;
+	std::vector<uint32_t> mSlotOfIndex;	// Dense index -> slot
+	std::vector<uint32_t> mFreeSlots;
+};
+
+#endif // _SLOTMAP_H_
@@ -0,0 +1,277 @@
+//-----------------------------------------------------------------------------
+// File: SpatialGrid.h
+//
+// Desc: Uniform grid over a RectangleSoA, rebuilt from scratch each frame.
+//	   Cells are stored compressed (cell start offsets + item indices) so a
+//	   rebuild is two linear passes with no per cell allocations.
+//
+//	   Queries hand candidates to a caller supplied narrowphase, which is
+//	   where pixel masks, hit points etc. are resolved.
+//-----------------------------------------------------------------------------
+
+#ifndef _SPATIALGRID_H_
+#define _SPATIALGRID_H_
+
+//-----------------------------------------------------------------------------
+// SpatialGrid Specific Includes
+//-----------------------------------------------------------------------------
+#include <stdint.h>
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+#include <vector>
+#include "RectangleSoA.h"
+
+//-----------------------------------------------------------------------------
+// Name : RayHit (Struct)
+// Desc : Result of a ray / segment query.
+//-----------------------------------------------------------------------------
+struct RayHit
+{
+	uint32_t mIndex;	// Index into the rectangles the grid was built from
+	float    mDistance;	// Distance along the (normalised) ray
+	float    mX;		// Hit point
+	float    mY;
+};
+
+//-----------------------------------------------------------------------------
+// Name : GridItem (Struct)
+// Desc : One rectangle entry in a cell. The box is copied in cell order so
+//		queries stream through memory instead of gathering by index.
+//-----------------------------------------------------------------------------
+struct GridItem
+{
+	float    mLeft;
+	float    mTop;
+	float    mRight;
+	float    mBottom;
+	uint32_t mIndex;
+	int32_t  mFirstCellX;	// Top-left cell the rectangle occupies
+	int32_t  mFirstCellY;
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : SpatialGrid (Class)
+// Desc : Uniform grid acceleration structure for ray and area queries.
+//-----------------------------------------------------------------------------
+class SpatialGrid
+{
+public:
+	explicit SpatialGrid(int32_t aCellSize = 64);
+
+	void   Build(const RectangleSoA & aRectangles);
+	void   Clear();
+
+	size_t Size() const { return mRectangles ? mRectangles->Size() : 0; }
+	int32_t CellSize() const { return mCellSize; }
+
+	//-------------------------------------------------------------------------
+	// Name : Raycast ()
+	// Desc : Walks the cells along the segment origin + t * dir, t in
+	//		[0, aMaxDistance], and returns the closest confirmed hit.
+	//		aNarrow(index, enterT, exitT, hitT&) refines a candidate whose
+	//		box the ray crosses between enterT and exitT.
+	//-------------------------------------------------------------------------
+	template <typename NarrowPhase>
+	bool Raycast(float aOriginX, float aOriginY, float aDirX, float aDirY,
+	             float aMaxDistance, NarrowPhase aNarrow, RayHit & aHit) const;
+
+	//-------------------------------------------------------------------------
+	// Name : QueryRadius ()
+	// Desc : Calls aVisit(index) once for every rectangle touching the
+	//		circle. Items spanning several cells are reported only from the
+	//		first cell of the query range they occupy.
+	//-------------------------------------------------------------------------
+	template <typename Visitor>
+	void QueryRadius(float aX, float aY, float aRadius, Visitor aVisit) const;
+
+	// Up to aCount rectangles closest to (aX, aY) by centre distance, within
+	// aMaxDistance, sorted nearest first. Intended for small aCount.
+	size_t FindNearest(float aX, float aY, size_t aCount, float aMaxDistance,
+	                   uint32_t * aIndices, float * aDistances) const;
+
+	// Ray against a box [aLeft, aRight + 1) x [aTop, aBottom + 1).
+	static bool RayBox(float aOriginX, float aOriginY, float aInvDirX, float aInvDirY,
+	                   float aLeft, float aTop, float aRight, float aBottom,
+	                   float & aEnterT, float & aExitT);
+
+private:
+	int32_t CellX(int32_t aX) const;
+	int32_t CellY(int32_t aY) const;
+
+	int32_t mBaseCellSize;
+	int32_t mCellSize;
+	int32_t mOriginX;
+	int32_t mOriginY;
+	int32_t mColumns;
+	int32_t mRows;
+
+	std::vector<uint32_t> mCellStart;	// mColumns * mRows + 1 offsets into mItems
+	std::vector<GridItem> mItems;
+	std::vector<int32_t>  mFirstCellX;
+	std::vector<int32_t>  mFirstCellY;
+	const RectangleSoA *  mRectangles;
+};
+
+//-----------------------------------------------------------------------------
+// SpatialGrid Inline Functions
+//-----------------------------------------------------------------------------
+inline bool SpatialGrid::RayBox(float aOriginX, float aOriginY, float aInvDirX, float aInvDirY,
+                                float aLeft, float aTop, float aRight, float aBottom,
+                                float & aEnterT, float & aExitT)
+{
+	float tx1 = (aLeft - aOriginX) * aInvDirX;
+	float tx2 = (aRight + 1.0f - aOriginX) * aInvDirX;
+	float ty1 = (aTop - aOriginY) * aInvDirY;
+	float ty2 = (aBottom + 1.0f - aOriginY) * aInvDirY;
+
+	aEnterT = std::max(std::min(tx1, tx2), std::min(ty1, ty2));
+	aExitT  = std::min(std::max(tx1, tx2), std::max(ty1, ty2));
+
+	return aEnterT <= aExitT;
+}
+
+template <typename NarrowPhase>
+bool SpatialGrid::Raycast(float aOriginX, float aOriginY, float aDirX, float aDirY,
+                          float aMaxDistance, NarrowPhase aNarrow, RayHit & aHit) const
+{
+	if (!mRectangles || mRectangles->IsEmpty())
+		return false;
+
+	// Axis aligned rays get a huge finite inverse rather than inf, so the
+	// slab test never evaluates 0 * inf.
+	const float invX = 1.0f / (aDirX != 0.0f ? aDirX : 1e-30f);
+	const float invY = 1.0f / (aDirY != 0.0f ? aDirY : 1e-30f);
+
+	// Clip the segment against the grid bounds.
+	float enterT, exitT;
+	if (!RayBox(aOriginX, aOriginY, invX, invY,
+	            (float)mOriginX, (float)mOriginY,
+	            (float)(mOriginX + mColumns * mCellSize) - 1.0f,
+	            (float)(mOriginY + mRows * mCellSize) - 1.0f,
+	            enterT, exitT))
+		return false;
+
+	enterT = std::max(enterT, 0.0f);
+	exitT  = std::min(exitT, aMaxDistance);
+	if (enterT > exitT)
+		return false;
+
+	const float startX = aOriginX + aDirX * enterT - mOriginX;
+	const float startY = aOriginY + aDirY * enterT - mOriginY;
+
+	int32_t cx = std::min(std::max((int32_t)floorf(startX / mCellSize), 0), mColumns - 1);
+	int32_t cy = std::min(std::max((int32_t)floorf(startY / mCellSize), 0), mRows - 1);
+
+	const int32_t stepX = invX > 0.0f ? 1 : -1;
+	const int32_t stepY = invY > 0.0f ? 1 : -1;
+	const float deltaX = fabsf(mCellSize * invX);
+	const float deltaY = fabsf(mCellSize * invY);
+
+	float nextX = enterT + ((stepX > 0 ? cx + 1 : cx) * (float)mCellSize - startX) * invX;
+	float nextY = enterT + ((stepY > 0 ? cy + 1 : cy) * (float)mCellSize - startY) * invY;
+
+	float bestT = FLT_MAX;
+	uint32_t bestIndex = 0;
+
+	for (;;)
+	{
+		const float cellExitT = std::min(std::min(nextX, nextY), exitT);
+		const int32_t cell = cy * mColumns + cx;
+
+		for (uint32_t i = mCellStart[cell]; i < mCellStart[cell + 1]; ++i)
+		{
+			const GridItem & item = mItems[i];
+
+			float boxEnter, boxExit;
+			if (!RayBox(aOriginX, aOriginY, invX, invY,
+			            item.mLeft, item.mTop, item.mRight, item.mBottom,
+			            boxEnter, boxExit))
+				continue;
+
+			boxEnter = std::max(boxEnter, enterT);
+			boxExit  = std::min(boxExit, exitT);
+			if (boxEnter > boxExit || boxEnter >= bestT)
+				continue;
+
+			float hitT;
+			if (aNarrow(item.mIndex, boxEnter, boxExit, hitT) && hitT < bestT)
+			{
+				bestT     = hitT;
+				bestIndex = item.mIndex;
+			}
+		}
+
+		// Anything in later cells is further away than a hit in this one.
+		if (bestT <= cellExitT || cellExitT >= exitT)
+			break;
+
+		if (nextX < nextY)
+		{
+			cx    += stepX;
+			nextX += deltaX;
+			if (cx < 0 || cx >= mColumns)
+				break;
+		}
+		else
+		{
+			cy    += stepY;
+			nextY += deltaY;
+			if (cy < 0 || cy >= mRows)
+				break;
+		}
+	}
+
+	if (bestT == FLT_MAX)
+		return false;
+
+	aHit.mIndex    = bestIndex;
+	aHit.mDistance = bestT;
+	aHit.mX        = aOriginX + aDirX * bestT;
+	aHit.mY        = aOriginY + aDirY * bestT;
+	return true;
+}
+
+template <typename Visitor>
+void SpatialGrid::QueryRadius(float aX, float aY, float aRadius, Visitor aVisit) const
+{
+	if (!mRectangles || mRectangles->IsEmpty() || aRadius < 0.0f)
+		return;
+
+	const int32_t x0 = CellX((int32_t)floorf(aX - aRadius));
+	const int32_t x1 = CellX((int32_t)ceilf(aX + aRadius));
+	const int32_t y0 = CellY((int32_t)floorf(aY - aRadius));
+	const int32_t y1 = CellY((int32_t)ceilf(aY + aRadius));
+
+	const float radiusSq = aRadius * aRadius;
+
+	for (int32_t cy = y0; cy <= y1; ++cy)
+	{
+		for (int32_t cx = x0; cx <= x1; ++cx)
+		{
+			const int32_t cell = cy * mColumns + cx;
+			for (uint32_t i = mCellStart[cell]; i < mCellStart[cell + 1]; ++i)
+			{
+				const GridItem & item = mItems[i];
+
+				// De-duplicate without per query state.
+				if (std::max(item.mFirstCellX, x0) != cx ||
+				    std::max(item.mFirstCellY, y0) != cy)
+					continue;
+
+				const float nearX = std::min(std::max(aX, item.mLeft), item.mRight);
+				const float nearY = std::min(std::max(aY, item.mTop), item.mBottom);
+				const float dx = nearX - aX;
+				const float dy = nearY - aY;
+
+				if (dx * dx + dy * dy <= radiusSq)
+					aVisit(item.mIndex);
+			}
+		}
+	}
+}
+
+#endif // _SPATIALGRID_H_
@@ -7,6 +7,7 @@
 #include "main.h"
 #include "Vec2.h"
 #include "BackBuffer.h"
+#include "Profiler.h"
 
 class Sprite
 {
@@ -54,6 +55,7 @@ protected:
 	const BackBuffer *mpBackBuffer;
 
 	COLORREF mcTransparentColor;
+
 	void drawTransparent();
 	void drawMask();
 };
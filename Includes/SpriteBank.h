@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------
+// File: SpriteBank.h
+//
+// Desc: One shared sprite per kind of entity: its collision mask, kept
+//	   here, and its image, which the platform loads and draws. Entities
+//	   only carry a SpriteId; drawing places the shared sprite at the
+//	   entity's position.
+//-----------------------------------------------------------------------------
+
+#ifndef _SPRITEBANK_H_
+#define _SPRITEBANK_H_
+
+//-----------------------------------------------------------------------------
+// SpriteBank Specific Includes
+//-----------------------------------------------------------------------------
+#include <string>
+#include "CollisionMask.h"
+#include "EntityStore.h"
+#include "Platform.h"
+
+//-----------------------------------------------------------------------------
+// Enumerators
+//-----------------------------------------------------------------------------
+enum SpriteId
+{
+	SPRITE_ENEMY,
+	SPRITE_BOSS,
+	SPRITE_BULLET_UP,
+	SPRITE_BULLET_DOWN,
+	SPRITE_BULLET_LEFT,
+	SPRITE_BULLET_RIGHT,
+	SPRITE_PLAYER_UP,
+	SPRITE_PLAYER_DOWN,
+	SPRITE_PLAYER_LEFT,
+	SPRITE_PLAYER_RIGHT,
+	SPRITE_EXPLOSION,	// Animated
+	SPRITE_COUNT
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : SpriteBank (Class)
+// Desc : Loads every shared sprite once and draws them by id.
+//-----------------------------------------------------------------------------
+class SpriteBank
+{
+public:
+	explicit SpriteBank(IPlatform & aPlatform);
+
+	// Reads every mask and has the platform load every image. Returns
+	// false and leaves the reason in aError if a file is missing or bad.
+	bool Load(std::string & aError);
+
+	// Size of one frame.
+	int Width(uint16_t aSprite) const  { return mFrameWidth[aSprite]; }
+	int Height(uint16_t aSprite) const { return mFrameHeight[aSprite]; }
+	int FrameCount(uint16_t aSprite) const;
+
+	// The whole sheet, for animated sprites.
+	const CollisionMask & GetCollisionMask(uint16_t aSprite) const { return mMasks[aSprite]; }
+
+	void Draw(uint16_t aSprite, float aX, float aY, int aFrame = 0);
+
+	// Draws every entity at aAlpha (0 .. 1) of the way from its previous
+	// tick position to its current one.
+	void DrawEntities(const EntityStore & aEntities, float aAlpha);
+
+private:
+	IPlatform &   mPlatform;
+	CollisionMask mMasks[SPRITE_COUNT];
+	int           mFrameWidth[SPRITE_COUNT];
+	int           mFrameHeight[SPRITE_COUNT];
+};
+
+#endif // _SPRITEBANK_H_
@@ -0,0 +1,61 @@
+//-----------------------------------------------------------------------------
+// File: UdpTransport.h
+//
+// Desc: INetTransport over a non-blocking IPv4 UDP socket (Winsock on
+//	   Windows, BSD sockets elsewhere).
+//
+//	   The joining side knows the host's address up front. The hosting
+//	   side only binds its port and takes the address of the first peer
+//	   that sends to it; datagrams from anyone else are ignored after that.
+//-----------------------------------------------------------------------------
+
+#ifndef _UDPTRANSPORT_H_
+#define _UDPTRANSPORT_H_
+
+//-----------------------------------------------------------------------------
+// UdpTransport Specific Includes
+//-----------------------------------------------------------------------------
+#include <stdint.h>
+#include <string>
+#include "NetTransport.h"
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : UdpTransport (Class)
+// Desc : One socket, one peer.
+//-----------------------------------------------------------------------------
+class UdpTransport : public INetTransport
+{
+public:
+	UdpTransport();
+	~UdpTransport();
+
+	// Waits for the first peer on aPort.
+	bool Host(uint16_t aPort, std::string & aError);
+
+	// Sends to aAddress ("host:port") from any free local port.
+	bool Join(const std::string & aAddress, std::string & aError);
+
+	void Close();
+
+	bool IsOpen() const  { return mSocket != kNoSocket; }
+	bool HasPeer() const { return mHasPeer; }
+
+	bool   Send(const void * aData, size_t aSize) override;
+	size_t Receive(void * aBuffer, size_t aCapacity) override;
+
+private:
+	static const intptr_t kNoSocket = -1;
+
+	bool Open(uint16_t aPort, std::string & aError);
+
+	intptr_t mSocket;
+	bool     mStarted;		// Winsock started by this instance
+	bool     mHasPeer;
+	uint32_t mPeerAddress;	// IPv4, network byte order
+	uint16_t mPeerPort;		// Network byte order
+};
+
+#endif // _UDPTRANSPORT_H_
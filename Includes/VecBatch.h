@@ -0,0 +1,43 @@
+//-----------------------------------------------------------------------------
+// File: VecBatch.h
+//
+// Desc: Single precision vector math over arrays of 2D vectors stored as
+//	   separate x / y arrays (the EntityStore layout). Every routine works
+//	   on four lanes at a time with SSE2 and falls back to plain loops
+//	   otherwise; Vec2 stays the scalar type for one-off gameplay math.
+//
+//	   Output arrays may alias the matching inputs.
+//-----------------------------------------------------------------------------
+
+#ifndef _VECBATCH_H_
+#define _VECBATCH_H_
+
+//-----------------------------------------------------------------------------
+// VecBatch Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+
+namespace VecBatch
+{
+	// aX[i] += aVelocityX[i] * aTime, same for y.
+	void Integrate(float * aX, float * aY, const float * aVelocityX, const float * aVelocityY,
+	               size_t aCount, float aTime);
+
+	// Scales every vector to unit length; zero vectors stay zero.
+	void Normalize(float * aX, float * aY, size_t aCount);
+
+	// Rotates every vector by the same angle.
+	void Rotate(float * aX, float * aY, size_t aCount, float aRadians);
+
+	// aOut[i] = distance (squared) from (aPointX, aPointY) to vector i.
+	void Distance(const float * aX, const float * aY, size_t aCount,
+	              float aPointX, float aPointY, float * aOut);
+	void DistanceSquared(const float * aX, const float * aY, size_t aCount,
+	                     float aPointX, float aPointY, float * aOut);
+
+	// aOut[i] = sin(aIn[i]), parabolic approximation with |error| < 0.001;
+	// plenty for motion.
+	void Sin(const float * aIn, float * aOut, size_t aCount);
+}
+
+#endif // _VECBATCH_H_
@@ -0,0 +1,123 @@
+//-----------------------------------------------------------------------------
+// File: WaveScript.h
+//
+// Desc: Level description loaded from a text file and compiled once, at
+//	   load, into flat tables: movement paths, fire patterns, and per wave
+//	   a time sorted run of spawn events. At run time a cursor walks the
+//	   events of the current wave, so a frame only touches the events that
+//	   are due and nothing is parsed after loading.
+//
+//	   Format (one statement per line, '#' starts a comment):
+//
+//	     path <name> hold
+//	     path <name> sine <amplitudeX> <amplitudeY> <frequency>
+//	     path <name> dive <delay> <acceleration> <period> <sway> <swayFrequency>
+//	     path <name> spline <segmentsPerSecond> <x0> <y0> <x1> <y1> ...
+//	     fire <name> <interval> <volley> <speed>
+//	     wave <fire> [chase <speed>]
+//	       at <time> line <path> <count> <x> <y> <spacing> <stagger>
+//	       at <time> boss <path> <x> <y>
+//	     end
+//-----------------------------------------------------------------------------
+
+#ifndef _WAVESCRIPT_H_
+#define _WAVESCRIPT_H_
+
+//-----------------------------------------------------------------------------
+// WaveScript Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "Formation.h"
+
+//-----------------------------------------------------------------------------
+// Forward Declarations
+//-----------------------------------------------------------------------------
+class IPlatform;
+
+//-----------------------------------------------------------------------------
+// Enumerators
+//-----------------------------------------------------------------------------
+enum WaveEventType
+{
+	WAVE_EVENT_LINE,	// mCount enemies, mSpacing apart, mStagger seconds apart on the path
+	WAVE_EVENT_BOSS		// One boss
+};
+
+//-----------------------------------------------------------------------------
+// Compiled Tables
+//-----------------------------------------------------------------------------
+struct WaveEvent
+{
+	float    mTime;		// Seconds from the start of the wave
+	uint8_t  mType;		// WaveEventType
+	uint8_t  mReserved;
+	uint16_t mPath;		// Index into Paths()
+	uint16_t mCount;
+	uint16_t mReserved2;
+	float    mX;
+	float    mY;
+	float    mSpacing;
+	float    mStagger;
+};
+
+struct FirePattern
+{
+	float    mInterval;	// Seconds between volleys
+	uint32_t mVolley;	// Shots per volley, each from a random enemy
+	float    mSpeed;	// Bullet speed, pixels per second
+};
+
+struct WaveInfo
+{
+	uint32_t mFirstEvent;
+	uint32_t mEventCount;
+	uint32_t mFirePattern;
+	float    mChaseSpeed;	// Pixels per second the slots drift toward the players, 0 for none
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : WaveScript (Class)
+// Desc : Compiler for the wave text format and owner of the compiled tables.
+//-----------------------------------------------------------------------------
+class WaveScript
+{
+public:
+	WaveScript();
+
+	// Both return false and leave a message in GetError() on failure.
+	// The file is read through aPlatform.
+	bool LoadFromFile(IPlatform & aPlatform, const char * szFileName);
+	bool Compile(const char * szText);
+
+	const std::string & GetError() const { return mError; }
+
+	// Spline paths index into PointX() / PointY().
+	const std::vector<FormationPath> & Paths() const        { return mPaths; }
+	const std::vector<float> &         PointX() const       { return mPointX; }
+	const std::vector<float> &         PointY() const       { return mPointY; }
+	const std::vector<FirePattern> &   FirePatterns() const { return mFirePatterns; }
+	const std::vector<WaveInfo> &      Waves() const        { return mWaves; }
+	const std::vector<WaveEvent> &     Events() const       { return mEvents; }
+
+	// Copies the path table into aFormation; path ids match Paths().
+	void RegisterPaths(Formation & aFormation) const;
+
+private:
+	bool Fail(int aLine, const char * szMessage);
+
+	std::vector<FormationPath> mPaths;
+	std::vector<float>         mPointX;
+	std::vector<float>         mPointY;
+	std::vector<FirePattern>   mFirePatterns;
+	std::vector<WaveInfo>      mWaves;
+	std::vector<WaveEvent>     mEvents;
+	std::string                mError;
+};
+
+#endif // _WAVESCRIPT_H_
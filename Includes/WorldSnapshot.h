@@ -0,0 +1,144 @@
+//-----------------------------------------------------------------------------
+// File: WorldSnapshot.h
+//
+// Desc: The simulation state as one contiguous block of plain bytes, for
+//	   instant restart, rewind and rollback without touching the assets.
+//
+//	   Every stateful piece writes its fields and component arrays in a
+//	   fixed order with SaveState and reads them back in the same order
+//	   with LoadState. Only trivially copyable values go in, each written
+//	   field by field or as a padding free array, so a snapshot is nothing
+//	   but memcpy'd data: saving and restoring cost a few copies of the
+//	   live arrays, and equal states give equal bytes and equal hashes.
+//
+//	   Assets (sprites, masks, the compiled wave script, paths) are not
+//	   part of it; they are the same before and after a restore. Buffers
+//	   keep their capacity, so a snapshot reused every tick stops
+//	   allocating once it has seen the largest world.
+//-----------------------------------------------------------------------------
+
+#ifndef _WORLDSNAPSHOT_H_
+#define _WORLDSNAPSHOT_H_
+
+//-----------------------------------------------------------------------------
+// WorldSnapshot Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : WorldSnapshot (Class)
+// Desc : Append only byte block; read back with a SnapshotReader.
+//-----------------------------------------------------------------------------
+class WorldSnapshot
+{
+public:
+	WorldSnapshot() {}
+
+	// Empties the snapshot, keeping its buffer.
+	void Clear()                 { mData.clear(); }
+	void Reserve(size_t aBytes)  { mData.reserve(aBytes); }
+
+	const uint8_t * Data() const { return mData.data(); }
+	size_t          Size() const { return mData.size(); }
+	bool            IsEmpty() const { return mData.empty(); }
+
+	// 64 bit hash of the whole snapshot.
+	uint64_t Hash() const { return HashBytes(mData.data(), mData.size()); }
+
+	static uint64_t HashBytes(const void * aData, size_t aSize);
+
+	void WriteBytes(const void * aData, size_t aSize)
+	{
+		const size_t offset = mData.size();
+		mData.resize(offset + aSize);
+		if (aSize)
+			memcpy(&mData[offset], aData, aSize);
+	}
+
+	template <typename T>
+	void Write(const T & aValue)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain data only");
+		WriteBytes(&aValue, sizeof(T));
+	}
+
+	// Element count, then the elements.
+	template <typename T>
+	void WriteArray(const std::vector<T> & aArray)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain data only");
+		Write((uint32_t)aArray.size());
+		WriteBytes(aArray.data(), aArray.size() * sizeof(T));
+	}
+
+private:
+	std::vector<uint8_t> mData;
+};
+
+//-----------------------------------------------------------------------------
+// Name : SnapshotReader (Class)
+// Desc : Read cursor over a snapshot. A read past the end fails, leaves
+//		its target alone and makes every later read fail too.
+//-----------------------------------------------------------------------------
+class SnapshotReader
+{
+public:
+	explicit SnapshotReader(const WorldSnapshot & aSnapshot)
+		: mData(aSnapshot.Data()), mSize(aSnapshot.Size()), mOffset(0), mFailed(false) {}
+
+	bool   Failed() const    { return mFailed; }
+	bool   AtEnd() const     { return mOffset == mSize; }
+
+	bool ReadBytes(void * aData, size_t aSize)
+	{
+		if (mFailed || aSize > mSize - mOffset)
+		{
+			mFailed = true;
+			return false;
+		}
+
+		if (aSize)
+			memcpy(aData, mData + mOffset, aSize);
+		mOffset += aSize;
+		return true;
+	}
+
+	template <typename T>
+	bool Read(T & aValue)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain data only");
+		return ReadBytes(&aValue, sizeof(T));
+	}
+
+	// Resizes aArray to the stored count; reuses its capacity.
+	template <typename T>
+	bool ReadArray(std::vector<T> & aArray)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "snapshots hold plain data only");
+
+		uint32_t count;
+		if (!Read(count) || (size_t)count * sizeof(T) > mSize - mOffset)
+		{
+			mFailed = true;
+			return false;
+		}
+
+		aArray.resize(count);
+		return ReadBytes(aArray.data(), count * sizeof(T));
+	}
+
+private:
+	const uint8_t * mData;
+	size_t          mSize;
+	size_t          mOffset;
+	bool            mFailed;
+};
+
+#endif // _WORLDSNAPSHOT_H_
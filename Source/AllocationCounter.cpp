@@ -0,0 +1,101 @@
+//-----------------------------------------------------------------------------
+// File: AllocationCounter.cpp
+//
+// Desc: Replacement global operator new / delete that count what goes
+//	   through them, then hand the work to malloc and free.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// AllocationCounter Specific Includes
+//-----------------------------------------------------------------------------
+#include "AllocationCounter.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+
+//-----------------------------------------------------------------------------
+// Local Variables
+//-----------------------------------------------------------------------------
+namespace
+{
+	// Zero initialised before any constructor can allocate.
+	std::atomic<uint64_t> gAllocations;
+	std::atomic<uint64_t> gBytes;
+
+	AllocationStats gFrameStart;
+	bool            gExpectNone = false;
+
+	void * CountedAllocate(size_t aSize)
+	{
+		gAllocations.fetch_add(1, std::memory_order_relaxed);
+		gBytes.fetch_add(aSize, std::memory_order_relaxed);
+		return malloc(aSize ? aSize : 1);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Global Allocation Functions
+//-----------------------------------------------------------------------------
+void * operator new(size_t aSize)
+{
+	void * pointer = CountedAllocate(aSize);
+	if (!pointer)
+		throw std::bad_alloc();
+	return pointer;
+}
+
+void * operator new[](size_t aSize)
+{
+	return operator new(aSize);
+}
+
+void * operator new(size_t aSize, const std::nothrow_t &) noexcept
+{
+	return CountedAllocate(aSize);
+}
+
+void * operator new[](size_t aSize, const std::nothrow_t &) noexcept
+{
+	return CountedAllocate(aSize);
+}
+
+void operator delete(void * aPointer) noexcept                          { free(aPointer); }
+void operator delete[](void * aPointer) noexcept                        { free(aPointer); }
+void operator delete(void * aPointer, const std::nothrow_t &) noexcept   { free(aPointer); }
+void operator delete[](void * aPointer, const std::nothrow_t &) noexcept { free(aPointer); }
+void operator delete(void * aPointer, size_t) noexcept                  { free(aPointer); }
+void operator delete[](void * aPointer, size_t) noexcept                { free(aPointer); }
+
+//-----------------------------------------------------------------------------
+// AllocationCounter Member Functions
+//-----------------------------------------------------------------------------
+AllocationStats AllocationCounter::Total()
+{
+	AllocationStats stats;
+	stats.mAllocations = gAllocations.load(std::memory_order_relaxed);
+	stats.mBytes       = gBytes.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void AllocationCounter::BeginFrame()
+{
+	gFrameStart = Total();
+}
+
+AllocationStats AllocationCounter::EndFrame()
+{
+	const AllocationStats now = Total();
+
+	AllocationStats frame;
+	frame.mAllocations = now.mAllocations - gFrameStart.mAllocations;
+	frame.mBytes       = now.mBytes - gFrameStart.mBytes;
+
+	assert(!gExpectNone || frame.mAllocations == 0);
+	return frame;
+}
+
+void AllocationCounter::ExpectNoAllocations(bool bExpect)
+{
+	gExpectNone = bExpect;
+}
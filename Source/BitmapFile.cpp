@@ -0,0 +1,103 @@
+//-----------------------------------------------------------------------------
+// File: BitmapFile.cpp
+//
+// Desc: Reads .bmp sprite masks without GDI.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BitmapFile Specific Includes
+//-----------------------------------------------------------------------------
+#include "BitmapFile.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+static const size_t kFileHeaderSize = 14;	// BITMAPFILEHEADER
+static const size_t kInfoHeaderSize = 40;	// BITMAPINFOHEADER, the smallest we read
+static const int    kMaxDimension   = 1 << 14;
+
+// The file is little endian whatever the machine is.
+static uint32_t ReadU32(const uint8_t * aData)
+{
+	return (uint32_t)aData[0] | ((uint32_t)aData[1] << 8) |
+		((uint32_t)aData[2] << 16) | ((uint32_t)aData[3] << 24);
+}
+
+static uint16_t ReadU16(const uint8_t * aData)
+{
+	return (uint16_t)(aData[0] | (aData[1] << 8));
+}
+
+//-----------------------------------------------------------------------------
+// Name : DecodeMask () (Static)
+// Desc : Walks the pixel rows bottom-up or top-down as the header says,
+//		looking palette entries up for the indexed depths.
+//-----------------------------------------------------------------------------
+bool BitmapFile::DecodeMask(const std::vector<uint8_t> & aFile, CollisionMask & aMask)
+{
+	const uint8_t * data = aFile.data();
+	if (aFile.size() < kFileHeaderSize + kInfoHeaderSize || data[0] != 'B' || data[1] != 'M')
+		return false;
+
+	const uint32_t pixelOffset = ReadU32(data + 10);
+	const uint8_t * info = data + kFileHeaderSize;
+	const uint32_t infoSize    = ReadU32(info);
+	const int32_t  width       = (int32_t)ReadU32(info + 4);
+	const int32_t  rawHeight   = (int32_t)ReadU32(info + 8);
+	const uint16_t bitCount    = ReadU16(info + 14);
+	const uint32_t compression = ReadU32(info + 16);
+	uint32_t       colours     = ReadU32(info + 32);
+
+	// Positive heights are stored bottom row first
+	const bool bottomUp = rawHeight > 0;
+	const int32_t height = bottomUp ? rawHeight : -rawHeight;
+
+	if (infoSize < kInfoHeaderSize || compression != 0)
+		return false;
+	if (width <= 0 || height <= 0 || width > kMaxDimension || height > kMaxDimension)
+		return false;
+	if (bitCount != 1 && bitCount != 4 && bitCount != 8 && bitCount != 24 && bitCount != 32)
+		return false;
+
+	// Indexed depths carry their palette (4 bytes, blue first) after the header
+	const uint8_t * palette = info + infoSize;
+	if (bitCount <= 8)
+	{
+		if (colours == 0 || colours > (1u << bitCount))
+			colours = 1u << bitCount;
+		if ((size_t)(palette - data) + (size_t)colours * 4 > aFile.size())
+			return false;
+	}
+
+	// Rows are padded to whole 32 bit words
+	const size_t rowBytes = (((size_t)width * bitCount + 31) / 32) * 4;
+	if (pixelOffset > aFile.size() || (aFile.size() - pixelOffset) / rowBytes < (size_t)height)
+		return false;
+
+	aMask.Resize(width, height);
+	for (int32_t y = 0; y < height; ++y)
+	{
+		const uint8_t * row = data + pixelOffset + rowBytes * (size_t)(bottomUp ? height - 1 - y : y);
+		for (int32_t x = 0; x < width; ++x)
+		{
+			const uint8_t * bgr;
+			if (bitCount <= 8)
+			{
+				const uint32_t bit   = (uint32_t)x * bitCount;
+				const uint32_t index = (row[bit / 8] >> (8 - bitCount - bit % 8)) & ((1u << bitCount) - 1);
+				if (index >= colours)
+					return false;
+				bgr = palette + index * 4;
+			}
+			else
+			{
+				bgr = row + (size_t)x * (bitCount / 8);
+			}
+
+			if (bgr[0] + bgr[1] + bgr[2] < 384)
+				aMask.SetOpaque(x, y);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,100 @@
+//-----------------------------------------------------------------------------
+// File: Broadphase.cpp
+//
+// Desc: Layered broadphase built on the RectangleSoA batch kernels.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Broadphase Specific Includes
+//-----------------------------------------------------------------------------
+#include "Broadphase.h"
+#include "SimdUtil.h"
+#include "JobSystem.h"
+
+//-----------------------------------------------------------------------------
+// Name : Broadphase () (Constructor)
+// Desc : Broadphase Class Constructor
+//-----------------------------------------------------------------------------
+Broadphase::Broadphase()
+{
+	ClearLayers();
+}
+
+void Broadphase::ClearLayers()
+{
+	for (int i = 0; i < LAYER_COUNT; ++i)
+		mLayers[i] = nullptr;
+}
+
+void Broadphase::SetLayer(CollisionLayer aLayer, const RectangleSoA * aRectangles)
+{
+	mLayers[aLayer] = aRectangles;
+}
+
+//-----------------------------------------------------------------------------
+// Name : FindPairs ()
+// Desc : Walks the upper triangle of the collision matrix and runs the
+//		one-vs-many kernel for every row of every enabled, non-empty layer
+//		pair. Rows are independent, so they are handed out in chunks.
+//-----------------------------------------------------------------------------
+void Broadphase::FindPairs(std::vector<CollisionPair> & aPairs, JobSystem * aJobs)
+{
+	static const size_t kGrain = 64;	// Rows per chunk
+
+	aPairs.clear();
+
+	for (int a = 0; a < LAYER_COUNT; ++a)
+	{
+		const RectangleSoA * first = mLayers[a];
+		if (!first || first->IsEmpty())
+			continue;
+
+		for (int b = a; b < LAYER_COUNT; ++b)
+		{
+			const RectangleSoA * second = mLayers[b];
+			if (!second || second->IsEmpty())
+				continue;
+
+			if (!mMatrix.CanCollide((CollisionLayer)a, (CollisionLayer)b))
+				continue;
+
+			const size_t words  = second->MaskWords();
+			const size_t chunks = JobSystem::ChunkCount(first->Size(), kGrain);
+			mHitMasks.resize(first->Size() * words);
+			if (mChunkPairs.size() < chunks)
+				mChunkPairs.resize(chunks);
+
+			ParallelFor(aJobs, first->Size(), kGrain, [&](size_t aBegin, size_t aEnd, size_t aChunk)
+			{
+				std::vector<CollisionPair> & pairs = mChunkPairs[aChunk];
+				pairs.clear();
+
+				for (size_t i = aBegin; i < aEnd; ++i)
+				{
+					uint32_t * row = mHitMasks.data() + i * words;
+					if (!RectangleBatch::IntersectOne(*second, first->Left()[i], first->Top()[i],
+					                                  first->Right()[i], first->Bottom()[i], row))
+						continue;
+
+					SimdUtil::ForEachSetBit(row, words, [&](size_t aIndex)
+					{
+						// Within one layer report each unordered pair once.
+						if (a == b && aIndex <= i)
+							return;
+
+						CollisionPair pair;
+						pair.mFirstLayer  = (CollisionLayer)a;
+						pair.mSecondLayer = (CollisionLayer)b;
+						pair.mFirst       = (uint32_t)i;
+						pair.mSecond      = (uint32_t)aIndex;
+						pairs.push_back(pair);
+					});
+				}
+			});
+
+			// Chunks hold consecutive rows, so this is plain row order.
+			for (size_t c = 0; c < chunks; ++c)
+				aPairs.insert(aPairs.end(), mChunkPairs[c].begin(), mChunkPairs[c].end());
+		}
+	}
+}
@@ -12,9 +12,56 @@
 //-----------------------------------------------------------------------------
 #include "CGameApp.h"
 #include <algorithm>
+#include <sstream>
+#include "PlatformHeadless.h"
+#include "PlatformWin32.h"
 
 extern HINSTANCE g_hInst;
 
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// The simulation always advances in ticks of kTickTime; rendering
+// interpolates between the last two. After a long stall (debugger, window
+// drag) at most kMaxTicksPerFrame are run and the rest of the backlog is
+// dropped, so a slow frame can never snowball into slower ones.
+static const float kTickTime        = GameWorld::kTickTime;
+static const int   kMaxTicksPerFrame = 5;
+
+// The world the simulation runs in, the same on every machine whatever its
+// DPI or window metrics; the window's client area is made this size, but
+// only drawing looks at the window.
+static const LONG kPlayWidth  = GameWorld::kPlayWidth;
+static const LONG kPlayHeight = GameWorld::kPlayHeight;
+
+static const size_t kFrameArenaSize = 256 * 1024;	// Transient memory per frame
+static const ULONG  kWarmupFrames   = 120;			// Frames before -noalloc starts checking
+
+static const uint64_t kNetSeed         = 0x5EED5EED;	// Networked games without -seed
+static const unsigned kNetInputDelay   = 2;				// Ticks, unless -delay says otherwise
+
+// Keys whose button is on for as long as they are held...
+struct KeyButton { USHORT Key; USHORT Button; };
+static const KeyButton kHeldKeys[] =
+{
+	{ VK_UP,    INPUT_UP    }, { 'W', INPUT_UP    },
+	{ VK_DOWN,  INPUT_DOWN  }, { 'S', INPUT_DOWN  },
+	{ VK_LEFT,  INPUT_LEFT  }, { 'A', INPUT_LEFT  },
+	{ VK_RIGHT, INPUT_RIGHT }, { 'D', INPUT_RIGHT },
+	{ 'Q',      INPUT_BEAM  },
+};
+
+// ...and keys whose button fires once per press (auto repeat included).
+static const KeyButton kPressKeys[] =
+{
+	{ VK_RETURN, INPUT_SELF_DESTRUCT },
+	{ VK_SPACE,  INPUT_FIRE          },
+	{ 'E',       INPUT_ROTATE_LEFT   },
+	{ 'R',       INPUT_ROTATE_RIGHT  },
+	{ 'B',       INPUT_BOMB          },
+	{ VK_F5,     INPUT_RESTART       },
+};
+
 //-----------------------------------------------------------------------------
 // CGameApp Member Functions
 //-----------------------------------------------------------------------------
@@ -23,14 +70,38 @@ extern HINSTANCE g_hInst;
 // Desc : CGameApp Class Constructor
 //-----------------------------------------------------------------------------
 CGameApp::CGameApp()
+	: mFrameArena(kFrameArenaSize)
 {
 	// Reset / Clear all required values
 	m_hWnd			= NULL;
 	m_hIcon			= NULL;
 	m_hMenu			= NULL;
 	m_pBBuffer		= NULL;
-	m_pPlayer		= NULL;
 	m_LastFrameRate = 0;
+	m_bActive		= true;
+	m_bForeground	= true;
+	m_TickAccumulator = 0.0;
+	mLockFPS		= 0.0f;
+	mSeed			= 0;
+	memset( mKeyHeld, 0, sizeof(mKeyHeld) );
+	mNextInputId	= 0;
+	mUnpresentedInput.reserve( InputQueue::kCapacity );
+	mShownInputId	= 0;
+	mLocalTick		= 0;
+	mReplay			= false;
+	mReplayCheck	= false;
+	mFrameCount		= 0;
+	mFrameAllocations.mAllocations = 0;
+	mFrameAllocations.mBytes	   = 0;
+	mNoAllocations	= false;
+	mThreadCount	= 0;
+	mRestartPending	= false;
+	mRestartSent	= false;
+	mHostPort		= 0;
+	mInputDelay		= kNetInputDelay;
+	mNetLatency		= 0.0;
+	mNetLoss		= 0.0;
+	mSeedGiven		= false;
 }
 
 //-----------------------------------------------------------------------------
@@ -49,6 +120,30 @@ CGameApp::~CGameApp()
 //-----------------------------------------------------------------------------
 bool CGameApp::InitInstance( LPCTSTR lpCmdLine, int iCmdShow )
 {
+	ParseCommandLine( lpCmdLine );
+
+	// A replay shows nothing and plays no sound; its files (the log, the
+	// trace) are still real ones
+	if ( mReplay ) mPlatform = std::make_unique<HeadlessPlatform>( kPlayWidth, kPlayHeight, false );
+
+	// A replay takes its seed from the log, a new game from the clock
+	if ( mReplay && !mReplayCheck )
+	{
+		if ( !mInputLog.LoadFromFile( *mPlatform, mReplayFile.c_str() ) )
+		{
+			MessageBox( 0, ("Cannot read replay " + mReplayFile).c_str(), _T("Replay"), MB_OK | MB_ICONSTOP );
+			return false;
+		}
+		mSeed = mInputLog.GetSeed();
+	}
+	else
+	{
+		// Networked peers must start from the same seed
+		const bool bNetworked = mHostPort || !mJoinAddress.empty();
+		if ( !mSeedGiven ) mSeed = bNetworked ? kNetSeed : (uint64_t)PlatformClock::Ticks();
+		mInputLog.Clear( mSeed );
+	}
+
 	// Create the primary display device
 	if (!CreateDisplay()) { ShutDown(); return false; }
 
@@ -60,8 +155,7 @@ bool CGameApp::InitInstance( LPCTSTR lpCmdLine, int iCmdShow )
 		return false; 
 	}
 
-	// Set up all required game states
-	SetupGameState();
+	if ( !OpenNetwork() ) { ShutDown(); return false; }
 
 	// Success!
 	return true;
@@ -75,8 +169,7 @@ bool CGameApp::CreateDisplay()
 {
 	LPTSTR			WindowTitle		= _T("GameFramework");
 	LPCSTR			WindowClass		= _T("GameFramework_Class");
-	USHORT			Width			= 800;
-	USHORT			Height			= 600;
+	RECT			WindowRect		= { 0, 0, kPlayWidth, kPlayHeight };
 	RECT			rc;
 	WNDCLASSEX		wcex;
 
@@ -104,14 +197,18 @@ bool CGameApp::CreateDisplay()
 	m_nViewWidth	= rc.right - rc.left;
 	m_nViewHeight	= rc.bottom - rc.top;
 
+	// Size the frame so the client area is the play area
+	::AdjustWindowRect( &WindowRect, WS_OVERLAPPED, FALSE );
+
 	m_hWnd = CreateWindow(WindowClass, WindowTitle, WS_OVERLAPPED,
-		CW_USEDEFAULT, CW_USEDEFAULT, Width, Height, NULL, NULL, g_hInst, this);
+		CW_USEDEFAULT, CW_USEDEFAULT, WindowRect.right - WindowRect.left, WindowRect.bottom - WindowRect.top,
+		NULL, NULL, g_hInst, this);
 
 	if (!m_hWnd)
 		return false;
 
-	// Show the window
-	ShowWindow(m_hWnd, SW_SHOW);
+	// Show the window (a replay runs headless)
+	if ( !mReplay ) ShowWindow(m_hWnd, SW_SHOW);
 
 	// Success!!
 	return true;
@@ -126,28 +223,257 @@ int CGameApp::BeginGame()
 {
 	MSG		msg;
 
+	Profiler::SetThreadName( "Main" );
+
+	if ( mReplay )
+	{
+		const int Result = mReplayCheck ? RunReplayCheck() : RunReplay();
+		WriteTrace();
+		return Result;
+	}
+
 	// Start main loop
-	while(true) 
+	bool bQuit = false;
+	while ( !bQuit ) 
 	{
-		// Did we recieve a message, or are we idling ?
-		if ( PeekMessage(&msg, NULL, 0, 0, PM_REMOVE) ) 
+		// Handle every message waiting before the next frame
+		while ( PeekMessage(&msg, NULL, 0, 0, PM_REMOVE) ) 
 		{
-			if (msg.message == WM_QUIT) break;
+			if (msg.message == WM_QUIT) { bQuit = true; break; }
 			TranslateMessage( &msg );
 			DispatchMessage ( &msg );
-		} 
-		else 
+
+		} // Next message
+
+		if ( bQuit ) break;
+
+		// Minimized or in the background the game is paused; sleep until
+		// a message arrives instead of spinning. A networked game cannot
+		// pause, the other peer keeps playing.
+		if ( ( !m_bActive || !m_bForeground ) && !mSession )
 		{
-			// Advance Game Frame.
-      FrameAdvance();
+			WaitMessage();
 
-		} // End If messages waiting
+			// Don't count the paused time as time to simulate
+			m_Timer.Reset();
+			continue;
+
+		} // End if paused
+
+		// Advance Game Frame.
+		FrameAdvance();
 	
 	} // Until quit message is receieved
 
+	// Let the other peer know instead of leaving it to time out
+	if ( mSession ) mSession->Disconnect();
+
+	// Log the session's input to present latency
+	TCHAR LatencyReport[ 255 ];
+	sprintf_s( LatencyReport, _T("Input latency: %u events, p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms (%u dropped)\n"),
+		mInputLatency.Count(), mInputLatency.Percentile( 50 ), mInputLatency.Percentile( 95 ),
+		mInputLatency.Percentile( 99 ), mInputLatency.Maximum(), mInputQueue.Dropped() );
+	OutputDebugString( LatencyReport );
+
+	WriteTrace();
+
+	// A networked game has no single input log to replay. The log keeps
+	// how the session ended, for the replay to check against.
+	const bool bNetworked = mHostPort || !mJoinAddress.empty();
+	if ( !mRecordFile.empty() && !bNetworked )
+	{
+		mInputLog.SetOutcome( (uint32_t)GetPlayer( 0 )->GetScore(), mWorld->Hash() );
+		if ( !mInputLog.SaveToFile( *mPlatform, mRecordFile.c_str() ) )
+			MessageBox( 0, ("Cannot write " + mRecordFile).c_str(), _T("Record"), MB_OK | MB_ICONEXCLAMATION );
+	}
+
 	return 0;
 }
 
+//-----------------------------------------------------------------------------
+// Name : ParseCommandLine () (Private)
+// Desc : Picks up -record <file>, -replay <file>, -replaycheck, -trace
+//		<file>, -noalloc, -threads <n>, -seed <n>, -fps <n> and the network
+//		options -host <port>, -join <host:port>, -delay <ticks> and -netsim
+//		<ms> <loss %>.
+//-----------------------------------------------------------------------------
+void CGameApp::ParseCommandLine( LPCTSTR lpCmdLine )
+{
+	std::istringstream arguments( lpCmdLine ? lpCmdLine : "" );
+	std::string argument;
+
+	while ( arguments >> argument )
+	{
+		if ( argument == "-record" ) arguments >> mRecordFile;
+		else if ( argument == "-replay" ) arguments >> mReplayFile;
+		else if ( argument == "-replaycheck" ) mReplayCheck = true;
+		else if ( argument == "-trace" ) arguments >> mTraceFile;
+		else if ( argument == "-noalloc" ) mNoAllocations = true;
+		else if ( argument == "-threads" ) arguments >> mThreadCount;
+		else if ( argument == "-seed" ) { arguments >> mSeed; mSeedGiven = true; }
+		else if ( argument == "-fps" ) arguments >> mLockFPS;
+		else if ( argument == "-host" ) arguments >> mHostPort;
+		else if ( argument == "-join" ) arguments >> mJoinAddress;
+		else if ( argument == "-delay" ) arguments >> mInputDelay;
+		else if ( argument == "-netsim" ) arguments >> mNetLatency >> mNetLoss;
+	}
+
+	mReplay = !mReplayFile.empty() || mReplayCheck;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RunReplay () (Private)
+// Desc : Feeds the recorded input through the simulation as fast as the CPU
+//		allows, with nothing drawn, and reports the throughput. A log that
+//		knows how its session ended is checked against it; a mismatch
+//		exits with 1.
+//-----------------------------------------------------------------------------
+int CGameApp::RunReplay()
+{
+	const int64_t start = PlatformClock::Ticks();
+	const ULONG ticks = ReplayLog();
+	const double seconds = PlatformClock::Seconds( start, PlatformClock::Ticks() );
+
+	const UINT score = (UINT)GetPlayer( 0 )->GetScore();
+	const bool bChecked = mInputLog.HasOutcome();
+	const bool bMatch = !bChecked || ( score == mInputLog.OutcomeScore() && mWorld->Hash() == mInputLog.OutcomeHash() );
+
+	TCHAR report[ 255 ];
+	sprintf_s( report, _T("Ticks: %u (%.1f s of play)\nTime: %.3f s\nThroughput: %.0f ticks/s\nScore: %u\nRecording: %s"),
+		ticks, ticks * kTickTime, seconds, seconds > 0.0 ? ticks / seconds : 0.0, score,
+		!bChecked ? _T("no outcome saved") : bMatch ? _T("matches") : _T("MISMATCH") );
+	MessageBox( 0, report, _T("Replay"), bMatch ? MB_OK : MB_OK | MB_ICONEXCLAMATION );
+
+	return bMatch ? 0 : 1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReplayLog () (Private)
+// Desc : Runs every tick of the log from the starting world and returns how
+//		many there were. Only ticks that ran live were recorded, so the
+//		whole log is played, restarts included.
+//-----------------------------------------------------------------------------
+ULONG CGameApp::ReplayLog()
+{
+	PROFILE_SCOPE("Replay");
+
+	mWorld->Restart();
+
+	USHORT buttons;
+	ULONG ticks = 0;
+	mInputLog.Rewind();
+	while ( mInputLog.Read( buttons ) )
+	{
+		mWorld->SimulateTick( buttons );
+		mFrameArena.Reset();
+		++ticks;
+	}
+
+	return ticks;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RunReplayCheck () (Private)
+// Desc : -replaycheck: plays a scripted session through the same tick path
+//		as the live game (fly and fire, self-destruct until game over, sit
+//		on the game over for a while, play again, play on), then replays
+//		its log from the start and compares score and world. Exits with 1
+//		if they differ.
+//-----------------------------------------------------------------------------
+int CGameApp::RunReplayCheck()
+{
+	static const ULONG kCheckTicks	  = 3600;
+	static const ULONG kDestructEvery = 150;	// Ticks between self-destructs
+	static const ULONG kGameOverTicks = 90;		// Left on the game over screen
+
+	mWorld->Restart();
+
+	bool	bRestarted	= false;
+	ULONG	OverTicks	= 0;
+	for ( ULONG Tick = 0; Tick < kCheckTicks; ++Tick )
+	{
+		USHORT Buttons = INPUT_FIRE | ( ( Tick / 60 ) & 1 ? INPUT_LEFT : INPUT_RIGHT );
+		if ( ( Tick / 90 ) & 1 ) Buttons |= INPUT_UP;
+		if ( !bRestarted && Tick % kDestructEvery == kDestructEvery - 1 ) Buttons |= INPUT_SELF_DESTRUCT;
+
+		if ( mWorld->IsGameOver() && ++OverTicks == kGameOverTicks )
+		{
+			Buttons |= INPUT_RESTART;
+			bRestarted = true;
+		}
+
+		RunLocalTick( Buttons );
+		mFrameArena.Reset();
+	}
+
+	const UINT	   LiveScore  = (UINT)GetPlayer( 0 )->GetScore();
+	const uint64_t LiveHash	  = mWorld->Hash();
+	const ULONG	   LoggedTicks = mInputLog.TickCount();
+
+	const ULONG	   ReplayedTicks = ReplayLog();
+	const UINT	   ReplayScore	 = (UINT)GetPlayer( 0 )->GetScore();
+	const bool	   bMatch = bRestarted && ReplayedTicks == LoggedTicks &&
+		ReplayScore == LiveScore && mWorld->Hash() == LiveHash;
+
+	TCHAR report[ 255 ];
+	sprintf_s( report, _T("Scripted: %u ticks, %u logged (%u on the game over screen)\nRestarted: %s\nScore: live %u, replay %u\nResult: %s"),
+		kCheckTicks, LoggedTicks, kCheckTicks - LoggedTicks, bRestarted ? _T("yes") : _T("no"),
+		LiveScore, ReplayScore, bMatch ? _T("match") : _T("MISMATCH") );
+	MessageBox( 0, report, _T("Replay check"), bMatch ? MB_OK : MB_OK | MB_ICONEXCLAMATION );
+
+	return bMatch ? 0 : 1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : OpenNetwork () (Private)
+// Desc : For -host or -join, opens the socket and starts the rollback
+//		session; the host plays the first plane, the joining peer the
+//		second. Nothing to do for a single player game or a replay.
+//-----------------------------------------------------------------------------
+bool CGameApp::OpenNetwork()
+{
+	if ( mReplay || mWorld->PlayerCount() < 2 ) return true;
+
+	std::string Error;
+	mUdp = std::make_unique<UdpTransport>();
+	const bool bOpened = mHostPort ? mUdp->Host( mHostPort, Error ) : mUdp->Join( mJoinAddress, Error );
+	if ( !bOpened )
+	{
+		MessageBox( 0, Error.c_str(), _T("Network"), MB_OK | MB_ICONSTOP );
+		return false;
+	}
+
+	INetTransport * pTransport = mUdp.get();
+	if ( mNetLatency > 0.0 || mNetLoss > 0.0 )
+	{
+		mNetShim = std::make_unique<LossyTransport>( *mUdp, mNetLatency / 1000.0, 0.0, (float)( mNetLoss / 100.0 ), mSeed );
+		pTransport = mNetShim.get();
+	}
+
+	IRollbackWorld & World = *this;
+	mSession = std::make_unique<RollbackSession>( World, *pTransport, mHostPort ? 0 : 1, mInputDelay );
+
+	// Held buttons are predicted to stay held, presses not to repeat
+	USHORT HeldButtons = 0;
+	for ( const KeyButton & Held : kHeldKeys ) HeldButtons |= Held.Button;
+	mSession->SetHeldButtons( HeldButtons );
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WriteTrace () (Private)
+// Desc : Saves the profiler's events for -trace. Builds without the
+//		profiler compiled in write an empty trace.
+//-----------------------------------------------------------------------------
+void CGameApp::WriteTrace()
+{
+	if ( mTraceFile.empty() ) return;
+
+	if ( !Profiler::WriteChromeTrace( *mPlatform, mTraceFile.c_str() ) )
+		MessageBox( 0, ("Cannot write " + mTraceFile).c_str(), _T("Trace"), MB_OK | MB_ICONEXCLAMATION );
+}
+
 //-----------------------------------------------------------------------------
 // Name : ShutDown ()
 // Desc : Shuts down the game engine, and frees up all resources.
@@ -201,8 +527,6 @@ LRESULT CALLBACK CGameApp::StaticWndProc(HWND hWnd, UINT Message, WPARAM wParam,
 //-----------------------------------------------------------------------------
 LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM lParam )
 {
-	static UINT			fTimer;	
-
 	// Determine message type
 	switch (Message)
 	{
@@ -238,6 +562,11 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 
 			break;
 
+		case WM_ACTIVATEAPP:
+			// Pause while another application has the focus
+			m_bForeground = ( wParam != FALSE );
+			break;
+
 		case WM_LBUTTONDOWN:
 			// Capture the mouse
 			SetCapture( m_hWnd );
@@ -250,41 +579,24 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 			break;
 
 		case WM_KEYDOWN:
-			switch(wParam)
+			if ( wParam == VK_ESCAPE )
 			{
-			case VK_ESCAPE:
 				PostQuitMessage(0);
 				break;
-   
-			case VK_RETURN:
-				fTimer = SetTimer(m_hWnd, 1, 75, NULL);
-                m_pPlayer->DecreaseLives();
-				m_pPlayer->Explode();
-				break;
-      case VK_SPACE:
-        m_pPlayer->Shoot();
-        break;
-      case 'E':
-        m_pPlayer->RotateLeft();
-        break;
-	  case 'R':
-        m_pPlayer->RotateRight();
-        break;
-
 			}
-			break;
 
-		case WM_TIMER:
-			switch(wParam)
-			{
+			// Key changes are handed to the tick they happened in
+			QueueKey( (USHORT)wParam, true );
+			break;
 
-			case 1:
-				if (!m_pPlayer->AdvanceExplosion())
-					KillTimer(m_hWnd, 1);
-				if (!m_pPlayer->IsExploding())
-					KillTimer(m_hWnd, 1);
+		case WM_KEYUP:
+			QueueKey( (USHORT)wParam, false );
+			break;
 
-			}
+		case WM_KILLFOCUS:
+			// Key ups go to the new focus window, so release everything held
+			for ( const KeyButton & Held : kHeldKeys )
+				QueueKey( Held.Key, false );
 			break;
 
 		case WM_COMMAND:
@@ -298,33 +610,64 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 	return 0;
 }
 
+//-----------------------------------------------------------------------------
+// Name : QueueKey () (Private)
+// Desc : Timestamps a key change and queues it for the simulation.
+//-----------------------------------------------------------------------------
+void CGameApp::QueueKey( USHORT Key, bool bDown )
+{
+	InputEvent Event;
+	Event.mId   = mNextInputId++;
+	Event.mTime = PlatformClock::Ticks();
+	Event.mKey  = Key;
+	Event.mDown = bDown;
+	mInputQueue.Push( Event );
+}
+
 //-----------------------------------------------------------------------------
 // Name : BuildObjects ()
 // Desc : Build our demonstration meshes, and the objects that instance them
 //-----------------------------------------------------------------------------
 bool CGameApp::BuildObjects()
 {
+	PROFILE_SCOPE("LoadAssets");
+
 	m_pBBuffer      = new BackBuffer(m_hWnd, m_nViewWidth, m_nViewHeight);
-	m_pPlayer       = new CPlayer(m_pBBuffer, mFiredBullets);
-	
-    mEnemyGroup     = std::make_unique<EnemyGroup>(m_pBBuffer);
+
+	// Replays have had theirs since InitInstance
+	if ( !mPlatform )
+		mPlatform = std::make_unique<Win32Platform>(m_pBBuffer);
+
+	// Results do not depend on the thread count, so a replay may use any.
+	mJobs           = std::make_unique<JobSystem>(mThreadCount ? mThreadCount - 1 : JobSystem::kAutoWorkers);
+
+	mSpriteBank     = std::make_unique<SpriteBank>(*mPlatform);
+
+	std::string spriteError;
+	if(!mSpriteBank->Load(spriteError))
+	{
+		::MessageBox(m_hWnd, spriteError.c_str(), "Sprites", MB_OK | MB_ICONSTOP);
+		return false;
+	}
+
+	// The remote player's plane too, in a networked game
+	const int PlayerCount = ( !mReplay && ( mHostPort || !mJoinAddress.empty() ) ) ? 2 : 1;
+	mWorld          = std::make_unique<GameWorld>(*mPlatform, *mSpriteBank, mFrameArena, mJobs.get(), PlayerCount, mSeed);
 
 	if(!m_imgBackground.LoadBitmapFromFile("data/background.bmp", GetDC(m_hWnd)))
 		return false;
 
+	std::string waveError;
+	if(!mWorld->LoadWaves("Data/waves.txt", waveError))
+	{
+		::MessageBox(m_hWnd, waveError.c_str(), "Wave script", MB_OK | MB_ICONSTOP);
+		return false;
+	}
+
 	// Success!
 	return true;
 }
 
-//-----------------------------------------------------------------------------
-// Name : SetupGameState ()
-// Desc : Sets up all the initial states required by the game.
-//-----------------------------------------------------------------------------
-void CGameApp::SetupGameState()
-{
-  m_pPlayer->Position() = Vec2(400, 400);
-}
-
 //-----------------------------------------------------------------------------
 // Name : ReleaseObjects ()
 // Desc : Releases our objects and their associated memory so that we can
@@ -332,11 +675,17 @@ void CGameApp::SetupGameState()
 //-----------------------------------------------------------------------------
 void CGameApp::ReleaseObjects( )
 {
-	if(m_pPlayer != NULL)
-	{
-		delete m_pPlayer;
-		m_pPlayer = NULL;
-	}
+	// The session holds on to this world and the transports
+	mSession.reset();
+	mNetShim.reset();
+	mUdp.reset();
+
+	// The world draws through the sprite bank, which draws through the
+	// platform
+	mWorld.reset();
+	mSpriteBank.reset();
+	mPlatform.reset();
+	mJobs.reset();
 
 	if(m_pBBuffer != NULL)
 	{
@@ -351,103 +700,178 @@ void CGameApp::ReleaseObjects( )
 //-----------------------------------------------------------------------------
 void CGameApp::FrameAdvance()
 {
+	PROFILE_SCOPE("Frame");
+
 	static TCHAR FrameRate[ 50 ];
-	static TCHAR TitleBuffer[ 255 ];
+	static TCHAR TitleBuffer[ 384 ];
 
-	// Advance the timer
-	m_Timer.Tick( );
+	AllocationCounter::BeginFrame();
+
+	// Advance the timer, sleeping off the rest of the frame if capped
+	m_Timer.Tick( mLockFPS );
 
-	// Skip if app is inactive
-	if ( !m_bActive ) return;
-	
 	// Get / Display the framerate
 	if ( m_LastFrameRate != m_Timer.GetFrameRate() )
 	{
 
 		m_LastFrameRate = m_Timer.GetFrameRate(FrameRate, 50);
-		sprintf_s(TitleBuffer, _T("Game : %s  Lives: %d Score : %d"), FrameRate,
-			m_pPlayer->GetLives(), m_pPlayer->GetScore());
+		const ProjectilePool & firedBullets = mWorld->GetPlayerBullets( 0 );
+		const ProjectilePool & enemyBullets = mWorld->GetEnemyGroup().GetBulletPool();
+		sprintf_s(TitleBuffer, _T("Game : %s  Lives: %d Score : %d  Shots: %u/%u (peak %u/%u, dropped %u)  Frame: %.1f/%.1f/%.1f ms  Input: %.1f/%.1f/%.1f ms  Allocs: %u"),
+			FrameRate, GetLocalPlayer()->GetLives(), GetLocalPlayer()->GetScore(),
+			(UINT)firedBullets.Size(), (UINT)enemyBullets.Size(),
+			(UINT)firedBullets.HighWater(), (UINT)enemyBullets.HighWater(),
+			(UINT)(firedBullets.Dropped() + enemyBullets.Dropped()),
+			m_Timer.GetTimeElapsed() * 1000.0f, m_Timer.GetFrameTimePercentile( 99 ) * 1000.0f, m_Timer.GetFrameTimeMax() * 1000.0f,
+			mInputLatency.Percentile( 50 ), mInputLatency.Percentile( 95 ), mInputLatency.Percentile( 99 ),
+			(UINT)mFrameAllocations.mAllocations);
+
+		// How far ahead of the other peer, and what rollbacks cost
+		if ( mSession )
+		{
+			const RollbackStats & Net = mSession->Stats();
+			const CPlayer * pRemote = GetPlayer( 1 - (int)mSession->LocalPlayer() );
+			const size_t Length = strlen( TitleBuffer );
+			sprintf_s( TitleBuffer + Length, sizeof(TitleBuffer) - Length, _T("  Peer: %s lives %d score %d, ahead %u, rollbacks %u (max %u ticks, %.2f ms)%s"),
+				mSession->HasRemote() ? _T("") : _T("waiting,"), pRemote->GetLives(), pRemote->GetScore(),
+				mSession->PredictedTicks(), Net.mRollbacks, Net.mMaxDepth, Net.mMaxRollbackSeconds * 1000.0,
+				mSession->IsDesynced() ? _T("  DESYNC") : _T("") );
+		}
 		
 		SetWindowText( m_hWnd, TitleBuffer );
 
 	} // End if Frame Rate Altered
 
-  if (!m_pPlayer->GetLives())
+  if (!mWorld->IsGameOver())
+	  mRestartPending = mRestartSent = false;
+
+  // A networked game cannot stop for a prompt; DrawNetworkNotice asks
+  // instead and F5 restarts through the inputs
+  if (mWorld->IsGameOver() && !mRestartPending && !mSession)
   {
-	  ::MessageBox(m_hWnd, ("Your score : " + to_string(m_pPlayer->GetScore())).c_str(), "Game over", MB_OK);
-	  ::PostQuitMessage(0);
+	  TCHAR ScoreBuffer[ 64 ];
+	  sprintf_s(ScoreBuffer, _T("Your score : %u\nPlay again?"), (UINT)GetLocalPlayer()->GetScore());
+	  if (::MessageBox(m_hWnd, ScoreBuffer, "Game over", MB_YESNO) == IDYES)
+		  mRestartPending = true;
+	  else
+		  ::PostQuitMessage(0);
 
   }
   
 
-	// Poll & Process input devices
-	ProcessInput();
+	// Run as many fixed ticks as real time allows
+	m_TickAccumulator += m_Timer.GetRawTimeElapsed();
+
+	// Tick k of this frame stands for the real time ending at TickEnd; it
+	// gets the input events that arrived up to then.
+	const int64_t FrameTime = PlatformClock::Ticks();
+	const double  ClockFrequency = (double)PlatformClock::Frequency();
+
+	// Take in the other peer's inputs, rolling back where they were
+	// predicted wrong, before this frame's ticks
+	if ( mSession ) mSession->Poll();
+
+	int ticks = 0;
+	while ( m_TickAccumulator >= kTickTime && ticks < kMaxTicksPerFrame )
+	{
+		// Too far ahead of the other peer: wait for it, dropping the time
+		if ( mSession && !mSession->CanAdvance() ) break;
+
+		const int64_t TickEnd = FrameTime - (int64_t)((m_TickAccumulator - kTickTime) * ClockFrequency);
 
-	// Animate the game objects
-	AnimateObjects();
+		// Collect this tick's input, for the tick that will apply it
+		USHORT buttons = PollInput( TickEnd, mSession ? mSession->InputTick() : mLocalTick );
+		if ( mRestartPending && !mRestartSent ) buttons |= INPUT_RESTART;
+		mRestartSent = mRestartPending;
 
-	// Drawing the game objects
-	DrawObjects();
+		// The session runs networked ticks; a local game keeps the sample
+		// for replays
+		if ( mSession )
+		{
+			mSession->Advance( buttons );
+		}
+		else
+		{
+			RunLocalTick( buttons );
+		}
+
+		m_TickAccumulator -= kTickTime;
+		++ticks;
+
+	} // Next Tick
+
+	if ( m_TickAccumulator >= kTickTime )
+		m_TickAccumulator = fmod( m_TickAccumulator, (double)kTickTime );
+
+	// Drawing the game objects, part way into the next tick
+	DrawObjects( (float)(m_TickAccumulator / kTickTime) );
+
+	// Everything transient goes with the frame
+	mFrameArena.Reset();
+
+	// With -noalloc, a frame after the warm up must not touch the heap
+	if ( ++mFrameCount == kWarmupFrames ) AllocationCounter::ExpectNoAllocations( mNoAllocations );
+	mFrameAllocations = AllocationCounter::EndFrame();
 }
 
 //-----------------------------------------------------------------------------
-// Name : ProcessInput () (Private)
-// Desc : Simply polls the input devices and performs basic input operations
+// Name : RunLocalTick () (Private)
+// Desc : Records and simulates one tick of a local game. Once the game is
+//		over nothing is simulated or recorded until a tick asks to play
+//		again, so the log holds exactly the ticks that ran.
 //-----------------------------------------------------------------------------
-void CGameApp::ProcessInput( )
+void CGameApp::RunLocalTick( USHORT Buttons )
 {
-	static UINT			fTimer;
-	static UCHAR pKeyBuffer[ 256 ];
-	ULONG		Direction = 0;
-    ULONG   DirectionSecond = 0;
-	POINT		CursorPos;
-	float		X = 0.0f, Y = 0.0f;
+	const bool bRun = !mWorld->IsGameOver() || ( Buttons & INPUT_RESTART );
+	InputTickRan( mLocalTick++, bRun );
+	if ( !bRun ) return;
 
-	// Retrieve keyboard state
-	if ( !GetKeyboardState( pKeyBuffer ) ) return;
+	mInputLog.Record( Buttons );
+	mWorld->SimulateTick( Buttons );
+}
 
-	// Check the relevant keys
-	if ( pKeyBuffer[ VK_UP	] & 0xF0 ) Direction |= CPlayer::DIRECTION::DIR_FORWARD;
-	if ( pKeyBuffer[ VK_DOWN  ] & 0xF0 ) Direction |= CPlayer::DIRECTION::DIR_BACKWARD;
-	if ( pKeyBuffer[ VK_LEFT  ] & 0xF0 ) Direction |= CPlayer::DIRECTION::DIR_LEFT;
-	if ( pKeyBuffer[ VK_RIGHT ] & 0xF0 ) Direction |= CPlayer::DIRECTION::DIR_RIGHT;
+//-----------------------------------------------------------------------------
+// Name : PollInput () (Private)
+// Desc : Drains the key events that arrived up to TickEnd into one tick's
+//		worth of InputButton bits. A held button also counts if it was only
+//		down for part of the tick, so a quick tap is never missed. Tick is
+//		the one that will apply them, for the latency figures.
+//-----------------------------------------------------------------------------
+USHORT CGameApp::PollInput( int64_t TickEnd, uint32_t Tick )
+{
+	PROFILE_SCOPE("Input");
 
-	if (pKeyBuffer['W'] & 0xF0) Direction |= CPlayer::DIRECTION::DIR_FORWARD;
-	if (pKeyBuffer['S'] & 0xF0) Direction |= CPlayer::DIRECTION::DIR_BACKWARD;
-	if (pKeyBuffer['A'] & 0xF0) Direction |= CPlayer::DIRECTION::DIR_LEFT;
-	if (pKeyBuffer['D'] & 0xF0) Direction |= CPlayer::DIRECTION::DIR_RIGHT;
+	USHORT		Buttons = 0;
+	POINT		CursorPos;
+	InputEvent	Event;
 
-	// Move the player
-	m_pPlayer->Move(Direction);
-	
+	while ( mInputQueue.Peek( Event ) && Event.mTime <= TickEnd )
+	{
+		mInputQueue.Pop( Event );
+		if ( Event.mKey >= kPlatformKeyCount ) continue;
 
-  if (mEnemyGroup->IsEmpty())
-    mEnemyGroup->GenerateEnemies();
-  
-  mEnemyGroup->ShootRandom();
+		mKeyHeld[ Event.mKey ] = Event.mDown;
 
-  m_pPlayer->ShootEnemies(*mEnemyGroup);
-  
+		USHORT KeyButtons = 0;
+		for ( const KeyButton & Held : kHeldKeys )
+			if ( Held.Key == Event.mKey ) KeyButtons |= Held.Button;
+		for ( const KeyButton & Press : kPressKeys )
+			if ( Press.Key == Event.mKey ) KeyButtons |= Press.Button;
 
-  if (m_pPlayer->GetShot(*mEnemyGroup))
-  {
-	  fTimer = SetTimer(m_hWnd, 1, 75, NULL);
+		if ( !KeyButtons ) continue;
 
-	  m_pPlayer->Explode();
+		// Follow the event through to the frame that shows it
+		TickInput Pending;
+		Pending.mEvent = Event;
+		Pending.mTick  = Tick;
+		mUnpresentedInput.push_back( Pending );
+		if ( Event.mDown ) Buttons |= KeyButtons;
 
-	  m_pPlayer->Position() = Vec2(400, 400);
+	} // Next Event
 
-  }
-  else
-  {
-	  auto found = find_if(mFiredBullets.begin(), mFiredBullets.end(), [this](Bullet & aBullet) {
-		  return mEnemyGroup->HandleBullet(aBullet);
-	  });
-	  if (found != mFiredBullets.end())
-	  {
-		  mFiredBullets.erase(found);
-	  }
-  }
+	// Check the held keys
+	for ( const KeyButton & Held : kHeldKeys )
+		if ( mKeyHeld[ Held.Key ] ) Buttons |= Held.Button;
 
 	// Now process the mouse (if the button is pressed)
 	if ( GetCapture() == m_hWnd )
@@ -462,44 +886,171 @@ void CGameApp::ProcessInput( )
 		SetCursorPos( m_OldCursorPos.x, m_OldCursorPos.y );
 
 	} // End if Captured
+
+	return Buttons;
 }
 
-void CGameApp::DrawBackground()
+//-----------------------------------------------------------------------------
+// Name : SaveState () (Private, IRollbackWorld)
+//-----------------------------------------------------------------------------
+void CGameApp::SaveState( WorldSnapshot & Snapshot )
 {
-	static int currentY = m_imgBackground.Height();
+	mWorld->SaveState( Snapshot );
+}
 
-	m_imgBackground.Paint(m_pBBuffer->getDC(), 0, currentY);
+//-----------------------------------------------------------------------------
+// Name : LoadState () (Private, IRollbackWorld)
+//-----------------------------------------------------------------------------
+bool CGameApp::LoadState( const WorldSnapshot & Snapshot )
+{
+	return mWorld->LoadState( Snapshot );
 }
 
 //-----------------------------------------------------------------------------
-// Name : AnimateObjects () (Private)
-// Desc : Animates the objects we currently have loaded.
+// Name : SimulateTick () (Private, IRollbackWorld)
+// Desc : A networked tick, run by the world (which mutes re-simulated
+//		ones). The first run of a tick is the one that can reach the
+//		screen.
 //-----------------------------------------------------------------------------
-void CGameApp::AnimateObjects()
+void CGameApp::SimulateTick( const uint16_t Buttons[], bool bReplaying )
+{
+	if ( !bReplaying )
+		InputTickRan( mSession->Tick(), !mWorld->IsGameOver() || ( ( Buttons[ 0 ] | Buttons[ 1 ] ) & INPUT_RESTART ) );
+
+	IRollbackWorld & World = *mWorld;
+	World.SimulateTick( Buttons, bReplaying );
+}
+
+void CGameApp::DrawBeam( int Player )
+{
+	HDC hDC = m_pBBuffer->getDC();
+
+	HPEN beamPen = CreatePen(PS_SOLID, 3, Player ? RGB(64, 160, 255) : RGB(255, 64, 64));
+	HGDIOBJ oldPen = SelectObject(hDC, beamPen);
+
+	const Vec2 & BeamStart = mWorld->BeamStart(Player);
+	const Vec2 & BeamEnd   = mWorld->BeamEnd(Player);
+	MoveToEx(hDC, (int)BeamStart.x, (int)BeamStart.y, NULL);
+	LineTo(hDC, (int)BeamEnd.x, (int)BeamEnd.y);
+
+	SelectObject(hDC, oldPen);
+	DeleteObject(beamPen);
+}
+
+void CGameApp::DrawBackground()
 {
-  RECT rectangle;
-  ::GetClientRect(m_hWnd, &rectangle);
+	static int currentY = m_imgBackground.Height();
 
-	m_pPlayer->Update(m_Timer.GetTimeElapsed(), rectangle);
- 
-    mEnemyGroup->Update(m_Timer.GetTimeElapsed());
+	m_imgBackground.Paint(m_pBBuffer->getDC(), 0, currentY);
 }
 
 //-----------------------------------------------------------------------------
 // Name : DrawObjects () (Private)
 // Desc : Draws the game objects
 //-----------------------------------------------------------------------------
-void CGameApp::DrawObjects()
+void CGameApp::DrawObjects( float fAlpha )
 {
+	PROFILE_SCOPE("Draw");
+
 	m_pBBuffer->reset();
 
     DrawBackground();
 
-	m_pPlayer->Draw();
-  
-    mEnemyGroup->Draw();
+	mWorld->Draw(fAlpha);
+
+	for ( int Player = 0; Player < mWorld->PlayerCount(); ++Player )
+		if (mWorld->IsBeamActive( Player ))
+			DrawBeam( Player );
 
     m_pBBuffer->WriteScore(0);
 
-	m_pBBuffer->present();
+	if ( mSession ) DrawNetworkNotice();
+
+	{
+		PROFILE_SCOPE("Present");
+		mPlatform->Present();
+	}
+
+	RecordInputLatency();
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawNetworkNotice () (Private)
+// Desc : Tells the player, across the middle of the play area, that a
+//		networked game is over or that the match with the other peer ended.
+//-----------------------------------------------------------------------------
+void CGameApp::DrawNetworkNotice( )
+{
+	TCHAR Notice[ 128 ];
+	switch ( mSession->End() )
+	{
+		case SESSION_PEER_LEFT:
+			sprintf_s( Notice, _T("The other player left. Press Esc to quit.") );
+			break;
+
+		case SESSION_TIMED_OUT:
+			sprintf_s( Notice, _T("Lost the connection to the other player. Press Esc to quit.") );
+			break;
+
+		default:
+			if ( !mWorld->IsGameOver() ) return;
+			sprintf_s( Notice, _T("Game over, score %u. Press F5 to play again or Esc to quit."),
+				(UINT)GetLocalPlayer()->GetScore() );
+			break;
+
+	} // End Notice Switch
+
+	HDC hDC = m_pBBuffer->getDC();
+	RECT Line = { 0, kPlayHeight / 2 - 10, kPlayWidth, kPlayHeight / 2 + 10 };
+	const int OldMode = SetBkMode( hDC, TRANSPARENT );
+	const COLORREF OldColor = SetTextColor( hDC, RGB( 255, 255, 255 ) );
+	DrawText( hDC, Notice, -1, &Line, DT_CENTER | DT_VCENTER | DT_SINGLELINE );
+	SetTextColor( hDC, OldColor );
+	SetBkMode( hDC, OldMode );
+}
+
+//-----------------------------------------------------------------------------
+// Name : InputTickRan () (Private)
+// Desc : Tick has been simulated for the first time. Its input events are
+//		shown by the next present if it moved the world (bRan), and never
+//		if it sat frozen on the game over screen.
+//-----------------------------------------------------------------------------
+void CGameApp::InputTickRan( uint32_t Tick, bool bRan )
+{
+	// Ticks run in order and events are queued in order, so the events up
+	// to Tick follow the ones already shown
+	size_t First = 0;
+	while ( First < mUnpresentedInput.size() &&
+			(int32_t)( mUnpresentedInput[ First ].mEvent.mId - mShownInputId ) < 0 ) ++First;
+
+	size_t Last = First;
+	while ( Last < mUnpresentedInput.size() && (int32_t)( mUnpresentedInput[ Last ].mTick - Tick ) <= 0 ) ++Last;
+
+	if ( Last == First ) return;
+
+	if ( bRan )
+		mShownInputId = mUnpresentedInput[ Last - 1 ].mEvent.mId + 1;
+	else
+		mUnpresentedInput.erase( mUnpresentedInput.begin() + First, mUnpresentedInput.begin() + Last );
+}
+
+//-----------------------------------------------------------------------------
+// Name : RecordInputLatency () (Private)
+// Desc : Closes out the input events whose tick ran since the last present;
+//		the frame just presented is the first one that reflects them.
+//		Events still waiting for their tick stay open.
+//-----------------------------------------------------------------------------
+void CGameApp::RecordInputLatency( )
+{
+	const int64_t PresentTime = PlatformClock::Ticks();
+
+	size_t Shown = 0;
+	while ( Shown < mUnpresentedInput.size() &&
+			(int32_t)( mUnpresentedInput[ Shown ].mEvent.mId - mShownInputId ) < 0 )
+	{
+		mInputLatency.Record( PlatformClock::Seconds( mUnpresentedInput[ Shown ].mEvent.mTime, PresentTime ) * 1000.0 );
+		++Shown;
+	}
+
+	mUnpresentedInput.erase( mUnpresentedInput.begin(), mUnpresentedInput.begin() + Shown );
 }
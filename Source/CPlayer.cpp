@@ -12,36 +12,34 @@
 //-----------------------------------------------------------------------------
 #include "CPlayer.h"
 #include <algorithm>
-#include "../RectangleUtil.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+static const double kThrust = 42.0;	// Velocity gained per second a direction is held
+static const float kShotInterval = 0.2f;		// Seconds between shots
+static const float kExplosionFrameTime = 0.075f;	// Seconds per explosion frame
 
 //-----------------------------------------------------------------------------
 // Name : CPlayer () (Constructor)
 // Desc : CPlayer Class Constructor
 //-----------------------------------------------------------------------------
-CPlayer::CPlayer(const BackBuffer *pBackBuffer, std::vector<Bullet> & aFiredBullets)
-  :mBackBuffer(pBackBuffer)
+CPlayer::CPlayer(SpriteBank *pSprites, ProjectilePool & aFiredBullets, IPlatform *pPlatform)
+  :mSprites(pSprites)
   ,mFacingDirection(DIRECTION::DIR_FORWARD)
   ,mLives(3)
   ,mScore(0)
   ,mFiredBullets(aFiredBullets)
+  ,mPlatform(pPlatform)
 {
-	m_pSprite = new Sprite("data/planeimg.bmp", "data/planemask.bmp");
-	//m_pSprite = new Sprite("data/planeimgandmask.bmp", RGB(0xff,0x00, 0xff));
-	m_pSprite->setBackBuffer( pBackBuffer );
+	// The facing and explosion sprites are shared, in the sprite bank
 	m_eSpeedState = SPEED_STOP;
 	m_fTimer = 0;
 
-	// Animation frame crop rectangle
-	RECT r;
-	r.left = 0;
-	r.top = 0;
-	r.right = 128;
-	r.bottom = 128;
-
-	m_pExplosionSprite	= new AnimatedSprite("data/explosion.bmp", "data/explosionmask.bmp", r, 16);
-	m_pExplosionSprite->setBackBuffer( pBackBuffer );
 	m_bExplosion		= false;
 	m_iExplosionFrame	= 0;
+	m_fExplosionTimer	= 0.0f;
+	m_fShotCooldown		= 0.0f;
 }
 
 //-----------------------------------------------------------------------------
@@ -50,43 +48,56 @@ CPlayer::CPlayer(const BackBuffer *pBackBuffer, std::vector<Bullet> & aFiredBull
 //-----------------------------------------------------------------------------
 CPlayer::~CPlayer()
 {
-	delete m_pSprite;
-	delete m_pExplosionSprite;
 }
 
-void CPlayer::Update(float dt, const RECT & rectangle)
+void CPlayer::Update(float dt, int32_t aLeft, int32_t aTop, int32_t aRight, int32_t aBottom)
 {
-  RECT playerRect;
-  playerRect.left   = (LONG)m_pSprite->mPosition.x - m_pSprite->width() / 2;
-  playerRect.right  = (LONG)m_pSprite->mPosition.x + m_pSprite->width() / 2;
-  playerRect.top    = (LONG)m_pSprite->mPosition.y - m_pSprite->height() / 2;
-  playerRect.bottom = (LONG)m_pSprite->mPosition.y + m_pSprite->height() / 2;
+  mPreviousPosition = mPosition;
+  mFiredBullets.StorePrevious();
+
+  // Timers run on simulation time so replays match the recorded run.
+  m_fShotCooldown -= dt;
+
+  if (m_bExplosion)
+  {
+    m_fExplosionTimer += dt;
+    while (m_bExplosion && m_fExplosionTimer >= kExplosionFrameTime)
+    {
+      m_fExplosionTimer -= kExplosionFrameTime;
+      AdvanceExplosion();
+    }
+  }
+
+  int32_t playerLeft, playerTop, playerRight, playerBottom;
+  GetBounds(playerLeft, playerTop, playerRight, playerBottom);
 
-  if (m_pSprite->mVelocity.x < 0 && playerRect.left <= rectangle.left)
+  if (mVelocity.x < 0 && playerLeft <= aLeft)
     this->ResetXVelocity();
-  if (m_pSprite->mVelocity.x > 0 && playerRect.right >= rectangle.right)
+  if (mVelocity.x > 0 && playerRight >= aRight)
     this->ResetXVelocity();
 
-  if (m_pSprite->mVelocity.y < 0 && playerRect.top <= rectangle.top)
+  if (mVelocity.y < 0 && playerTop <= aTop)
     this->ResetYVelocity();
-  if (m_pSprite->mVelocity.y > 0 && playerRect.bottom >= rectangle.bottom)
+  if (mVelocity.y > 0 && playerBottom >= aBottom)
     this->ResetYVelocity();
 
-  mFiredBullets.erase(remove_if(begin(mFiredBullets), end(mFiredBullets), 
-                                [&](const auto & aBullet)
-                                { return !aBullet.IsInRectangle(rectangle); }),
-                      mFiredBullets.end());
+  const EntityStore & bullets = mFiredBullets.Entities();
+  mFiredBullets.ReleaseIf([&](size_t aIndex)
+  {
+    int32_t left, top, right, bottom;
+    bullets.GetBounds(aIndex, left, top, right, bottom);
 
-	// Update sprite
-	m_pSprite->update(dt);
+    return right < aLeft || left > aRight ||
+           bottom < aTop || top > aBottom;
+  });
 
-  for (auto & bullet : mFiredBullets)
-  {
-    bullet.Update(dt);
-  }
+	// Update position
+	mPosition += mVelocity * dt;
+
+  mFiredBullets.Integrate(dt);
 
 	// Get velocity
-	double v = m_pSprite->mVelocity.Magnitude();
+	double v = mVelocity.Magnitude();
 
 	// NOTE: for each async sound played Windows creates a thread for you
 	// but only one, so you cannot play multiple sounds at once.
@@ -103,7 +114,7 @@ void CPlayer::Update(float dt, const RECT & rectangle)
 		if(v > 35.0f)
 		{
 			m_eSpeedState = SPEED_START;
-			PlaySound("data/jet-start.wav", NULL, SND_FILENAME | SND_ASYNC);
+			mPlatform->PlayAudio("Data/jet-start.wav");
 			m_fTimer = 0;
 		}
 		break;
@@ -111,13 +122,13 @@ void CPlayer::Update(float dt, const RECT & rectangle)
 		if(v < 25.0f)
 		{
 			m_eSpeedState = SPEED_STOP;
-			PlaySound("data/jet-stop.wav", NULL, SND_FILENAME | SND_ASYNC);
+			mPlatform->PlayAudio("Data/jet-stop.wav");
 			m_fTimer = 0;
 		}
 		else
 			if(m_fTimer > 1.f)
 			{
-				PlaySound("data/jet-cabin.wav", NULL, SND_FILENAME | SND_ASYNC);
+				mPlatform->PlayAudio("Data/jet-cabin.wav");
 				m_fTimer = 0;
 			}
 		break;
@@ -129,64 +140,78 @@ void CPlayer::Update(float dt, const RECT & rectangle)
 	// http://www.codeproject.com/KB/audio-video/midiwrapper.aspx (with code also)
 }
 
-void CPlayer::Draw()
+void CPlayer::Draw(float fAlpha)
 {
-  for (auto & aBullet : mFiredBullets)
-  {
-    aBullet.Draw();
-  }
+  mSprites->DrawEntities(mFiredBullets.Entities(), fAlpha);
 
 	if(!m_bExplosion)
-		m_pSprite->draw();
+	{
+		// Draw between the last two ticks.
+		const Vec2 position = mPreviousPosition + (mPosition - mPreviousPosition) * fAlpha;
+		mSprites->Draw(FacingSprite(mFacingDirection), (float)position.x, (float)position.y);
+	}
 	else
-		m_pExplosionSprite->draw();
+	{
+		// The frame last advanced to, see AdvanceExplosion
+		mSprites->Draw(SPRITE_EXPLOSION, (float)mExplosionPosition.x, (float)mExplosionPosition.y,
+			m_iExplosionFrame > 0 ? m_iExplosionFrame - 1 : 0);
+	}
 
 }
 
-void CPlayer::Move(ULONG ulDirection)
+void CPlayer::Move(uint32_t ulDirection, float dt)
 {
+	const double thrust = kThrust * dt;
+
 	if( ulDirection & DIRECTION::DIR_LEFT )
-		m_pSprite->mVelocity.x -= .7;
+		mVelocity.x -= thrust;
 
 	if( ulDirection & DIRECTION::DIR_RIGHT )
-		m_pSprite->mVelocity.x += .7;
+		mVelocity.x += thrust;
 
 	if( ulDirection & DIRECTION::DIR_FORWARD )
-		m_pSprite->mVelocity.y -= .7;
+		mVelocity.y -= thrust;
 
 	if( ulDirection & DIRECTION::DIR_BACKWARD )
-		m_pSprite->mVelocity.y += .7;
+		mVelocity.y += thrust;
 }
 
 
 Vec2& CPlayer::Position()
 {
-	return m_pSprite->mPosition;
+	return mPosition;
 }
 
 Vec2& CPlayer::Velocity()
 {
-	return m_pSprite->mVelocity;
+	return mVelocity;
+}
+
+void CPlayer::Teleport(const Vec2& position)
+{
+	mPosition = position;
+	mPreviousPosition = position;
 }
 
 void CPlayer::Explode()
 {
-	m_pExplosionSprite->mPosition = m_pSprite->mPosition;
-	m_pExplosionSprite->SetFrame(0);
-	PlaySound("data/explosion.wav", NULL, SND_FILENAME | SND_ASYNC);
+	mExplosionPosition = mPosition;
+	m_iExplosionFrame = 0;
+	mPlatform->PlayAudio("Data/explosion.wav");
 	m_bExplosion = true;
+	m_fExplosionTimer = 0.0f;
 }
 
 bool CPlayer::AdvanceExplosion()
 {
 	if(m_bExplosion)
 	{
-		m_pExplosionSprite->SetFrame(m_iExplosionFrame++);
-		if(m_iExplosionFrame==m_pExplosionSprite->GetFrameCount())
+		m_iExplosionFrame++;
+		if(m_iExplosionFrame==mSprites->FrameCount(SPRITE_EXPLOSION))
 		{
 			m_bExplosion = false;
 			m_iExplosionFrame = 0;
-			m_pSprite->mVelocity = Vec2(0,0);
+			mVelocity = Vec2(0,0);
 			m_eSpeedState = SPEED_STOP;
 			return false;
 		}
@@ -205,111 +230,132 @@ void CPlayer::Shoot()
   if (m_bExplosion)
     return;
 
-  static auto lastFireTime = 0;
-  auto currentFireTime = ::GetTickCount();
-
-  if (currentFireTime - lastFireTime < 200)
+  if (m_fShotCooldown > 0.0f)
     return;
 
-  mFiredBullets.emplace_back(mBackBuffer, m_pSprite->mPosition, mFacingDirection, this);
-  lastFireTime = currentFireTime;
-}
+  static const float kBulletSpeed = 300.0f;
 
-void CPlayer::ShootEnemies(EnemyGroup & aEnemyGroup)
-{
-  std::vector<Bullet*> usedBullets;
-  for (auto & aBullet : mFiredBullets)
+  SpriteId sprite = SPRITE_BULLET_UP;
+  Vec2 velocity = GetFacingVector() * kBulletSpeed;
+
+  switch (mFacingDirection)
   {
-    bool isUsed = aEnemyGroup.HandleBullet(aBullet);
-    if (isUsed)
-    {
-      usedBullets.push_back(&aBullet);
-    }
+  case DIRECTION::DIR_BACKWARD:
+    sprite = SPRITE_BULLET_DOWN;
+    break;
+  case DIRECTION::DIR_LEFT:
+    sprite = SPRITE_BULLET_LEFT;
+    break;
+  case DIRECTION::DIR_RIGHT:
+    sprite = SPRITE_BULLET_RIGHT;
+    break;
+  default:
+    break;
   }
 
-  mScore += usedBullets.size();
-
-  auto newEnd = std::remove_if(mFiredBullets.begin(), mFiredBullets.end(),
-                               [&](Bullet & aBullet)
-                               {
-                                 return std::find(usedBullets.begin(), usedBullets.end(), &aBullet)
-                                        != usedBullets.end();
-                               });
-
-  mFiredBullets.erase(newEnd, mFiredBullets.end());
+  mFiredBullets.Spawn((float)mPosition.x, (float)mPosition.y,
+                      (float)velocity.x, (float)velocity.y, (uint16_t)sprite,
+                      mSprites->Width(sprite) / 2, mSprites->Height(sprite) / 2, OWNER_PLAYER);
+  m_fShotCooldown = kShotInterval;
 }
 
 void CPlayer::ResetXVelocity()
 {
-  m_pSprite->mVelocity.x = 0;
+  mVelocity.x = 0;
 }
 
 void CPlayer::ResetYVelocity()
 {
-  m_pSprite->mVelocity.y = 0;
+  mVelocity.y = 0;
 }
 
 void CPlayer::RotateLeft()
 {
-  auto position = m_pSprite->mPosition;
-  auto velocity = m_pSprite->mVelocity;
-
-  delete m_pSprite;
-
   switch (mFacingDirection)
   {
   case DIRECTION::DIR_FORWARD:
-    m_pSprite = new Sprite("data/leftPlaneImg.bmp", "data/leftPlaneMask.bmp");
-    mFacingDirection = DIRECTION::DIR_LEFT;
+    SetFacing(DIRECTION::DIR_LEFT);
     break;
   case DIRECTION::DIR_BACKWARD:
-    m_pSprite = new Sprite("data/rightPlaneImg.bmp", "data/rightPlaneMask.bmp");
-    mFacingDirection = DIRECTION::DIR_RIGHT;
+    SetFacing(DIRECTION::DIR_RIGHT);
     break;
   case DIRECTION::DIR_LEFT:
-    mFacingDirection = DIRECTION::DIR_BACKWARD;
-    m_pSprite = new Sprite("data/downPlaneImg.bmp", "data/downPlaneMask.bmp");
+    SetFacing(DIRECTION::DIR_BACKWARD);
     break;
   case DIRECTION::DIR_RIGHT:
-    m_pSprite = new Sprite("data/upPlaneImg.bmp", "data/upPlaneMask.bmp");
-    mFacingDirection = DIRECTION::DIR_FORWARD;
+    SetFacing(DIRECTION::DIR_FORWARD);
     break;
   }
-  m_pSprite->mPosition = position;
-  m_pSprite->mVelocity = velocity;
-  m_pSprite->setBackBuffer(mBackBuffer);
 }
 
 void CPlayer::RotateRight()
 {
-  auto position = m_pSprite->mPosition;
-  auto velocity = m_pSprite->mVelocity;
-
-  delete m_pSprite;
-
   switch (mFacingDirection)
   {
   case DIRECTION::DIR_FORWARD:
-    m_pSprite = new Sprite("data/rightPlaneImg.bmp", "data/rightPlaneMask.bmp");
-    mFacingDirection = DIRECTION::DIR_RIGHT;
+    SetFacing(DIRECTION::DIR_RIGHT);
     break;
   case DIRECTION::DIR_BACKWARD:
-    m_pSprite = new Sprite("data/leftPlaneImg.bmp", "data/leftPlaneMask.bmp");
-    mFacingDirection = DIRECTION::DIR_LEFT;
+    SetFacing(DIRECTION::DIR_LEFT);
     break;
   case DIRECTION::DIR_LEFT:
-    m_pSprite = new Sprite("data/upPlaneImg.bmp", "data/upPlaneMask.bmp");
-    mFacingDirection = DIRECTION::DIR_FORWARD;
+    SetFacing(DIRECTION::DIR_FORWARD);
     break;
   case DIRECTION::DIR_RIGHT:
-    m_pSprite = new Sprite("data/downPlaneImg.bmp", "data/downPlaneMask.bmp");
-    mFacingDirection = DIRECTION::DIR_BACKWARD;
+    SetFacing(DIRECTION::DIR_BACKWARD);
     break;
   }
+}
+
+SpriteId CPlayer::FacingSprite(DIRECTION eDirection)
+{
+  switch (eDirection)
+  {
+  case DIRECTION::DIR_BACKWARD:
+    return SPRITE_PLAYER_DOWN;
+  case DIRECTION::DIR_LEFT:
+    return SPRITE_PLAYER_LEFT;
+  case DIRECTION::DIR_RIGHT:
+    return SPRITE_PLAYER_RIGHT;
+  default:
+    return SPRITE_PLAYER_UP;
+  }
+}
+
+void CPlayer::SetFacing(DIRECTION eDirection)
+{
+  mFacingDirection = eDirection;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetBounds () (Private)
+// Desc : Box of the facing sprite, same rounding as EntityStore::GetBounds.
+//-----------------------------------------------------------------------------
+void CPlayer::GetBounds(int32_t & aLeft, int32_t & aTop, int32_t & aRight, int32_t & aBottom) const
+{
+  const SpriteId sprite = FacingSprite(mFacingDirection);
+  const int32_t halfWidth  = mSprites->Width(sprite) / 2;
+  const int32_t halfHeight = mSprites->Height(sprite) / 2;
+
+  aLeft   = (int32_t)mPosition.x - halfWidth;
+  aTop    = (int32_t)mPosition.y - halfHeight;
+  aRight  = (int32_t)mPosition.x + halfWidth;
+  aBottom = (int32_t)mPosition.y + halfHeight;
+}
 
-  m_pSprite->mPosition = position;
-  m_pSprite->mVelocity = velocity;
-  m_pSprite->setBackBuffer(mBackBuffer);
+Vec2 CPlayer::GetFacingVector() const
+{
+  switch (mFacingDirection)
+  {
+  case DIRECTION::DIR_BACKWARD:
+    return Vec2(0, 1);
+  case DIRECTION::DIR_LEFT:
+    return Vec2(-1, 0);
+  case DIRECTION::DIR_RIGHT:
+    return Vec2(1, 0);
+  default:
+    return Vec2(0, -1);
+  }
 }
 
 int CPlayer::GetLives()
@@ -322,39 +368,116 @@ size_t CPlayer::GetScore()
   return mScore;
 }
 
-bool CPlayer::GetShot(EnemyGroup & aEnemyGroup)
+void CPlayer::AddScore(size_t aPoints)
 {
-  if (m_bExplosion)
-    return false;
+  mScore += aPoints;
+}
 
-  for (auto & aBullet : aEnemyGroup)
-  {
-    RECT bulletRect = aBullet->GetRectangle();
-    RECT playerRect = m_pSprite->GetRectangle();
+void CPlayer::AddColliders(Broadphase & aBroadphase)
+{
+  int32_t left, top, right, bottom;
+  GetBounds(left, top, right, bottom);
 
-    auto isShot = RectangleUtil::AreIntersecting(bulletRect, playerRect) && 
-                  m_pSprite->AreMasksOverlapping(*aBullet->GetSpritePtr());
+  mPlayerRectangle.Clear();
+  mPlayerRectangle.Add(left, top, right, bottom);
 
-    if (isShot) 
-    {
-      mLives--;
-      Explode();
-      return true;
-    }
-  }
+  mFiredBullets.Entities().BuildRectangles(mBulletRectangles);
 
-  return false;
+  aBroadphase.SetLayer(LAYER_PLAYER, &mPlayerRectangle);
+  aBroadphase.SetLayer(LAYER_PLAYER_BULLET, &mBulletRectangles);
 }
 
-bool CPlayer::IsShot(const Bullet * aBullet) const
+bool CPlayer::IsShot(const EntityStore & aBullets, size_t aBullet) const
 {
-  if (aBullet->WasFiredBy(this) || m_bExplosion)
+  if (aBullets.Owner()[aBullet] == OWNER_PLAYER || m_bExplosion)
     return false;
 
-  return m_pSprite->AreMasksOverlapping(*aBullet->GetSpritePtr());
+  int32_t playerLeft, playerTop, playerRight, playerBottom;
+  GetBounds(playerLeft, playerTop, playerRight, playerBottom);
+
+  int32_t left, top, right, bottom;
+  aBullets.GetBounds(aBullet, left, top, right, bottom);
+
+  const CollisionMask & playerMask = mSprites->GetCollisionMask(FacingSprite(mFacingDirection));
+  return playerMask.Overlaps(mSprites->GetCollisionMask(aBullets.Sprite()[aBullet]),
+                             left - playerLeft, top - playerTop);
 }
 
 void CPlayer::DecreaseLives()
 {
   --mLives;
 }
+
+void CPlayer::SetLives(int aLives)
+{
+  mLives = aLives;
+}
+
+void CPlayer::SaveState(WorldSnapshot & aSnapshot) const
+{
+  aSnapshot.Write(mPosition.x);
+  aSnapshot.Write(mPosition.y);
+  aSnapshot.Write(mVelocity.x);
+  aSnapshot.Write(mVelocity.y);
+  aSnapshot.Write(mPreviousPosition.x);
+  aSnapshot.Write(mPreviousPosition.y);
+  aSnapshot.Write((int32_t)mFacingDirection);
+  aSnapshot.Write((int32_t)m_eSpeedState);
+  aSnapshot.Write(m_fTimer);
+  aSnapshot.Write(m_fShotCooldown);
+
+  aSnapshot.Write((uint8_t)m_bExplosion);
+  aSnapshot.Write((int32_t)m_iExplosionFrame);
+  aSnapshot.Write(m_fExplosionTimer);
+  aSnapshot.Write(mExplosionPosition.x);
+  aSnapshot.Write(mExplosionPosition.y);
+
+  aSnapshot.Write((int32_t)mLives);
+  aSnapshot.Write((uint64_t)mScore);
+}
+
+bool CPlayer::LoadState(SnapshotReader & aReader)
+{
+  Vec2 position, velocity, explosionPosition;
+  int32_t facing = DIR_FORWARD, speedState = SPEED_STOP, explosionFrame = 0, lives = 0;
+  uint8_t exploding = 0;
+  uint64_t score = 0;
+
+  aReader.Read(position.x);
+  aReader.Read(position.y);
+  aReader.Read(velocity.x);
+  aReader.Read(velocity.y);
+  aReader.Read(mPreviousPosition.x);
+  aReader.Read(mPreviousPosition.y);
+  aReader.Read(facing);
+  aReader.Read(speedState);
+  aReader.Read(m_fTimer);
+  aReader.Read(m_fShotCooldown);
+
+  aReader.Read(exploding);
+  aReader.Read(explosionFrame);
+  aReader.Read(m_fExplosionTimer);
+  aReader.Read(explosionPosition.x);
+  aReader.Read(explosionPosition.y);
+
+  aReader.Read(lives);
+  aReader.Read(score);
+
+  if (aReader.Failed())
+    return false;
+  if (facing != DIR_FORWARD && facing != DIR_BACKWARD && facing != DIR_LEFT && facing != DIR_RIGHT)
+    return false;
+
+  SetFacing((DIRECTION)facing);
+  mPosition = position;
+  mVelocity = velocity;
+  m_eSpeedState = (ESpeedStates)speedState;
+
+  m_bExplosion = exploding != 0;
+  m_iExplosionFrame = explosionFrame;
+  mExplosionPosition = explosionPosition;
+
+  mLives = lives;
+  mScore = (size_t)score;
+  return true;
+}
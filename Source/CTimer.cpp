@@ -13,7 +13,24 @@
 //-----------------------------------------------------------------------------
 #include "CTimer.h"
 #include <math.h>
+#include <stdio.h>
+#include <algorithm>
 
+#if defined(_WIN32)
+#include <windows.h>
+#include <mmsystem.h>
+#endif
+
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// The frame limiter sleeps until it is a margin away from the target, then
+// spins the rest of the way. The margin follows how late sleeps actually
+// wake: it jumps up to cover the worst recent overshoot and decays slowly.
+static const double kInitialSpinMargin = 0.002;
+static const double kMinSpinMargin     = 0.0002;
+static const double kSpinMarginDecay   = 0.99;
 
 //-----------------------------------------------------------------------------
 // Name : CTimer () (Constructor)
@@ -21,24 +38,23 @@
 //-----------------------------------------------------------------------------
 CTimer::CTimer()
 {
-	// Query performance hardware and setup time scaling values
-	if (QueryPerformanceFrequency((LARGE_INTEGER *)&m_PerfFreq)) 
-	{
-		m_PerfHardware		= TRUE;
-		QueryPerformanceCounter((LARGE_INTEGER *) &m_LastTime); 
-		m_TimeScale			= 1.0f / m_PerfFreq;
-	}
-	else 
-	{ 
-		// no performance counter, read in using timeGetTime 
-		m_PerfHardware		= FALSE;
-		m_LastTime			= timeGetTime(); 
-		m_TimeScale			= 0.001f;
-	
-	} // End If No Hardware
+	// Setup time scaling values for the platform clock
+	m_LastTime			= PlatformClock::Ticks();
+	m_CurrentTime		= m_LastTime;
+	m_TimeScale			= 1.0 / PlatformClock::Frequency();
+
+#if defined(_WIN32)
+	// Ask for 1 ms scheduler granularity so the limiter's sleeps are short
+	timeBeginPeriod( 1 );
+#endif
 
 	// Clear any needed values
+	m_TimeElapsed		= 0.0f;
+	m_RawTimeElapsed	= 0.0f;
 	m_SampleCount		= 0;
+	m_NextSample		= 0;
+	m_SampleSum			= 0.0;
+	m_SpinMargin		= kInitialSpinMargin;
 	m_FrameRate			= 0;
 	m_FPSFrameCount		= 0;
 	m_FPSTimeElapsed	= 0.0f;
@@ -50,74 +66,36 @@ CTimer::CTimer()
 //-----------------------------------------------------------------------------
 CTimer::~CTimer()
 {
+#if defined(_WIN32)
+	timeEndPeriod( 1 );
+#endif
 }
 
 //-----------------------------------------------------------------------------
 // Name : Tick () 
 // Desc : Function which signals that frame has advanced
 // Note : You can specify a number of frames per second to lock the frame rate
-//			to. This will simply soak up the remaining time to hit that target.
+//			to. The remaining time is slept away, with only the last
+//			fraction of a millisecond or so spent polling the clock.
 //-----------------------------------------------------------------------------
 void CTimer::Tick( float fLockFPS )
 {
-	float fTimeElapsed; 
-
-	// Is performance hardware available?
-	if ( m_PerfHardware ) 
-	{
-		// Query high-resolution performance hardware
-		QueryPerformanceCounter((LARGE_INTEGER *)&m_CurrentTime);
-	} 
-	else 
-	{
-		// Fall back to less accurate timer
-		m_CurrentTime = timeGetTime();
-
-	} // End If no hardware available
-
-	// Calculate elapsed time in seconds
-	fTimeElapsed = (m_CurrentTime - m_LastTime) * m_TimeScale;
-
-	// Smoothly ramp up frame rate to prevent jittering
-	//if ( fLockFPS == 0.0f ) fLockFPS = (1.0f / GetTimeElapsed()) + 20.0f;
-	
 	// Should we lock the frame rate ?
 	if ( fLockFPS > 0.0f )
-	{
-		while ( fTimeElapsed < (1.0f / fLockFPS))
-		{
-			// Is performance hardware available?
-			if ( m_PerfHardware ) 
-			{
-				// Query high-resolution performance hardware
-				QueryPerformanceCounter((LARGE_INTEGER*)&m_CurrentTime);
-			} 
-			else 
-			{
-				// Fall back to less accurate timer
-				m_CurrentTime = timeGetTime();
+		WaitUntil( m_LastTime + (int64_t)(1.0 / (fLockFPS * m_TimeScale)) );
 
-			} // End If no hardware available
+	// Query the high-resolution clock
+	m_CurrentTime = PlatformClock::Ticks();
 
-			// Calculate elapsed time in seconds
-			fTimeElapsed = (m_CurrentTime - m_LastTime) * m_TimeScale;
-
-		} // End While
-	} // End If
+	// Calculate elapsed time in seconds
+	const float fTimeElapsed = (float)((m_CurrentTime - m_LastTime) * m_TimeScale);
 
 	// Save current frame time
 	m_LastTime = m_CurrentTime;
+	m_RawTimeElapsed = fTimeElapsed;
 
 	// Filter out values wildly different from current average
-	if ( fabsf(fTimeElapsed - m_TimeElapsed) < 1.0f  )
-	{
-		// Wrap FIFO frame time buffer.
-		memmove( &m_FrameTime[1], m_FrameTime, (MAX_SAMPLE_COUNT - 1) * sizeof(float) );
-		m_FrameTime[ 0 ] = fTimeElapsed;
-		if ( m_SampleCount < MAX_SAMPLE_COUNT ) m_SampleCount++;
-
-	} // End if
-	
+	if ( fabsf(fTimeElapsed - m_TimeElapsed) < 1.0f  ) AddSample( fTimeElapsed );
 
 	// Calculate Frame Rate
 	m_FPSFrameCount++;
@@ -129,27 +107,79 @@ void CTimer::Tick( float fLockFPS )
 		m_FPSTimeElapsed	= 0.0f;
 	} // End If Second Elapsed
 
-	// Count up the new average elapsed time
-	m_TimeElapsed = 0.0f;
-	for ( ULONG i = 0; i < m_SampleCount; i++ ) m_TimeElapsed += m_FrameTime[ i ];
-	if ( m_SampleCount > 0 ) m_TimeElapsed /= m_SampleCount;
+	// The average comes straight from the running sum
+	if ( m_SampleCount > 0 ) m_TimeElapsed = (float)(m_SampleSum / m_SampleCount);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reset () 
+// Desc : Restarts the current frame's measurement, so time spent paused
+//		does not show up as one long frame at the next Tick.
+//-----------------------------------------------------------------------------
+void CTimer::Reset()
+{
+	m_LastTime = PlatformClock::Ticks();
+}
+
+//-----------------------------------------------------------------------------
+// Name : WaitUntil () (Private)
+// Desc : Sleeps, then spins, until the clock reaches Target.
+//-----------------------------------------------------------------------------
+void CTimer::WaitUntil( int64_t Target )
+{
+	for ( ;; )
+	{
+		const double Remaining = (Target - PlatformClock::Ticks()) * m_TimeScale;
+		if ( Remaining <= 0.0 ) return;
+
+		// Far enough out to sleep without overshooting?
+		if ( Remaining > m_SpinMargin )
+		{
+			const double  Request = Remaining - m_SpinMargin;
+			const int64_t Before  = PlatformClock::Ticks();
+			PlatformClock::SleepFor( Request );
+
+			const double Overshoot = (PlatformClock::Ticks() - Before) * m_TimeScale - Request;
+			m_SpinMargin = std::max( std::max( Overshoot * 1.25, m_SpinMargin * kSpinMarginDecay ), kMinSpinMargin );
+		}
 
+	} // Until target reached
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddSample () (Private)
+// Desc : Puts a frame time in the ring, replacing the oldest once it is full,
+//		and keeps the running sum in step. The sum is rebuilt each time the
+//		ring wraps so rounding cannot build up.
+//-----------------------------------------------------------------------------
+void CTimer::AddSample( float fTimeElapsed )
+{
+	if ( m_SampleCount == MAX_SAMPLE_COUNT ) m_SampleSum -= m_FrameTime[ m_NextSample ];
+	else m_SampleCount++;
+
+	m_FrameTime[ m_NextSample ] = fTimeElapsed;
+	m_SampleSum += fTimeElapsed;
+
+	if ( ++m_NextSample == MAX_SAMPLE_COUNT )
+	{
+		m_NextSample = 0;
+		m_SampleSum	 = 0.0;
+		for ( uint32_t i = 0; i < m_SampleCount; i++ ) m_SampleSum += m_FrameTime[ i ];
+
+	} // End if wrapped
 }
 
 //-----------------------------------------------------------------------------
 // Name : GetFrameRate () 
 // Desc : Returns the frame rate, sampled over the last second or so.
 //-----------------------------------------------------------------------------
-unsigned long CTimer::GetFrameRate( LPTSTR lpszString, size_t size ) const
+unsigned long CTimer::GetFrameRate( char * lpszString, size_t size ) const
 {
 	// Fill string buffer ?
-	if ( lpszString )
+	if ( lpszString && size > 0 )
 	{
-		// Copy frame rate value into string
-		_itot_s( m_FrameRate, lpszString, size, 10 );
-
-		// Append with FPS
-		strcat_s( lpszString, size, _T(" FPS") );
+		// Frame rate value followed by FPS
+		snprintf( lpszString, size, "%lu FPS", m_FrameRate );
 
 	} // End if build FPS string
 
@@ -164,3 +194,53 @@ float CTimer::GetTimeElapsed() const
 {
 	return m_TimeElapsed;
 }
+
+//-----------------------------------------------------------------------------
+// Name : GetRawTimeElapsed () 
+// Desc : Returns the measured time of the last frame (Seconds), without the
+//		averaging; this is what a fixed step accumulator has to consume.
+//-----------------------------------------------------------------------------
+float CTimer::GetRawTimeElapsed() const
+{
+	return m_RawTimeElapsed;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetFrameTimeMin () 
+// Desc : Shortest frame time in the sample window (Seconds)
+//-----------------------------------------------------------------------------
+float CTimer::GetFrameTimeMin() const
+{
+	if ( m_SampleCount == 0 ) return 0.0f;
+	return *std::min_element( m_FrameTime, m_FrameTime + m_SampleCount );
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetFrameTimeMax () 
+// Desc : Longest frame time in the sample window (Seconds)
+//-----------------------------------------------------------------------------
+float CTimer::GetFrameTimeMax() const
+{
+	if ( m_SampleCount == 0 ) return 0.0f;
+	return *std::max_element( m_FrameTime, m_FrameTime + m_SampleCount );
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetFrameTimePercentile () 
+// Desc : Frame time that fPercentile (0-100) of the window is at or under
+//		(Seconds). Selects on a copy, so the ring is left in order.
+//-----------------------------------------------------------------------------
+float CTimer::GetFrameTimePercentile( float fPercentile ) const
+{
+	if ( m_SampleCount == 0 ) return 0.0f;
+
+	float Sorted[ MAX_SAMPLE_COUNT ];
+	std::copy( m_FrameTime, m_FrameTime + m_SampleCount, Sorted );
+
+	uint32_t Rank = (uint32_t)ceilf( fPercentile / 100.0f * m_SampleCount );
+	Rank = std::max( Rank, 1u );
+	Rank = std::min( Rank, m_SampleCount );
+
+	std::nth_element( Sorted, Sorted + Rank - 1, Sorted + m_SampleCount );
+	return Sorted[ Rank - 1 ];
+}
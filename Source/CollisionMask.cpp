@@ -0,0 +1,203 @@
+//-----------------------------------------------------------------------------
+// File: CollisionMask.cpp
+//
+// Desc: Bit-packed opacity mask used for pixel exact collision queries.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CollisionMask Specific Includes
+//-----------------------------------------------------------------------------
+#include "CollisionMask.h"
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Name : CollisionMask () (Constructor)
+// Desc : CollisionMask Class Constructor
+//-----------------------------------------------------------------------------
+CollisionMask::CollisionMask()
+	: mWidth(0)
+	, mHeight(0)
+	, mRowWords(0)
+{
+}
+
+CollisionMask::CollisionMask(int aWidth, int aHeight)
+	: CollisionMask()
+{
+	Resize(aWidth, aHeight);
+}
+
+void CollisionMask::Resize(int aWidth, int aHeight)
+{
+	mWidth    = aWidth;
+	mHeight   = aHeight;
+	mRowWords = (aWidth + 31) / 32;
+	mBits.assign((size_t)mRowWords * aHeight, 0);
+}
+
+void CollisionMask::SetOpaque(int aX, int aY, bool aOpaque)
+{
+	if (aX < 0 || aY < 0 || aX >= mWidth || aY >= mHeight)
+		return;
+
+	uint32_t & word = mBits[aY * mRowWords + (aX >> 5)];
+	uint32_t bit    = 1u << (aX & 31);
+
+	if (aOpaque)
+		word |= bit;
+	else
+		word &= ~bit;
+}
+
+CollisionMask CollisionMask::Crop(int aX, int aY, int aWidth, int aHeight) const
+{
+	CollisionMask result(aWidth, aHeight);
+
+	for (int y = 0; y < aHeight; ++y)
+		for (int x = 0; x < aWidth; x += 32)
+			result.mBits[y * result.mRowWords + (x >> 5)] = GetBits(aX + x, aY + y);
+
+	// Clear the bits past the right edge of the last word.
+	if (aWidth & 31)
+	{
+		const uint32_t tail = (1u << (aWidth & 31)) - 1;
+		for (int y = 0; y < aHeight; ++y)
+			result.mBits[y * result.mRowWords + result.mRowWords - 1] &= tail;
+	}
+
+	return result;
+}
+
+bool CollisionMask::GetOpaqueBounds(int & aLeft, int & aTop, int & aRight, int & aBottom) const
+{
+	aLeft = mWidth;
+	aTop  = mHeight;
+	aRight = aBottom = -1;
+
+	for (int y = 0; y < mHeight; ++y)
+	{
+		for (int x = 0; x < mWidth; ++x)
+		{
+			if (!IsOpaque(x, y))
+				continue;
+
+			aLeft   = std::min(aLeft, x);
+			aTop    = std::min(aTop, y);
+			aRight  = std::max(aRight, x);
+			aBottom = std::max(aBottom, y);
+		}
+	}
+
+	return aRight >= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Overlaps ()
+// Desc : Word at a time AND of the overlapping rows.
+//-----------------------------------------------------------------------------
+bool CollisionMask::Overlaps(const CollisionMask & aOther, int aOffsetX, int aOffsetY) const
+{
+	const int left   = std::max(0, aOffsetX);
+	const int top    = std::max(0, aOffsetY);
+	const int right  = std::min(mWidth, aOffsetX + aOther.mWidth);
+	const int bottom = std::min(mHeight, aOffsetY + aOther.mHeight);
+
+	if (left >= right || top >= bottom)
+		return false;
+
+	for (int y = top; y < bottom; ++y)
+	{
+		for (int x = left; x < right; x += 32)
+		{
+			uint32_t bits = GetBits(x, y) & aOther.GetBits(x - aOffsetX, y - aOffsetY);
+
+			// Ignore columns past the overlap on the last chunk.
+			if (right - x < 32)
+				bits &= (1u << (right - x)) - 1;
+
+			if (bits)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+uint32_t CollisionMask::GetBits(int aX, int aY) const
+{
+	if (aY < 0 || aY >= mHeight || aX >= mWidth || aX <= -32)
+		return 0;
+
+	const uint32_t * row = &mBits[aY * mRowWords];
+
+	if (aX < 0)
+		return row[0] << (-aX);
+
+	const int word  = aX >> 5;
+	const int shift = aX & 31;
+
+	uint32_t bits = row[word] >> shift;
+	if (shift && word + 1 < mRowWords)
+		bits |= row[word + 1] << (32 - shift);
+
+	return bits;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Raycast ()
+// Desc : Grid traversal (Amanatides & Woo) over the mask pixels, starting at
+//		the point where the ray enters at aMinT.
+//-----------------------------------------------------------------------------
+bool CollisionMask::Raycast(float aX, float aY, float aDirX, float aDirY,
+                            float aMinT, float aMaxT, float & aHitT) const
+{
+	if (IsEmpty() || aMinT > aMaxT)
+		return false;
+
+	float px = aX + aDirX * aMinT;
+	float py = aY + aDirY * aMinT;
+
+	// The entry point can sit exactly on the far edge, keep it inside.
+	int x = std::min(std::max((int)floorf(px), 0), mWidth - 1);
+	int y = std::min(std::max((int)floorf(py), 0), mHeight - 1);
+
+	const int stepX = aDirX > 0.0f ? 1 : -1;
+	const int stepY = aDirY > 0.0f ? 1 : -1;
+
+	const float deltaX = aDirX != 0.0f ? fabsf(1.0f / aDirX) : FLT_MAX;
+	const float deltaY = aDirY != 0.0f ? fabsf(1.0f / aDirY) : FLT_MAX;
+
+	float maxX = aDirX != 0.0f ? aMinT + ((stepX > 0 ? x + 1 : x) - px) / aDirX : FLT_MAX;
+	float maxY = aDirY != 0.0f ? aMinT + ((stepY > 0 ? y + 1 : y) - py) / aDirY : FLT_MAX;
+
+	float t = aMinT;
+	while (t <= aMaxT)
+	{
+		if ((mBits[y * mRowWords + (x >> 5)] >> (x & 31)) & 1u)
+		{
+			aHitT = t;
+			return true;
+		}
+
+		if (maxX < maxY)
+		{
+			t     = maxX;
+			maxX += deltaX;
+			x    += stepX;
+			if (x < 0 || x >= mWidth)
+				break;
+		}
+		else
+		{
+			t     = maxY;
+			maxY += deltaY;
+			y    += stepY;
+			if (y < 0 || y >= mHeight)
+				break;
+		}
+	}
+
+	return false;
+}
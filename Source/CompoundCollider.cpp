@@ -0,0 +1,346 @@
+//-----------------------------------------------------------------------------
+// File: CompoundCollider.cpp
+//
+// Desc: Multi-part collider with a small bounding volume hierarchy.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CompoundCollider Specific Includes
+//-----------------------------------------------------------------------------
+#include "CompoundCollider.h"
+#include "SpatialGrid.h"
+#include "WorldSnapshot.h"
+#include <float.h>
+#include <limits.h>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+static const int32_t kLeafParts = 2;	// Parts per leaf node
+static const int     kMaxDepth  = 32;	// Traversal stack size
+
+//-----------------------------------------------------------------------------
+// Name : CompoundCollider () (Constructor)
+// Desc : CompoundCollider Class Constructor
+//-----------------------------------------------------------------------------
+CompoundCollider::CompoundCollider()
+	: mLiveParts(0)
+{
+}
+
+void CompoundCollider::BuildFromMask(const CollisionMask & aMask, int aPartSize, int aHitPoints)
+{
+	mParts.clear();
+	mNodes.clear();
+	mOrder.clear();
+
+	for (int y = 0; y < aMask.Height(); y += aPartSize)
+	{
+		for (int x = 0; x < aMask.Width(); x += aPartSize)
+		{
+			CollisionMask tile = aMask.Crop(x, y, aPartSize, aPartSize);
+
+			int left, top, right, bottom;
+			if (!tile.GetOpaqueBounds(left, top, right, bottom))
+				continue;
+
+			ColliderPart part;
+			part.mLeft      = x + left;
+			part.mTop       = y + top;
+			part.mRight     = x + right;
+			part.mBottom    = y + bottom;
+			part.mMask      = tile.Crop(left, top, right - left + 1, bottom - top + 1);
+			part.mHitPoints = aHitPoints;
+			mParts.push_back(part);
+		}
+	}
+
+	mLiveParts = mParts.size();
+	for (size_t i = 0; i < mParts.size(); ++i)
+		mOrder.push_back((int32_t)i);
+
+	if (!mParts.empty())
+		BuildNode(0, (int32_t)mParts.size());
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildNode () (Private)
+// Desc : Top-down median split along the longer axis of the part centres.
+//-----------------------------------------------------------------------------
+int32_t CompoundCollider::BuildNode(int32_t aFirst, int32_t aCount)
+{
+	const int32_t index = (int32_t)mNodes.size();
+	mNodes.push_back(Node());
+
+	if (aCount <= kLeafParts)
+	{
+		mNodes[index].mFirst      = aFirst;
+		mNodes[index].mCount      = aCount;
+		mNodes[index].mRightChild = -1;
+	}
+	else
+	{
+		int32_t minX = INT32_MAX, minY = INT32_MAX, maxX = INT32_MIN, maxY = INT32_MIN;
+		for (int32_t i = aFirst; i < aFirst + aCount; ++i)
+		{
+			const ColliderPart & part = mParts[mOrder[i]];
+			minX = std::min(minX, part.mLeft + part.mRight);
+			minY = std::min(minY, part.mTop + part.mBottom);
+			maxX = std::max(maxX, part.mLeft + part.mRight);
+			maxY = std::max(maxY, part.mTop + part.mBottom);
+		}
+
+		const bool splitX = (maxX - minX) >= (maxY - minY);
+		const int32_t half = aCount / 2;
+		std::nth_element(mOrder.begin() + aFirst, mOrder.begin() + aFirst + half,
+			mOrder.begin() + aFirst + aCount, [&](int32_t aA, int32_t aB)
+		{
+			const ColliderPart & a = mParts[aA];
+			const ColliderPart & b = mParts[aB];
+			return splitX ? (a.mLeft + a.mRight) < (b.mLeft + b.mRight)
+			              : (a.mTop + a.mBottom) < (b.mTop + b.mBottom);
+		});
+
+		mNodes[index].mFirst = aFirst;
+		mNodes[index].mCount = 0;
+
+		BuildNode(aFirst, half);
+		const int32_t right = BuildNode(aFirst + half, aCount - half);
+		mNodes[index].mRightChild = right;
+	}
+
+	Refit(index);
+	return index;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Refit () (Private)
+// Desc : Recomputes a node's bounds from its live parts / children. A node
+//		with nothing alive gets inverted bounds and is never entered.
+//-----------------------------------------------------------------------------
+void CompoundCollider::Refit(int32_t aNode)
+{
+	Node & node = mNodes[aNode];
+	node.mLeft = node.mTop = INT32_MAX;
+	node.mRight = node.mBottom = INT32_MIN;
+
+	if (node.mRightChild < 0)
+	{
+		for (int32_t i = node.mFirst; i < node.mFirst + node.mCount; ++i)
+		{
+			const ColliderPart & part = mParts[mOrder[i]];
+			if (part.mHitPoints <= 0)
+				continue;
+
+			node.mLeft   = std::min(node.mLeft, part.mLeft);
+			node.mTop    = std::min(node.mTop, part.mTop);
+			node.mRight  = std::max(node.mRight, part.mRight);
+			node.mBottom = std::max(node.mBottom, part.mBottom);
+		}
+	}
+	else
+	{
+		const Node & left  = mNodes[aNode + 1];
+		const Node & right = mNodes[node.mRightChild];
+
+		node.mLeft   = std::min(left.mLeft, right.mLeft);
+		node.mTop    = std::min(left.mTop, right.mTop);
+		node.mRight  = std::max(left.mRight, right.mRight);
+		node.mBottom = std::max(left.mBottom, right.mBottom);
+	}
+}
+
+int CompoundCollider::HitTest(const CollisionMask & aOther, int aOffsetX, int aOffsetY) const
+{
+	if (mNodes.empty())
+		return -1;
+
+	const int32_t left   = aOffsetX;
+	const int32_t top    = aOffsetY;
+	const int32_t right  = aOffsetX + aOther.Width() - 1;
+	const int32_t bottom = aOffsetY + aOther.Height() - 1;
+
+	int32_t stack[kMaxDepth];
+	int depth = 0;
+	stack[depth++] = 0;
+
+	while (depth > 0)
+	{
+		const Node & node = mNodes[stack[--depth]];
+
+		if (node.mRight < left || right < node.mLeft || node.mBottom < top || bottom < node.mTop)
+			continue;
+
+		if (node.mRightChild >= 0)
+		{
+			stack[depth++] = node.mRightChild;
+			stack[depth++] = (int32_t)(&node - mNodes.data()) + 1;
+			continue;
+		}
+
+		for (int32_t i = node.mFirst; i < node.mFirst + node.mCount; ++i)
+		{
+			const ColliderPart & part = mParts[mOrder[i]];
+			if (part.mHitPoints <= 0)
+				continue;
+
+			if (part.mRight < left || right < part.mLeft || part.mBottom < top || bottom < part.mTop)
+				continue;
+
+			if (part.mMask.Overlaps(aOther, aOffsetX - part.mLeft, aOffsetY - part.mTop))
+				return mOrder[i];
+		}
+	}
+
+	return -1;
+}
+
+int CompoundCollider::Raycast(float aX, float aY, float aDirX, float aDirY,
+                              float aMinT, float aMaxT, float & aHitT) const
+{
+	if (mNodes.empty() || aMinT > aMaxT)
+		return -1;
+
+	const float invX = 1.0f / (aDirX != 0.0f ? aDirX : 1e-30f);
+	const float invY = 1.0f / (aDirY != 0.0f ? aDirY : 1e-30f);
+
+	int   best  = -1;
+	float bestT = FLT_MAX;
+
+	int32_t stack[kMaxDepth];
+	int depth = 0;
+	stack[depth++] = 0;
+
+	while (depth > 0)
+	{
+		const Node & node = mNodes[stack[--depth]];
+
+		// Destroyed parts were refitted out of the bounds, and anything
+		// entered after the best hit so far cannot beat it.
+		float enterT, exitT;
+		if (!SpatialGrid::RayBox(aX, aY, invX, invY,
+		                         (float)node.mLeft, (float)node.mTop,
+		                         (float)node.mRight, (float)node.mBottom, enterT, exitT))
+			continue;
+
+		enterT = std::max(enterT, aMinT);
+		exitT  = std::min(exitT, aMaxT);
+		if (enterT > exitT || enterT >= bestT)
+			continue;
+
+		if (node.mRightChild >= 0)
+		{
+			stack[depth++] = node.mRightChild;
+			stack[depth++] = (int32_t)(&node - mNodes.data()) + 1;
+			continue;
+		}
+
+		for (int32_t i = node.mFirst; i < node.mFirst + node.mCount; ++i)
+		{
+			const ColliderPart & part = mParts[mOrder[i]];
+			if (part.mHitPoints <= 0)
+				continue;
+
+			float partEnter, partExit;
+			if (!SpatialGrid::RayBox(aX, aY, invX, invY,
+			                         (float)part.mLeft, (float)part.mTop,
+			                         (float)part.mRight, (float)part.mBottom, partEnter, partExit))
+				continue;
+
+			partEnter = std::max(partEnter, aMinT);
+			partExit  = std::min(partExit, aMaxT);
+			if (partEnter > partExit || partEnter >= bestT)
+				continue;
+
+			float hitT;
+			if (part.mMask.Raycast(aX - part.mLeft, aY - part.mTop, aDirX, aDirY,
+			                       partEnter, partExit, hitT) && hitT < bestT)
+			{
+				best  = mOrder[i];
+				bestT = hitT;
+			}
+		}
+	}
+
+	if (best >= 0)
+		aHitT = bestT;
+
+	return best;
+}
+
+int CompoundCollider::PartNear(int aX, int aY) const
+{
+	int best = -1;
+	int64_t bestDistance = INT64_MAX;
+
+	for (size_t i = 0; i < mParts.size(); ++i)
+	{
+		const ColliderPart & part = mParts[i];
+		if (part.mHitPoints <= 0)
+			continue;
+
+		const int64_t dx = aX - std::min(std::max(aX, part.mLeft), part.mRight);
+		const int64_t dy = aY - std::min(std::max(aY, part.mTop), part.mBottom);
+		const int64_t distance = dx * dx + dy * dy;
+
+		if (distance < bestDistance)
+		{
+			bestDistance = distance;
+			best = (int)i;
+		}
+	}
+
+	return best;
+}
+
+bool CompoundCollider::Damage(int aPart, int aAmount)
+{
+	if (aPart < 0 || aPart >= (int)mParts.size())
+		return false;
+
+	ColliderPart & part = mParts[aPart];
+	if (part.mHitPoints <= 0)
+		return false;
+
+	part.mHitPoints -= aAmount;
+	if (part.mHitPoints > 0)
+		return false;
+
+	--mLiveParts;
+
+	// Bounds only shrink; refit every node bottom-up (children come after
+	// their parent in mNodes).
+	for (int32_t node = (int32_t)mNodes.size() - 1; node >= 0; --node)
+		Refit(node);
+
+	return true;
+}
+
+void CompoundCollider::SaveState(WorldSnapshot & aSnapshot) const
+{
+	aSnapshot.Write((uint32_t)mParts.size());
+	for (const ColliderPart & part : mParts)
+		aSnapshot.Write((int32_t)part.mHitPoints);
+}
+
+bool CompoundCollider::LoadState(SnapshotReader & aReader)
+{
+	uint32_t count;
+	if (!aReader.Read(count) || count != mParts.size())
+		return false;
+
+	mLiveParts = 0;
+	for (ColliderPart & part : mParts)
+	{
+		int32_t hitPoints = 0;
+		aReader.Read(hitPoints);
+		part.mHitPoints = hitPoints;
+		mLiveParts += hitPoints > 0 ? 1 : 0;
+	}
+
+	for (int32_t node = (int32_t)mNodes.size() - 1; node >= 0; --node)
+		Refit(node);
+
+	return !aReader.Failed();
+}
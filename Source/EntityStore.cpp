@@ -0,0 +1,179 @@
+//-----------------------------------------------------------------------------
+// File: EntityStore.cpp
+//
+// Desc: Structure-of-arrays storage for enemies and projectiles.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// EntityStore Specific Includes
+//-----------------------------------------------------------------------------
+#include "EntityStore.h"
+#include "VecBatch.h"
+#include "JobSystem.h"
+#include "WorldSnapshot.h"
+#include <assert.h>
+
+//-----------------------------------------------------------------------------
+// Name : EntityStore () (Constructor)
+// Desc : EntityStore Class Constructor
+//-----------------------------------------------------------------------------
+EntityStore::EntityStore()
+{
+}
+
+void EntityStore::Clear()
+{
+	mX.clear();
+	mY.clear();
+	mPreviousX.clear();
+	mPreviousY.clear();
+	mVelocityX.clear();
+	mVelocityY.clear();
+	mHalfWidth.clear();
+	mHalfHeight.clear();
+	mSprite.clear();
+	mOwner.clear();
+	mCollider.clear();
+}
+
+void EntityStore::Reserve(size_t aCount)
+{
+	mX.reserve(aCount);
+	mY.reserve(aCount);
+	mPreviousX.reserve(aCount);
+	mPreviousY.reserve(aCount);
+	mVelocityX.reserve(aCount);
+	mVelocityY.reserve(aCount);
+	mHalfWidth.reserve(aCount);
+	mHalfHeight.reserve(aCount);
+	mSprite.reserve(aCount);
+	mOwner.reserve(aCount);
+	mCollider.reserve(aCount);
+}
+
+size_t EntityStore::Add(float aX, float aY, float aVelocityX, float aVelocityY,
+                        uint16_t aSprite, int32_t aHalfWidth, int32_t aHalfHeight,
+                        uint16_t aOwner, int32_t aCollider)
+{
+	mX.push_back(aX);
+	mY.push_back(aY);
+	mPreviousX.push_back(aX);
+	mPreviousY.push_back(aY);
+	mVelocityX.push_back(aVelocityX);
+	mVelocityY.push_back(aVelocityY);
+	mHalfWidth.push_back(aHalfWidth);
+	mHalfHeight.push_back(aHalfHeight);
+	mSprite.push_back(aSprite);
+	mOwner.push_back(aOwner);
+	mCollider.push_back(aCollider);
+
+	return mX.size() - 1;
+}
+
+void EntityStore::Remove(size_t aIndex)
+{
+	assert(aIndex < mX.size());
+
+	const size_t last = mX.size() - 1;
+	if (aIndex != last)
+	{
+		mX[aIndex]          = mX[last];
+		mY[aIndex]          = mY[last];
+		mPreviousX[aIndex]  = mPreviousX[last];
+		mPreviousY[aIndex]  = mPreviousY[last];
+		mVelocityX[aIndex]  = mVelocityX[last];
+		mVelocityY[aIndex]  = mVelocityY[last];
+		mHalfWidth[aIndex]  = mHalfWidth[last];
+		mHalfHeight[aIndex] = mHalfHeight[last];
+		mSprite[aIndex]     = mSprite[last];
+		mOwner[aIndex]      = mOwner[last];
+		mCollider[aIndex]   = mCollider[last];
+	}
+
+	mX.pop_back();
+	mY.pop_back();
+	mPreviousX.pop_back();
+	mPreviousY.pop_back();
+	mVelocityX.pop_back();
+	mVelocityY.pop_back();
+	mHalfWidth.pop_back();
+	mHalfHeight.pop_back();
+	mSprite.pop_back();
+	mOwner.pop_back();
+	mCollider.pop_back();
+}
+
+void EntityStore::Integrate(float aTimeElapsed, JobSystem * aJobs)
+{
+	// Smaller chunks cost more to hand out than they take to sweep.
+	static const size_t kGrain = 4096;
+
+	ParallelFor(aJobs, mX.size(), kGrain, [&](size_t aBegin, size_t aEnd, size_t)
+	{
+		VecBatch::Integrate(mX.data() + aBegin, mY.data() + aBegin,
+			mVelocityX.data() + aBegin, mVelocityY.data() + aBegin, aEnd - aBegin, aTimeElapsed);
+	});
+}
+
+void EntityStore::StorePrevious()
+{
+	mPreviousX.assign(mX.begin(), mX.end());
+	mPreviousY.assign(mY.begin(), mY.end());
+}
+
+void EntityStore::GetBounds(size_t aIndex, int32_t & aLeft, int32_t & aTop,
+                            int32_t & aRight, int32_t & aBottom) const
+{
+	const int32_t x = (int32_t)mX[aIndex];
+	const int32_t y = (int32_t)mY[aIndex];
+
+	aLeft   = x - mHalfWidth[aIndex];
+	aTop    = y - mHalfHeight[aIndex];
+	aRight  = x + mHalfWidth[aIndex];
+	aBottom = y + mHalfHeight[aIndex];
+}
+
+void EntityStore::BuildRectangles(RectangleSoA & aRectangles) const
+{
+	aRectangles.Clear();
+	aRectangles.Reserve(mX.size());
+
+	for (size_t i = 0; i < mX.size(); ++i)
+	{
+		const int32_t x = (int32_t)mX[i];
+		const int32_t y = (int32_t)mY[i];
+
+		aRectangles.Add(x - mHalfWidth[i], y - mHalfHeight[i], x + mHalfWidth[i], y + mHalfHeight[i]);
+	}
+}
+
+void EntityStore::SaveState(WorldSnapshot & aSnapshot) const
+{
+	aSnapshot.WriteArray(mX);
+	aSnapshot.WriteArray(mY);
+	aSnapshot.WriteArray(mPreviousX);
+	aSnapshot.WriteArray(mPreviousY);
+	aSnapshot.WriteArray(mVelocityX);
+	aSnapshot.WriteArray(mVelocityY);
+	aSnapshot.WriteArray(mHalfWidth);
+	aSnapshot.WriteArray(mHalfHeight);
+	aSnapshot.WriteArray(mSprite);
+	aSnapshot.WriteArray(mOwner);
+	aSnapshot.WriteArray(mCollider);
+}
+
+bool EntityStore::LoadState(SnapshotReader & aReader)
+{
+	aReader.ReadArray(mX);
+	aReader.ReadArray(mY);
+	aReader.ReadArray(mPreviousX);
+	aReader.ReadArray(mPreviousY);
+	aReader.ReadArray(mVelocityX);
+	aReader.ReadArray(mVelocityY);
+	aReader.ReadArray(mHalfWidth);
+	aReader.ReadArray(mHalfHeight);
+	aReader.ReadArray(mSprite);
+	aReader.ReadArray(mOwner);
+	aReader.ReadArray(mCollider);
+	return !aReader.Failed();
+}
@@ -0,0 +1,221 @@
+//-----------------------------------------------------------------------------
+// File: FlowField.cpp
+//
+// Desc: Coarse grid flow field toward the nearest target.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// FlowField Specific Includes
+//-----------------------------------------------------------------------------
+#include "FlowField.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <float.h>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+static const uint32_t kStraightCost = 5;
+static const uint32_t kDiagonalCost = 7;
+static const uint16_t kFar          = 0xFFFF;
+static const uint8_t  kNoDirection  = 8;
+
+// Neighbours, straight ones first so a tie never picks a diagonal.
+static const int32_t kStepX[8] = { 1, -1, 0,  0, 1, -1,  1, -1 };
+static const int32_t kStepY[8] = { 0,  0, 1, -1, 1,  1, -1, -1 };
+
+// Unit vectors of the steps above, plus none.
+static const float kDiagonal = 0.70710678f;
+static const float kFlowX[9] = { 1.0f, -1.0f, 0.0f,  0.0f, kDiagonal, -kDiagonal,  kDiagonal, -kDiagonal, 0.0f };
+static const float kFlowY[9] = { 0.0f,  0.0f, 1.0f, -1.0f, kDiagonal,  kDiagonal, -kDiagonal, -kDiagonal, 0.0f };
+
+//-----------------------------------------------------------------------------
+// Static Member Definitions
+//-----------------------------------------------------------------------------
+const size_t FlowField::kMaxTargets;
+
+//-----------------------------------------------------------------------------
+// Name : FlowField () (Constructor)
+// Desc : FlowField Class Constructor
+//-----------------------------------------------------------------------------
+FlowField::FlowField(int32_t aCellSize)
+	: mCellSize(aCellSize > 0 ? aCellSize : 32)
+	, mLeft(0)
+	, mTop(0)
+	, mColumns(0)
+	, mRows(0)
+	, mTargetCells()
+	, mTargetCount(0)
+	, mRebuilds(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Update ()
+//-----------------------------------------------------------------------------
+bool FlowField::Update(int32_t aLeft, int32_t aTop, int32_t aRight, int32_t aBottom,
+	const float * aTargetX, const float * aTargetY, size_t aTargetCount)
+{
+	const int32_t columns = std::max<int32_t>((aRight - aLeft + mCellSize - 1) / mCellSize, 1);
+	const int32_t rows    = std::max<int32_t>((aBottom - aTop + mCellSize - 1) / mCellSize, 1);
+	bool changed = aLeft != mLeft || aTop != mTop || columns != mColumns || rows != mRows;
+
+	mLeft    = aLeft;
+	mTop     = aTop;
+	mColumns = columns;
+	mRows    = rows;
+
+	aTargetCount = std::min(aTargetCount, kMaxTargets);
+	changed = changed || aTargetCount != mTargetCount;
+	for (size_t i = 0; i < aTargetCount; ++i)
+	{
+		const size_t cell = CellAt(aTargetX[i], aTargetY[i]);
+		changed = changed || cell != mTargetCells[i];
+		mTargetCells[i] = cell;
+	}
+	mTargetCount = aTargetCount;
+
+	if (changed)
+		Rebuild();
+	return changed;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Sample ()
+//-----------------------------------------------------------------------------
+float FlowField::Sample(float aX, float aY, float & aDirX, float & aDirY) const
+{
+	if (!mTargetCount)
+	{
+		aDirX = aDirY = 0.0f;
+		return FLT_MAX;
+	}
+
+	const size_t cell = CellAt(aX, aY);
+	aDirX = kFlowX[mDirection[cell]];
+	aDirY = kFlowY[mDirection[cell]];
+
+	return (float)mDistance[cell] * (float)mCellSize / (float)kStraightCost;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Steer ()
+//-----------------------------------------------------------------------------
+void FlowField::Steer(const float * aX, const float * aY, size_t aCount, float aStep, float aStandOff,
+	float * aAnchorX, float * aAnchorY, JobSystem * aJobs) const
+{
+	static const size_t kGrain = 1024;
+
+	if (!mTargetCount)
+		return;
+
+	ParallelFor(aJobs, aCount, kGrain, [&](size_t aBegin, size_t aEnd, size_t)
+	{
+		for (size_t i = aBegin; i < aEnd; ++i)
+		{
+			float dirX, dirY;
+			if (Sample(aX[i], aY[i], dirX, dirY) > aStandOff)
+			{
+				aAnchorX[i] += dirX * aStep;
+				aAnchorY[i] += dirY * aStep;
+			}
+		}
+	});
+}
+
+//-----------------------------------------------------------------------------
+// Name : CellAt () (Private)
+// Desc : Cell holding (aX, aY), clamped to the grid.
+//-----------------------------------------------------------------------------
+size_t FlowField::CellAt(float aX, float aY) const
+{
+	const float column = (aX - (float)mLeft) / (float)mCellSize;
+	const float row    = (aY - (float)mTop) / (float)mCellSize;
+	const int32_t x = column <= 0.0f ? 0 : std::min((int32_t)column, mColumns - 1);
+	const int32_t y = row <= 0.0f ? 0 : std::min((int32_t)row, mRows - 1);
+
+	return (size_t)y * mColumns + x;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Rebuild () (Private)
+// Desc : Chamfer distance transform from the target cells: a forward pass
+//		takes the neighbours above and to the left, a backward pass the
+//		ones below and to the right. Then every cell points at its
+//		nearest neighbour.
+//-----------------------------------------------------------------------------
+void FlowField::Rebuild()
+{
+	PROFILE_SCOPE("FlowField");
+
+	const size_t cells = (size_t)mColumns * mRows;
+	mDistance.assign(cells, kFar);
+	mDirection.assign(cells, kNoDirection);
+	++mRebuilds;
+
+	if (!mTargetCount)
+		return;
+
+	for (size_t i = 0; i < mTargetCount; ++i)
+		mDistance[mTargetCells[i]] = 0;
+
+	uint16_t * distance = mDistance.data();
+	auto relax = [&](size_t aCell, int32_t aX, int32_t aY, uint32_t aCost)
+	{
+		if (aX < 0 || aX >= mColumns || aY < 0 || aY >= mRows)
+			return;
+
+		const uint32_t through = distance[(size_t)aY * mColumns + aX] + aCost;
+		if (through < distance[aCell])
+			distance[aCell] = (uint16_t)through;
+	};
+
+	for (int32_t y = 0; y < mRows; ++y)
+	{
+		for (int32_t x = 0; x < mColumns; ++x)
+		{
+			const size_t cell = (size_t)y * mColumns + x;
+			relax(cell, x - 1, y,     kStraightCost);
+			relax(cell, x - 1, y - 1, kDiagonalCost);
+			relax(cell, x,     y - 1, kStraightCost);
+			relax(cell, x + 1, y - 1, kDiagonalCost);
+		}
+	}
+
+	for (int32_t y = mRows - 1; y >= 0; --y)
+	{
+		for (int32_t x = mColumns - 1; x >= 0; --x)
+		{
+			const size_t cell = (size_t)y * mColumns + x;
+			relax(cell, x + 1, y,     kStraightCost);
+			relax(cell, x + 1, y + 1, kDiagonalCost);
+			relax(cell, x,     y + 1, kStraightCost);
+			relax(cell, x - 1, y + 1, kDiagonalCost);
+		}
+	}
+
+	for (int32_t y = 0; y < mRows; ++y)
+	{
+		for (int32_t x = 0; x < mColumns; ++x)
+		{
+			const size_t cell = (size_t)y * mColumns + x;
+			uint16_t best = distance[cell];
+
+			for (uint8_t step = 0; step < 8; ++step)
+			{
+				const int32_t nx = x + kStepX[step];
+				const int32_t ny = y + kStepY[step];
+				if (nx < 0 || nx >= mColumns || ny < 0 || ny >= mRows)
+					continue;
+
+				const uint16_t next = distance[(size_t)ny * mColumns + nx];
+				if (next < best)
+				{
+					best = next;
+					mDirection[cell] = step;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,337 @@
+//-----------------------------------------------------------------------------
+// File: Formation.cpp
+//
+// Desc: Movement pattern engine for enemy waves.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Formation Specific Includes
+//-----------------------------------------------------------------------------
+#include "Formation.h"
+#include "VecBatch.h"
+#include "JobSystem.h"
+#include "WorldSnapshot.h"
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+
+//-----------------------------------------------------------------------------
+// FormationPath Factories
+//-----------------------------------------------------------------------------
+FormationPath FormationPath::Hold()
+{
+	FormationPath path = {};
+	path.mType = PATH_HOLD;
+	return path;
+}
+
+FormationPath FormationPath::Sine(float aAmplitudeX, float aAmplitudeY, float aFrequency)
+{
+	FormationPath path = {};
+	path.mType       = PATH_SINE;
+	path.mAmplitudeX = aAmplitudeX;
+	path.mAmplitudeY = aAmplitudeY;
+	path.mFrequency  = aFrequency;
+	return path;
+}
+
+FormationPath FormationPath::Dive(float aDelay, float aAcceleration, float aPeriod,
+                                  float aSway, float aSwayFrequency)
+{
+	FormationPath path = {};
+	path.mType         = PATH_DIVE;
+	path.mDelay        = aDelay;
+	path.mAcceleration = aAcceleration;
+	path.mPeriod       = aPeriod;
+	path.mAmplitudeX   = aSway;
+	path.mFrequency    = aSwayFrequency;
+	return path;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Formation () (Constructor)
+// Desc : Formation Class Constructor
+//-----------------------------------------------------------------------------
+Formation::Formation()
+	: mBucketsDirty(true)
+{
+}
+
+uint16_t Formation::AddPath(const FormationPath & aPath)
+{
+	mPaths.push_back(aPath);
+	mBucketsDirty = true;
+	return (uint16_t)(mPaths.size() - 1);
+}
+
+uint16_t Formation::AddSpline(const float * aPointsX, const float * aPointsY, uint32_t aCount,
+                              float aSegmentsPerSecond)
+{
+	assert(aCount >= 2);
+
+	FormationPath path = {};
+	path.mType       = PATH_SPLINE;
+	path.mFrequency  = aSegmentsPerSecond;
+	path.mFirstPoint = (uint32_t)mPointX.size();
+	path.mPointCount = aCount;
+
+	mPointX.insert(mPointX.end(), aPointsX, aPointsX + aCount);
+	mPointY.insert(mPointY.end(), aPointsY, aPointsY + aCount);
+
+	return AddPath(path);
+}
+
+void Formation::Add(uint16_t aPath, float aSlotX, float aSlotY, float aTimeOffset)
+{
+	assert(aPath < mPaths.size());
+
+	mPath.push_back(aPath);
+	mSlotX.push_back(aSlotX);
+	mSlotY.push_back(aSlotY);
+	mTimeOffset.push_back(aTimeOffset);
+	mBucketsDirty = true;
+}
+
+void Formation::Remove(size_t aIndex)
+{
+	assert(aIndex < mPath.size());
+
+	// Same swap with the last element as EntityStore::Remove.
+	mPath[aIndex]       = mPath.back();
+	mSlotX[aIndex]      = mSlotX.back();
+	mSlotY[aIndex]      = mSlotY.back();
+	mTimeOffset[aIndex] = mTimeOffset.back();
+
+	mPath.pop_back();
+	mSlotX.pop_back();
+	mSlotY.pop_back();
+	mTimeOffset.pop_back();
+	mBucketsDirty = true;
+}
+
+void Formation::Clear()
+{
+	mPath.clear();
+	mSlotX.clear();
+	mSlotY.clear();
+	mTimeOffset.clear();
+	mBucketsDirty = true;
+}
+
+void Formation::SaveState(WorldSnapshot & aSnapshot) const
+{
+	aSnapshot.WriteArray(mPath);
+	aSnapshot.WriteArray(mSlotX);
+	aSnapshot.WriteArray(mSlotY);
+	aSnapshot.WriteArray(mTimeOffset);
+}
+
+bool Formation::LoadState(SnapshotReader & aReader)
+{
+	aReader.ReadArray(mPath);
+	aReader.ReadArray(mSlotX);
+	aReader.ReadArray(mSlotY);
+	aReader.ReadArray(mTimeOffset);
+	mBucketsDirty = true;
+
+	for (uint16_t path : mPath)
+		if (path >= mPaths.size())
+			return false;
+
+	return !aReader.Failed();
+}
+
+void Formation::Reserve(size_t aCount)
+{
+	mPath.reserve(aCount);
+	mSlotX.reserve(aCount);
+	mSlotY.reserve(aCount);
+	mTimeOffset.reserve(aCount);
+}
+
+//-----------------------------------------------------------------------------
+// Name : RebuildBuckets () (Private)
+// Desc : Counting sort of the enemy indices by path id.
+//-----------------------------------------------------------------------------
+void Formation::RebuildBuckets()
+{
+	mBucketStart.assign(mPaths.size() + 1, 0);
+
+	for (uint16_t path : mPath)
+		++mBucketStart[path + 1];
+
+	for (size_t p = 0; p < mPaths.size(); ++p)
+		mBucketStart[p + 1] += mBucketStart[p];
+
+	mOrder.resize(mPath.size());
+
+	mBucketCursor.assign(mBucketStart.begin(), mBucketStart.end() - 1);
+	for (size_t i = 0; i < mPath.size(); ++i)
+		mOrder[mBucketCursor[mPath[i]]++] = (uint32_t)i;
+
+	mBucketsDirty = false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Evaluate ()
+// Desc : Cuts the path ordered enemy list into fixed chunks, regardless of
+//		where the buckets start, so one big bucket still spreads over
+//		every thread.
+//-----------------------------------------------------------------------------
+void Formation::Evaluate(float aTime, float * aX, float * aY, JobSystem * aJobs)
+{
+	static const size_t kGrain = 512;
+
+	if (mBucketsDirty)
+		RebuildBuckets();
+
+	mTime.resize(mOrder.size());
+	mOutX.resize(mOrder.size());
+	mOutY.resize(mOrder.size());
+
+	ParallelFor(aJobs, mOrder.size(), kGrain, [&](size_t aBegin, size_t aEnd, size_t)
+	{
+		EvaluateRange(aBegin, aEnd, aTime, aX, aY);
+	});
+}
+
+//-----------------------------------------------------------------------------
+// Name : EvaluateRange () (Private)
+// Desc : Entries aBegin .. aEnd of mOrder, one batch per path they cover.
+//-----------------------------------------------------------------------------
+void Formation::EvaluateRange(size_t aBegin, size_t aEnd, float aTime, float * aX, float * aY)
+{
+	// Last bucket starting at or before aBegin; that one holds it.
+	size_t p = std::upper_bound(mBucketStart.begin(), mBucketStart.end(), (uint32_t)aBegin) -
+		mBucketStart.begin() - 1;
+
+	while (aBegin < aEnd)
+	{
+		const size_t end = std::min<size_t>(mBucketStart[p + 1], aEnd);
+		if (end > aBegin)
+			EvaluateBucket(mPaths[p], aBegin, end - aBegin, aTime, aX, aY);
+
+		aBegin = end;
+		++p;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : EvaluateBucket () (Private)
+// Desc : aCount enemies on one path, from mOrder[aFirst] on: gather their
+//		clocks, evaluate the path over the whole batch, scatter the results.
+//-----------------------------------------------------------------------------
+void Formation::EvaluateBucket(const FormationPath & aPath, size_t aFirst, size_t aCount,
+                               float aTime, float * aX, float * aY)
+{
+	const uint32_t * indices = &mOrder[aFirst];
+
+	if (aPath.mType == PATH_HOLD)
+	{
+		for (size_t k = 0; k < aCount; ++k)
+		{
+			const uint32_t i = indices[k];
+			aX[i] = mSlotX[i];
+			aY[i] = mSlotY[i];
+		}
+		return;
+	}
+
+	float * time = mTime.data() + aFirst;
+	float * outX = mOutX.data() + aFirst;
+	float * outY = mOutY.data() + aFirst;
+
+	for (size_t k = 0; k < aCount; ++k)
+		time[k] = aTime + mTimeOffset[indices[k]];
+
+	switch (aPath.mType)
+	{
+	case PATH_SINE:
+	{
+		// x = A sin(wt), y = B sin(2wt): a figure eight around the slot.
+		for (size_t k = 0; k < aCount; ++k)
+		{
+			outX[k] = time[k] * aPath.mFrequency;
+			outY[k] = time[k] * aPath.mFrequency * 2.0f;
+		}
+
+		VecBatch::Sin(outX, outX, aCount);
+		VecBatch::Sin(outY, outY, aCount);
+
+		for (size_t k = 0; k < aCount; ++k)
+		{
+			outX[k] *= aPath.mAmplitudeX;
+			outY[k] *= aPath.mAmplitudeY;
+		}
+		break;
+	}
+
+	case PATH_DIVE:
+	{
+		// Time into the current dive, 0 while still waiting on the slot.
+		const float invPeriod = 1.0f / aPath.mPeriod;
+		for (size_t k = 0; k < aCount; ++k)
+		{
+			float t = time[k] - aPath.mDelay;
+			t = t > 0.0f ? t : 0.0f;
+			time[k] = t - aPath.mPeriod * floorf(t * invPeriod);
+		}
+
+		for (size_t k = 0; k < aCount; ++k)
+		{
+			outX[k] = time[k] * aPath.mFrequency;
+			outY[k] = 0.5f * aPath.mAcceleration * time[k] * time[k];
+		}
+
+		VecBatch::Sin(outX, outX, aCount);
+
+		for (size_t k = 0; k < aCount; ++k)
+			outX[k] *= aPath.mAmplitudeX;
+		break;
+	}
+
+	case PATH_SPLINE:
+	{
+		const float * pointX = &mPointX[aPath.mFirstPoint];
+		const float * pointY = &mPointY[aPath.mFirstPoint];
+		const int     points = (int)aPath.mPointCount;
+
+		for (size_t k = 0; k < aCount; ++k)
+		{
+			const float u       = time[k] * aPath.mFrequency;
+			const float segment = floorf(u);
+			const float f       = u - segment;
+
+			int i1 = (int)segment % points;
+			if (i1 < 0)
+				i1 += points;
+
+			const int i0 = (i1 + points - 1) % points;
+			const int i2 = (i1 + 1) % points;
+			const int i3 = (i1 + 2) % points;
+
+			// Catmull-Rom weights.
+			const float f2 = f * f;
+			const float f3 = f2 * f;
+			const float w0 = -0.5f * f3 + f2 - 0.5f * f;
+			const float w1 =  1.5f * f3 - 2.5f * f2 + 1.0f;
+			const float w2 = -1.5f * f3 + 2.0f * f2 + 0.5f * f;
+			const float w3 =  0.5f * f3 - 0.5f * f2;
+
+			outX[k] = w0 * pointX[i0] + w1 * pointX[i1] + w2 * pointX[i2] + w3 * pointX[i3];
+			outY[k] = w0 * pointY[i0] + w1 * pointY[i1] + w2 * pointY[i2] + w3 * pointY[i3];
+		}
+		break;
+	}
+
+	default:
+		break;
+	}
+
+	for (size_t k = 0; k < aCount; ++k)
+	{
+		const uint32_t i = indices[k];
+		aX[i] = mSlotX[i] + outX[k];
+		aY[i] = mSlotY[i] + outY[k];
+	}
+}
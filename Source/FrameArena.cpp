@@ -0,0 +1,74 @@
+//-----------------------------------------------------------------------------
+// File: FrameArena.cpp
+//
+// Desc: Linear allocator for memory that only lives until the end of the
+//	   frame.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// FrameArena Specific Includes
+//-----------------------------------------------------------------------------
+#include "FrameArena.h"
+#include <assert.h>
+#include <new>
+
+FrameArena::FrameArena(size_t aCapacity)
+	: mBlock(static_cast<uint8_t *>(::operator new(aCapacity)))
+	, mCapacity(aCapacity)
+	, mUsed(0)
+	, mHighWater(0)
+	, mOverflows(0)
+{
+}
+
+FrameArena::~FrameArena()
+{
+	::operator delete(mBlock);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Allocate ()
+// Desc : Bumps the offset past an aligned aSize bytes. aAlignment must be a
+//		power of two.
+//-----------------------------------------------------------------------------
+void * FrameArena::Allocate(size_t aSize, size_t aAlignment)
+{
+	assert((aAlignment & (aAlignment - 1)) == 0);
+
+	const uintptr_t base    = reinterpret_cast<uintptr_t>(mBlock);
+	const uintptr_t aligned = (base + mUsed + aAlignment - 1) & ~(uintptr_t)(aAlignment - 1);
+	const size_t    end     = (size_t)(aligned - base) + aSize;
+
+	if (end > mCapacity)
+	{
+		++mOverflows;
+		return ::operator new(aSize);
+	}
+
+	mUsed = end;
+	if (mUsed > mHighWater)
+		mHighWater = mUsed;
+
+	return reinterpret_cast<void *>(aligned);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Deallocate ()
+// Desc : Arena memory waits for the reset; heap fallbacks are freed now.
+//-----------------------------------------------------------------------------
+void FrameArena::Deallocate(void * aPointer)
+{
+	if (aPointer && !Owns(aPointer))
+		::operator delete(aPointer);
+}
+
+void FrameArena::Reset()
+{
+	mUsed = 0;
+}
+
+bool FrameArena::Owns(const void * aPointer) const
+{
+	const uint8_t * pointer = static_cast<const uint8_t *>(aPointer);
+	return pointer >= mBlock && pointer < mBlock + mCapacity;
+}
@@ -0,0 +1,476 @@
+//-----------------------------------------------------------------------------
+// File: GameWorld.cpp
+//
+// Desc: The simulated game, a fixed tick at a time.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// GameWorld Specific Includes
+//-----------------------------------------------------------------------------
+#include "GameWorld.h"
+#include <assert.h>
+#include "Profiler.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const float GameWorld::kTickTime = 1.0f / 60.0f;
+const int32_t GameWorld::kPlayWidth;
+const int32_t GameWorld::kPlayHeight;
+
+static const size_t kMaxPlayerBullets = 256;
+static const float  kBombInterval     = 3.0f;	// Seconds between bombs
+
+//-----------------------------------------------------------------------------
+// Name : GameWorld () (Constructor)
+// Desc : Builds the planes and the enemy group; nothing moves until the
+//		waves are loaded.
+//-----------------------------------------------------------------------------
+GameWorld::GameWorld(IPlatform & aPlatform, SpriteBank & aSprites, FrameArena & aFrameArena, JobSystem * aJobs,
+	int aPlayerCount, uint64_t aSeed, size_t aEnemyBullets)
+	: mPlatform(aPlatform)
+	, mSprites(aSprites)
+	, mFrameArena(aFrameArena)
+	, mJobs(aJobs)
+	, mPlayerCount(aPlayerCount)
+	, mEnemyGroup(&aSprites, aSeed, aEnemyBullets)
+{
+	assert(aPlayerCount >= 1 && aPlayerCount <= kMaxPlayers);
+
+	for (int player = 0; player < kMaxPlayers; ++player)
+	{
+		mBombCooldown[player] = 0.0f;
+		mBeamActive[player]   = false;
+	}
+
+	for (int player = 0; player < mPlayerCount; ++player)
+	{
+		mBullets[player].reset(new ProjectilePool(kMaxPlayerBullets));
+		mPlayers[player].reset(new CPlayer(&mSprites, *mBullets[player], &mPlatform));
+	}
+
+	// Only these layer pairs are ever tested against each other.
+	CollisionMatrix & matrix = mBroadphase.Matrix();
+	matrix.DisableAll();
+	matrix.Enable(LAYER_PLAYER_BULLET, LAYER_ENEMY);
+	matrix.Enable(LAYER_PLAYER, LAYER_ENEMY_BULLET);
+	matrix.Enable(LAYER_PLAYER, LAYER_PICKUP);
+}
+
+bool GameWorld::LoadWaves(const char * szFileName, std::string & aError)
+{
+	if (!mEnemyGroup.LoadWaves(mPlatform, szFileName, aError))
+		return false;
+
+	KeepStartState();
+	return true;
+}
+
+void GameWorld::SetWaves(const WaveScript & aScript)
+{
+	mEnemyGroup.SetWaves(aScript);
+	KeepStartState();
+}
+
+//-----------------------------------------------------------------------------
+// Name : KeepStartState () (Private)
+// Desc : Places the planes and keeps the world as it is now for Restart.
+//-----------------------------------------------------------------------------
+void GameWorld::KeepStartState()
+{
+	for (int player = 0; player < mPlayerCount; ++player)
+		mPlayers[player]->Teleport(SpawnPoint(player));
+
+	SaveWorld(mStartState);
+}
+
+void GameWorld::Restart()
+{
+	const bool restored = RestoreWorld(mStartState);
+	assert(restored);
+	(void)restored;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SimulateTick ()
+// Desc : Advances the game by one fixed tick. Everything that affects the
+//		outcome happens here and depends only on the buttons and the seed.
+//-----------------------------------------------------------------------------
+void GameWorld::SimulateTick(uint16_t aButtons, uint16_t aSecondButtons)
+{
+	PROFILE_SCOPE("Tick");
+
+	// Restarting takes the whole tick; either player may ask
+	if ((aButtons | aSecondButtons) & INPUT_RESTART)
+	{
+		Restart();
+		return;
+	}
+
+	// The world stands still from the tick the last plane went down
+	if (IsGameOver())
+		return;
+
+	ApplyInputs(aButtons, aSecondButtons);
+	AnimateObjects(kTickTime);
+	ResolveCollisions();
+}
+
+void GameWorld::ApplyInputs(uint16_t aButtons, uint16_t aSecondButtons)
+{
+	for (int player = 0; player < mPlayerCount; ++player)
+	{
+		mBombCooldown[player] -= kTickTime;
+		ApplyInput(player, player ? aSecondButtons : aButtons, kTickTime);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : ApplyInput () (Private)
+// Desc : Performs one player's actions for one tick's buttons.
+//-----------------------------------------------------------------------------
+void GameWorld::ApplyInput(int aPlayer, uint16_t aButtons, float aTimeStep)
+{
+	CPlayer * player    = mPlayers[aPlayer].get();
+	uint32_t  direction = 0;
+
+	if (aButtons & INPUT_UP)    direction |= CPlayer::DIRECTION::DIR_FORWARD;
+	if (aButtons & INPUT_DOWN)  direction |= CPlayer::DIRECTION::DIR_BACKWARD;
+	if (aButtons & INPUT_LEFT)  direction |= CPlayer::DIRECTION::DIR_LEFT;
+	if (aButtons & INPUT_RIGHT) direction |= CPlayer::DIRECTION::DIR_RIGHT;
+
+	player->Move(direction, aTimeStep);
+
+	if (aButtons & INPUT_ROTATE_LEFT)  player->RotateLeft();
+	if (aButtons & INPUT_ROTATE_RIGHT) player->RotateRight();
+	if (aButtons & INPUT_FIRE) player->Shoot();
+	if (aButtons & INPUT_BOMB) DetonateBomb(aPlayer);
+
+	if (aButtons & INPUT_SELF_DESTRUCT)
+	{
+		player->DecreaseLives();
+		player->Explode();
+	}
+
+	// The beam costs one ray query per tick while held.
+	mBeamActive[aPlayer] = (aButtons & INPUT_BEAM) && !player->IsExploding();
+	if (mBeamActive[aPlayer])
+		FireBeam(aPlayer);
+}
+
+//-----------------------------------------------------------------------------
+// Name : AnimateObjects ()
+// Desc : Moves the planes, the enemies and every bullet by one time step.
+//-----------------------------------------------------------------------------
+void GameWorld::AnimateObjects(float aTimeStep)
+{
+	PROFILE_SCOPE("Animate");
+
+	// Fixed bounds, never the window's: peers and replays must agree on them
+	for (int player = 0; player < mPlayerCount; ++player)
+		mPlayers[player]->Update(aTimeStep, 0, 0, kPlayWidth, kPlayHeight);
+
+	// Chasing waves go after whichever plane is still flying
+	Vec2   targets[kMaxPlayers];
+	size_t targetCount = 0;
+	for (int player = 0; player < mPlayerCount; ++player)
+		if (mPlayers[player]->GetLives() > 0)
+			targets[targetCount++] = mPlayers[player]->Position();
+	mEnemyGroup.SetTargets(targets, targetCount);
+
+	mEnemyGroup.Update(aTimeStep, 0, 0, kPlayWidth, kPlayHeight, mJobs);
+}
+
+//-----------------------------------------------------------------------------
+// Name : ResolveCollisions ()
+// Desc : One broadphase pass per player: each has its own layers for its
+//		plane and its bullets, and is credited with its own kills.
+//-----------------------------------------------------------------------------
+void GameWorld::ResolveCollisions()
+{
+	PROFILE_SCOPE("Collision");
+
+	for (int player = 0; player < mPlayerCount; ++player)
+		ResolvePlayerCollisions(player);
+}
+
+//-----------------------------------------------------------------------------
+// Name : ResolvePlayerCollisions () (Private)
+// Desc : Runs the layered broadphase for one player against the enemies
+//		and resolves the candidate pairs with the per pixel mask tests.
+//-----------------------------------------------------------------------------
+void GameWorld::ResolvePlayerCollisions(int aPlayer)
+{
+	CPlayer * player = mPlayers[aPlayer].get();
+	ProjectilePool & firedBullets = *mBullets[aPlayer];
+
+	mBroadphase.ClearLayers();
+	player->AddColliders(mBroadphase);
+	mEnemyGroup.AddColliders(mBroadphase);
+
+	mBroadphase.FindPairs(mCollisionPairs, mJobs);
+	if (mCollisionPairs.empty())
+		return;
+
+	// Scratch for this tick only, from the frame arena.
+	const ArenaAllocator<char> frameAllocator(mFrameArena);
+
+	// The mask tests only read, so they all run up front in parallel; the
+	// results are then applied one pair at a time, in pair order.
+	ArenaVector<int> hits(mCollisionPairs.size(), -1, frameAllocator);
+	ParallelFor(mJobs, mCollisionPairs.size(), 256, [&](size_t aBegin, size_t aEnd, size_t)
+	{
+		for (size_t i = aBegin; i < aEnd; ++i)
+		{
+			const CollisionPair & pair = mCollisionPairs[i];
+			if (pair.mFirstLayer == LAYER_PLAYER_BULLET && pair.mSecondLayer == LAYER_ENEMY)
+				hits[i] = mEnemyGroup.TestHit(pair.mSecond, firedBullets.Entities(), pair.mFirst);
+			else if (pair.mFirstLayer == LAYER_PLAYER && pair.mSecondLayer == LAYER_ENEMY_BULLET)
+				hits[i] = player->IsShot(mEnemyGroup.GetBullets(), pair.mSecond) ? 0 : -1;
+		}
+	});
+
+	ArenaVector<char> usedBullets(firedBullets.Size(), 0, frameAllocator);
+	ArenaVector<char> deadEnemies(mEnemyGroup.GetEnemyCount(), 0, frameAllocator);
+	ArenaVector<SlotHandle> killed(frameAllocator);
+	ArenaVector<ProjectileHandle> spent(frameAllocator);
+	killed.reserve(mCollisionPairs.size());
+	spent.reserve(mCollisionPairs.size());
+	bool playerShot = false;
+
+	for (size_t i = 0; i < mCollisionPairs.size(); ++i)
+	{
+		const CollisionPair & pair = mCollisionPairs[i];
+		if (pair.mFirstLayer == LAYER_PLAYER_BULLET && pair.mSecondLayer == LAYER_ENEMY)
+		{
+			// A bullet hits at most one enemy, an enemy dies once. Bosses
+			// absorb bullets part by part until nothing is left.
+			if (usedBullets[pair.mFirst] || deadEnemies[pair.mSecond])
+				continue;
+
+			bool destroyed = false;
+			if (mEnemyGroup.ApplyHit(pair.mSecond, firedBullets.Entities(), pair.mFirst, hits[i], destroyed))
+			{
+				usedBullets[pair.mFirst] = 1;
+				spent.push_back(firedBullets.HandleAt(pair.mFirst));
+			}
+
+			if (destroyed)
+			{
+				deadEnemies[pair.mSecond] = 1;
+				player->AddScore(mEnemyGroup.GetScoreValue(pair.mSecond));
+				killed.push_back(mEnemyGroup.GetEnemyHandle(pair.mSecond));
+			}
+		}
+		else if (pair.mFirstLayer == LAYER_PLAYER && pair.mSecondLayer == LAYER_ENEMY_BULLET)
+		{
+			if (hits[i] >= 0)
+				playerShot = true;
+		}
+	}
+
+	// Handles stay valid while the others are removed, so each removal is O(1).
+	mEnemyGroup.RemoveEnemies(killed.data(), killed.size());
+	for (const ProjectileHandle & bullet : spent)
+		firedBullets.Release(bullet);
+
+	if (playerShot)
+	{
+		player->DecreaseLives();
+		player->Explode();
+
+		player->Teleport(SpawnPoint(aPlayer));
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : FireBeam () (Private)
+// Desc : Instant-hit beam along the player's facing direction; it stops at
+//		the first opaque enemy pixel (or live boss part) and damages it.
+//-----------------------------------------------------------------------------
+void GameWorld::FireBeam(int aPlayer)
+{
+	static const float kBeamRange = 1000.0f;
+
+	CPlayer * player = mPlayers[aPlayer].get();
+	Vec2 & beamStart = mBeamStart[aPlayer];
+	Vec2 & beamEnd   = mBeamEnd[aPlayer];
+
+	Vec2 direction = player->GetFacingVector();
+	beamStart = player->Position();
+
+	RayHit hit;
+	int part;
+	if (mEnemyGroup.Raycast(beamStart, direction, kBeamRange, hit, part))
+	{
+		beamEnd = Vec2((double)hit.mX, (double)hit.mY);
+
+		if (mEnemyGroup.DamageEnemyPart(hit.mIndex, part, 1))
+		{
+			player->AddScore(mEnemyGroup.GetScoreValue(hit.mIndex));
+
+			const SlotHandle killed = mEnemyGroup.GetEnemyHandle(hit.mIndex);
+			mEnemyGroup.RemoveEnemies(&killed, 1);
+		}
+	}
+	else
+	{
+		beamEnd = beamStart + direction * kBeamRange;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : DetonateBomb () (Private)
+// Desc : Area damage around the player, found with one radius query.
+//-----------------------------------------------------------------------------
+void GameWorld::DetonateBomb(int aPlayer)
+{
+	static const float kBombRadius = 150.0f;
+	static const int   kBombDamage = 2;
+
+	CPlayer * player = mPlayers[aPlayer].get();
+	if (player->IsExploding() || mBombCooldown[aPlayer] > 0.0f)
+		return;
+	mBombCooldown[aPlayer] = kBombInterval;
+
+	mEnemyGroup.FindEnemiesInRadius(player->Position(), kBombRadius, mBombTargets);
+
+	const ArenaAllocator<SlotHandle> frameAllocator(mFrameArena);
+	ArenaVector<SlotHandle> killed(frameAllocator);
+	killed.reserve(mBombTargets.size());
+	for (size_t enemy : mBombTargets)
+	{
+		if (mEnemyGroup.DamageEnemy(enemy, player->Position(), kBombDamage))
+		{
+			player->AddScore(mEnemyGroup.GetScoreValue(enemy));
+			killed.push_back(mEnemyGroup.GetEnemyHandle(enemy));
+		}
+	}
+	mEnemyGroup.RemoveEnemies(killed.data(), killed.size());
+}
+
+//-----------------------------------------------------------------------------
+// Name : Draw ()
+// Desc : The planes (each with its bullets), then the enemies.
+//-----------------------------------------------------------------------------
+void GameWorld::Draw(float aAlpha)
+{
+	for (int player = 0; player < mPlayerCount; ++player)
+		mPlayers[player]->Draw(aAlpha);
+
+	mEnemyGroup.Draw(aAlpha);
+}
+
+bool GameWorld::IsGameOver() const
+{
+	for (int player = 0; player < mPlayerCount; ++player)
+		if (mPlayers[player]->GetLives() > 0)
+			return false;
+
+	return true;
+}
+
+uint64_t GameWorld::Hash() const
+{
+	WorldSnapshot snapshot;
+	SaveWorld(snapshot);
+	return snapshot.Hash();
+}
+
+//-----------------------------------------------------------------------------
+// Name : SpawnPoint () (Private)
+// Desc : Where a plane starts, and comes back after being shot down.
+//-----------------------------------------------------------------------------
+Vec2 GameWorld::SpawnPoint(int aPlayer) const
+{
+	if (mPlayerCount == 1)
+		return Vec2(400, 400);
+
+	return Vec2(aPlayer ? 550 : 250, 400);
+}
+
+//-----------------------------------------------------------------------------
+// Name : SaveWorld () (Private)
+// Desc : Captures everything a tick can change into aSnapshot. A few
+//		copies of the live arrays: cheap enough to take every tick.
+//-----------------------------------------------------------------------------
+void GameWorld::SaveWorld(WorldSnapshot & aSnapshot) const
+{
+	aSnapshot.Clear();
+
+	for (int player = 0; player < mPlayerCount; ++player)
+	{
+		mPlayers[player]->SaveState(aSnapshot);
+		mBullets[player]->SaveState(aSnapshot);
+	}
+	mEnemyGroup.SaveState(aSnapshot);
+
+	for (int player = 0; player < mPlayerCount; ++player)
+	{
+		aSnapshot.Write(mBombCooldown[player]);
+		aSnapshot.Write((uint8_t)mBeamActive[player]);
+		aSnapshot.Write(mBeamStart[player].x);
+		aSnapshot.Write(mBeamStart[player].y);
+		aSnapshot.Write(mBeamEnd[player].x);
+		aSnapshot.Write(mBeamEnd[player].y);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : RestoreWorld () (Private)
+// Desc : Puts the world back the way SaveWorld found it. False if the
+//		snapshot does not fit this game (another wave script, truncated).
+//-----------------------------------------------------------------------------
+bool GameWorld::RestoreWorld(const WorldSnapshot & aSnapshot)
+{
+	PROFILE_SCOPE("Restore");
+
+	SnapshotReader reader(aSnapshot);
+
+	for (int player = 0; player < mPlayerCount; ++player)
+	{
+		if (!mPlayers[player]->LoadState(reader)) return false;
+		if (!mBullets[player]->LoadState(reader)) return false;
+	}
+	if (!mEnemyGroup.LoadState(reader)) return false;
+
+	for (int player = 0; player < mPlayerCount; ++player)
+	{
+		uint8_t beamActive = 0;
+		reader.Read(mBombCooldown[player]);
+		reader.Read(beamActive);
+		reader.Read(mBeamStart[player].x);
+		reader.Read(mBeamStart[player].y);
+		reader.Read(mBeamEnd[player].x);
+		reader.Read(mBeamEnd[player].y);
+		mBeamActive[player] = beamActive != 0;
+	}
+
+	return !reader.Failed() && reader.AtEnd();
+}
+
+void GameWorld::SaveState(WorldSnapshot & aSnapshot)
+{
+	SaveWorld(aSnapshot);
+}
+
+bool GameWorld::LoadState(const WorldSnapshot & aSnapshot)
+{
+	return RestoreWorld(aSnapshot);
+}
+
+//-----------------------------------------------------------------------------
+// Name : SimulateTick () (IRollbackWorld)
+// Desc : A networked tick. Re-simulated ones are not heard again, and
+//		each gets the whole frame arena, since a rollback can run several
+//		in one frame.
+//-----------------------------------------------------------------------------
+void GameWorld::SimulateTick(const uint16_t aButtons[], bool aReplaying)
+{
+	mPlatform.SetAudioMuted(aReplaying);
+	SimulateTick(aButtons[0], mPlayerCount > 1 ? aButtons[1] : 0);
+	mPlatform.SetAudioMuted(false);
+
+	if (aReplaying)
+		mFrameArena.Reset();
+}
@@ -15,6 +15,8 @@ CImageFile::CImageFile() : height(m_biInfo.biHeight), width(m_biInfo.biWidth)
 
 bool CImageFile::LoadBitmapFromFile(const char *szFileName, HDC hdc)
 {
+	PROFILE_SCOPE("LoadBitmap");
+
 	BYTE *pData;
 	HDC mdc = CreateCompatibleDC(hdc);
 
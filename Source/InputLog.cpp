@@ -0,0 +1,176 @@
+//-----------------------------------------------------------------------------
+// File: InputLog.cpp
+//
+// Desc: Bit packed per tick input record.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// InputLog Specific Includes
+//-----------------------------------------------------------------------------
+#include "InputLog.h"
+#include <string.h>
+#include "Platform.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+static const char     kMagic[4] = { 'S', 'S', 'I', 'L' };
+static const uint32_t kVersion  = 3;
+
+// Room for a long session up front, so recording does not reallocate
+// mid game (a change costs 11 bits, an unchanged tick 1).
+static const size_t   kReservedBytes = 256 * 1024;
+
+// On disk layout, followed by mByteCount bytes of packed ticks.
+struct InputLogHeader
+{
+	char     mMagic[4];
+	uint32_t mVersion;
+	uint64_t mSeed;
+	uint32_t mTickCount;
+	uint32_t mByteCount;
+	uint32_t mHasOutcome;
+	uint32_t mOutcomeScore;
+	uint64_t mOutcomeHash;
+};
+
+//-----------------------------------------------------------------------------
+// Name : InputLog () (Constructor)
+// Desc : InputLog Class Constructor
+//-----------------------------------------------------------------------------
+InputLog::InputLog()
+{
+	Clear(0);
+}
+
+void InputLog::Clear(uint64_t aSeed)
+{
+	mBytes.clear();
+	mBytes.reserve(kReservedBytes);
+	mBitCount     = 0;
+	mSeed         = aSeed;
+	mTickCount    = 0;
+	mLastRecorded = 0;
+	mHasOutcome   = false;
+	mOutcomeScore = 0;
+	mOutcomeHash  = 0;
+
+	Rewind();
+}
+
+void InputLog::SetOutcome(uint32_t aScore, uint64_t aStateHash)
+{
+	mHasOutcome   = true;
+	mOutcomeScore = aScore;
+	mOutcomeHash  = aStateHash;
+}
+
+void InputLog::Record(uint16_t aButtons)
+{
+	if (aButtons == mLastRecorded)
+	{
+		WriteBits(0, 1);
+	}
+	else
+	{
+		WriteBits(1, 1);
+		WriteBits(aButtons, kInputButtonBits);
+		mLastRecorded = aButtons;
+	}
+
+	++mTickCount;
+}
+
+void InputLog::Rewind()
+{
+	mReadBit  = 0;
+	mReadTick = 0;
+	mLastRead = 0;
+}
+
+bool InputLog::Read(uint16_t & aButtons)
+{
+	if (mReadTick == mTickCount)
+		return false;
+
+	if (ReadBits(1))
+		mLastRead = (uint16_t)ReadBits(kInputButtonBits);
+
+	aButtons = mLastRead;
+	++mReadTick;
+	return true;
+}
+
+bool InputLog::SaveToFile(IPlatform & aPlatform, const char * szFileName) const
+{
+	InputLogHeader header;
+	memcpy(header.mMagic, kMagic, sizeof(kMagic));
+	header.mVersion   = kVersion;
+	header.mSeed      = mSeed;
+	header.mTickCount = mTickCount;
+	header.mByteCount = (uint32_t)mBytes.size();
+	header.mHasOutcome   = mHasOutcome ? 1 : 0;
+	header.mOutcomeScore = mOutcomeScore;
+	header.mOutcomeHash  = mOutcomeHash;
+
+	std::vector<uint8_t> file(sizeof(header) + mBytes.size());
+	memcpy(file.data(), &header, sizeof(header));
+	if (!mBytes.empty())
+		memcpy(file.data() + sizeof(header), mBytes.data(), mBytes.size());
+
+	return aPlatform.SaveFile(szFileName, file.data(), file.size());
+}
+
+bool InputLog::LoadFromFile(IPlatform & aPlatform, const char * szFileName)
+{
+	std::vector<uint8_t> file;
+	if (!aPlatform.LoadFile(szFileName, file) || file.size() < sizeof(InputLogHeader))
+		return false;
+
+	InputLogHeader header;
+	memcpy(&header, file.data(), sizeof(header));
+	if (memcmp(header.mMagic, kMagic, sizeof(kMagic)) != 0 || header.mVersion != kVersion ||
+		file.size() - sizeof(header) < header.mByteCount)
+		return false;
+
+	std::vector<uint8_t> bytes(file.begin() + sizeof(header), file.begin() + sizeof(header) + header.mByteCount);
+
+	// Every tick takes at least one bit.
+	if ((uint64_t)header.mTickCount > (uint64_t)bytes.size() * 8)
+		return false;
+
+	Clear(header.mSeed);
+	mBytes.swap(bytes);
+	mBitCount  = mBytes.size() * 8;
+	mTickCount = header.mTickCount;
+	mHasOutcome   = header.mHasOutcome != 0;
+	mOutcomeScore = header.mOutcomeScore;
+	mOutcomeHash  = header.mOutcomeHash;
+	return true;
+}
+
+void InputLog::WriteBits(uint32_t aValue, int aCount)
+{
+	for (int i = 0; i < aCount; ++i, ++mBitCount)
+	{
+		if ((mBitCount & 7) == 0)
+			mBytes.push_back(0);
+
+		if (aValue & (1u << i))
+			mBytes.back() |= (uint8_t)(1u << (mBitCount & 7));
+	}
+}
+
+uint32_t InputLog::ReadBits(int aCount)
+{
+	uint32_t value = 0;
+
+	// A truncated log reads as zeros rather than past the end.
+	for (int i = 0; i < aCount && mReadBit < mBitCount; ++i, ++mReadBit)
+	{
+		if (mBytes[mReadBit >> 3] & (1u << (mReadBit & 7)))
+			value |= 1u << i;
+	}
+
+	return value;
+}
@@ -0,0 +1,67 @@
+//-----------------------------------------------------------------------------
+// File: InputQueue.cpp
+//
+// Desc: Single producer, single consumer ring of timestamped key events.
+//
+//	   Head and tail count up forever and are masked into the ring, so
+//	   head - tail is the number of queued events even across wrap around.
+//	   Each side publishes its counter with a release store after touching
+//	   the slot, and reads the other side's with an acquire load.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// InputQueue Specific Includes
+//-----------------------------------------------------------------------------
+#include "InputQueue.h"
+
+static_assert((InputQueue::kCapacity & (InputQueue::kCapacity - 1)) == 0,
+	"InputQueue capacity must be a power of two");
+
+InputQueue::InputQueue()
+	: mHead(0)
+	, mTail(0)
+	, mDropped(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Push ()
+// Desc : Appends an event; false (and a counted drop) when full.
+//-----------------------------------------------------------------------------
+bool InputQueue::Push(const InputEvent & aEvent)
+{
+	const uint32_t head = mHead.load(std::memory_order_relaxed);
+	if (head - mTail.load(std::memory_order_acquire) >= kCapacity)
+	{
+		mDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	mEvents[head & (kCapacity - 1)] = aEvent;
+	mHead.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+bool InputQueue::Peek(InputEvent & aEvent) const
+{
+	const uint32_t tail = mTail.load(std::memory_order_relaxed);
+	if (tail == mHead.load(std::memory_order_acquire))
+		return false;
+
+	aEvent = mEvents[tail & (kCapacity - 1)];
+	return true;
+}
+
+bool InputQueue::Pop(InputEvent & aEvent)
+{
+	if (!Peek(aEvent))
+		return false;
+
+	mTail.store(mTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	return true;
+}
+
+uint32_t InputQueue::Size() const
+{
+	return mHead.load(std::memory_order_acquire) - mTail.load(std::memory_order_acquire);
+}
@@ -0,0 +1,248 @@
+//-----------------------------------------------------------------------------
+// File: JobSystem.cpp
+//
+// Desc: Worker threads, the work-stealing queues and the join.
+//
+//	   Workers sleep on a condition variable between loops. Once woken they
+//	   run chunks from their own queue, steal when it is empty and spin
+//	   (yielding) while others finish the last chunks, then sleep again.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// JobSystem Specific Includes
+//-----------------------------------------------------------------------------
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <stdio.h>
+
+//-----------------------------------------------------------------------------
+// Static Member Definitions
+//-----------------------------------------------------------------------------
+const unsigned JobSystem::kAutoWorkers;
+const unsigned JobSystem::kMaxThreads;
+const size_t   JobSystem::WorkQueue::kCapacity;
+thread_local bool JobSystem::tInsideJob = false;
+
+//-----------------------------------------------------------------------------
+// Name : JobSystem () (Constructor)
+// Desc : Starts the workers; kAutoWorkers leaves one hardware thread for
+//		the caller.
+//-----------------------------------------------------------------------------
+JobSystem::JobSystem(unsigned aWorkerCount)
+	: mThreadCount(1)
+	, mQueues()
+	, mFunction(nullptr)
+	, mBody(nullptr)
+	, mCount(0)
+	, mGrain(1)
+	, mRemaining(0)
+	, mGeneration(0)
+	, mShutdown(false)
+{
+	if (aWorkerCount == kAutoWorkers)
+	{
+		const unsigned hardware = std::thread::hardware_concurrency();
+		aWorkerCount = hardware > 1 ? hardware - 1 : 0;
+	}
+	if (aWorkerCount > kMaxThreads - 1)
+		aWorkerCount = kMaxThreads - 1;
+
+	mThreadCount = aWorkerCount + 1;
+	mQueues.reset(new WorkQueue[mThreadCount]);
+
+	mWorkers.reserve(aWorkerCount);
+	for (unsigned i = 0; i < aWorkerCount; ++i)
+		mWorkers.push_back(std::thread(&JobSystem::WorkerMain, this, i + 1));
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~JobSystem () (Destructor)
+// Desc : Wakes every worker to exit and waits for them.
+//-----------------------------------------------------------------------------
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(mWakeLock);
+		mShutdown = true;
+	}
+	mWake.notify_all();
+
+	for (std::thread & worker : mWorkers)
+		worker.join();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Run () (Private)
+// Desc : Publishes the loop, wakes the workers and joins in until every
+//		chunk has run.
+//-----------------------------------------------------------------------------
+void JobSystem::Run(size_t aCount, size_t aGrain, size_t aChunks, ChunkFunction aFunction, const void * aBody)
+{
+	mFunction = aFunction;
+	mBody     = aBody;
+	mCount    = aCount;
+	mGrain    = aGrain;
+	mRemaining.store(aChunks, std::memory_order_release);
+
+	ChunkRange all;
+	all.mFirst = 0;
+	all.mLast  = aChunks;
+	Push(0, all);
+
+	{
+		std::lock_guard<std::mutex> lock(mWakeLock);
+		++mGeneration;
+	}
+	mWake.notify_all();
+
+	tInsideJob = true;
+	Work(0);
+	tInsideJob = false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WorkerMain () (Private)
+// Desc : Worker thread body: sleep until a loop is published, help finish
+//		it, keep an eye out for the next one for a moment, then sleep.
+//-----------------------------------------------------------------------------
+void JobSystem::WorkerMain(unsigned aQueue)
+{
+	static const int kSpinsBeforeSleep = 256;
+
+	char name[32];
+	snprintf(name, sizeof(name), "Worker %u", aQueue);
+	Profiler::SetThreadName(name);
+
+	tInsideJob = true;
+	uint64_t seen = 0;
+
+	for (;;)
+	{
+		// Back to back loops (one per system every tick) usually arrive
+		// before the worker would have fallen asleep.
+		for (int spin = 0; spin < kSpinsBeforeSleep; ++spin)
+		{
+			if (mRemaining.load(std::memory_order_acquire) != 0)
+			{
+				Work(aQueue);
+				spin = 0;
+			}
+			std::this_thread::yield();
+		}
+
+		std::unique_lock<std::mutex> lock(mWakeLock);
+		mWake.wait(lock, [&] { return mShutdown || mGeneration != seen; });
+		if (mShutdown)
+			return;
+		seen = mGeneration;
+		lock.unlock();
+
+		Work(aQueue);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Work () (Private)
+// Desc : Runs chunks, own queue first, then stolen, until none are left
+//		unfinished.
+//-----------------------------------------------------------------------------
+void JobSystem::Work(unsigned aQueue)
+{
+	PROFILE_SCOPE("Jobs");
+
+	while (mRemaining.load(std::memory_order_acquire) != 0)
+	{
+		ChunkRange range;
+		if (Pop(aQueue, range) || Steal(aQueue, range))
+			Execute(aQueue, range);
+		else
+			std::this_thread::yield();
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Execute () (Private)
+// Desc : Forks the upper halves of aRange onto this thread's queue until
+//		one chunk is left, then runs it.
+//-----------------------------------------------------------------------------
+void JobSystem::Execute(unsigned aQueue, ChunkRange aRange)
+{
+	while (aRange.mLast - aRange.mFirst > 1)
+	{
+		ChunkRange upper;
+		upper.mFirst = aRange.mFirst + (aRange.mLast - aRange.mFirst) / 2;
+		upper.mLast  = aRange.mLast;
+		if (!Push(aQueue, upper))
+			break;
+		aRange.mLast = upper.mFirst;
+	}
+
+	for (size_t chunk = aRange.mFirst; chunk < aRange.mLast; ++chunk)
+	{
+		const size_t begin = chunk * mGrain;
+		const size_t end   = begin + mGrain < mCount ? begin + mGrain : mCount;
+		mFunction(mBody, begin, end, chunk);
+	}
+
+	mRemaining.fetch_sub(aRange.mLast - aRange.mFirst, std::memory_order_acq_rel);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Push () (Private)
+// Desc : Adds a range at the newest end of a queue. False if it is full,
+//		in which case the caller keeps the range.
+//-----------------------------------------------------------------------------
+bool JobSystem::Push(unsigned aQueue, const ChunkRange & aRange)
+{
+	WorkQueue & queue = mQueues[aQueue];
+	std::lock_guard<std::mutex> lock(queue.mLock);
+
+	if (queue.mTail - queue.mHead == WorkQueue::kCapacity)
+		return false;
+
+	queue.mRanges[queue.mTail % WorkQueue::kCapacity] = aRange;
+	++queue.mTail;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Pop () (Private)
+// Desc : The owner takes back its most recently forked range.
+//-----------------------------------------------------------------------------
+bool JobSystem::Pop(unsigned aQueue, ChunkRange & aRange)
+{
+	WorkQueue & queue = mQueues[aQueue];
+	std::lock_guard<std::mutex> lock(queue.mLock);
+
+	if (queue.mTail == queue.mHead)
+		return false;
+
+	--queue.mTail;
+	aRange = queue.mRanges[queue.mTail % WorkQueue::kCapacity];
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Steal () (Private)
+// Desc : Takes the oldest, and so largest, range from the first other
+//		queue that has one, starting with the next thread along.
+//-----------------------------------------------------------------------------
+bool JobSystem::Steal(unsigned aQueue, ChunkRange & aRange)
+{
+	const unsigned queues = ThreadCount();
+
+	for (unsigned offset = 1; offset < queues; ++offset)
+	{
+		WorkQueue & queue = mQueues[(aQueue + offset) % queues];
+		std::lock_guard<std::mutex> lock(queue.mLock);
+
+		if (queue.mTail == queue.mHead)
+			continue;
+
+		aRange = queue.mRanges[queue.mHead % WorkQueue::kCapacity];
+		++queue.mHead;
+		return true;
+	}
+
+	return false;
+}
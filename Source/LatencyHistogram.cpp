@@ -0,0 +1,70 @@
+//-----------------------------------------------------------------------------
+// File: LatencyHistogram.cpp
+//
+// Desc: Fixed bucket histogram of latencies.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// LatencyHistogram Specific Includes
+//-----------------------------------------------------------------------------
+#include "LatencyHistogram.h"
+#include <string.h>
+#include <algorithm>
+
+const double LatencyHistogram::kBucketWidth = 0.1;
+
+LatencyHistogram::LatencyHistogram()
+{
+	Clear();
+}
+
+void LatencyHistogram::Clear()
+{
+	memset(mBuckets, 0, sizeof(mBuckets));
+	mCount   = 0;
+	mTotal   = 0.0;
+	mMaximum = 0.0;
+}
+
+void LatencyHistogram::Record(double aMilliseconds)
+{
+	if (aMilliseconds < 0.0)
+		aMilliseconds = 0.0;
+
+	int bucket = (int)(aMilliseconds / kBucketWidth);
+	if (bucket > kBucketCount)
+		bucket = kBucketCount;
+
+	++mBuckets[bucket];
+	++mCount;
+	mTotal += aMilliseconds;
+	if (aMilliseconds > mMaximum)
+		mMaximum = aMilliseconds;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Percentile ()
+// Desc : Walks the buckets until aPercentile of the samples are covered.
+//		Never reports more than the largest sample seen.
+//-----------------------------------------------------------------------------
+double LatencyHistogram::Percentile(double aPercentile) const
+{
+	if (mCount == 0)
+		return 0.0;
+
+	uint32_t rank = (uint32_t)(aPercentile / 100.0 * mCount + 0.5);
+	if (rank < 1)
+		rank = 1;
+	if (rank > mCount)
+		rank = mCount;
+
+	uint32_t seen = 0;
+	for (int bucket = 0; bucket < kBucketCount; ++bucket)
+	{
+		seen += mBuckets[bucket];
+		if (seen >= rank)
+			return std::min((bucket + 1) * kBucketWidth, mMaximum);
+	}
+
+	return mMaximum;
+}
@@ -0,0 +1,193 @@
+//-----------------------------------------------------------------------------
+// File: NetTransport.cpp
+//
+// Desc: The in-process loopback link and the network conditions shim.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// NetTransport Specific Includes
+//-----------------------------------------------------------------------------
+#include "NetTransport.h"
+#include "Platform.h"
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// Static Member Definitions
+//-----------------------------------------------------------------------------
+const size_t INetTransport::kMaxDatagram;
+const size_t LoopbackTransport::kCapacity;
+
+//-----------------------------------------------------------------------------
+// Name : LoopbackTransport () (Constructor)
+//-----------------------------------------------------------------------------
+LoopbackTransport::LoopbackTransport()
+	: mPeer(nullptr)
+	, mInbox(kCapacity)
+	, mHead(0)
+	, mTail(0)
+	, mDropped(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~LoopbackTransport () (Destructor)
+// Desc : Disconnects the peer, if still connected, so it never sends into
+//		a destroyed endpoint.
+//-----------------------------------------------------------------------------
+LoopbackTransport::~LoopbackTransport()
+{
+	if (mPeer && mPeer->mPeer == this)
+		mPeer->mPeer = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Connect () (Static)
+//-----------------------------------------------------------------------------
+void LoopbackTransport::Connect(LoopbackTransport & aFirst, LoopbackTransport & aSecond)
+{
+	aFirst.mPeer  = &aSecond;
+	aSecond.mPeer = &aFirst;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Send ()
+// Desc : Copies the datagram straight into the peer's inbox.
+//-----------------------------------------------------------------------------
+bool LoopbackTransport::Send(const void * aData, size_t aSize)
+{
+	if (!mPeer || aSize > kMaxDatagram)
+		return false;
+
+	LoopbackTransport & peer = *mPeer;
+	if (peer.mTail - peer.mHead == kCapacity)
+	{
+		++peer.mDropped;
+		return true;
+	}
+
+	Datagram & datagram = peer.mInbox[peer.mTail % kCapacity];
+	datagram.mSize = (uint32_t)aSize;
+	memcpy(datagram.mData, aData, aSize);
+	++peer.mTail;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Receive ()
+// Desc : Oldest datagram in the inbox; one too big for aBuffer is dropped.
+//-----------------------------------------------------------------------------
+size_t LoopbackTransport::Receive(void * aBuffer, size_t aCapacity)
+{
+	while (mHead != mTail)
+	{
+		const Datagram & datagram = mInbox[mHead % kCapacity];
+		++mHead;
+
+		if (datagram.mSize <= aCapacity)
+		{
+			memcpy(aBuffer, datagram.mData, datagram.mSize);
+			return datagram.mSize;
+		}
+		++mDropped;
+	}
+
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : LossyTransport () (Constructor)
+//-----------------------------------------------------------------------------
+LossyTransport::LossyTransport(INetTransport & aInner, double aLatency, double aJitter, float aLossRate, uint64_t aSeed)
+	: mInner(aInner)
+	, mLatency(aLatency > 0.0 ? aLatency : 0.0)
+	, mJitter(aJitter > 0.0 ? aJitter : 0.0)
+	, mLossRate(aLossRate)
+	, mRandom(aSeed)
+	, mManualTime(false)
+	, mTime(0.0)
+	, mSent(0)
+	, mDropped(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetTime ()
+//-----------------------------------------------------------------------------
+void LossyTransport::SetTime(double aSeconds)
+{
+	mManualTime = true;
+	mTime       = aSeconds;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Now () (Private)
+//-----------------------------------------------------------------------------
+double LossyTransport::Now() const
+{
+	if (mManualTime)
+		return mTime;
+
+	return PlatformClock::Seconds(0, PlatformClock::Ticks());
+}
+
+//-----------------------------------------------------------------------------
+// Name : Send ()
+// Desc : Rolls for loss, then holds the datagram until it is due.
+//-----------------------------------------------------------------------------
+bool LossyTransport::Send(const void * aData, size_t aSize)
+{
+	if (aSize > kMaxDatagram)
+		return false;
+
+	++mSent;
+	if (mRandom.NextFloat() < mLossRate)
+	{
+		++mDropped;
+		return true;
+	}
+
+	Pending pending;
+	pending.mDueTime = Now() + mLatency + mJitter * mRandom.NextFloat();
+	pending.mData.assign(static_cast<const uint8_t *>(aData), static_cast<const uint8_t *>(aData) + aSize);
+	mPending.push_back(pending);
+
+	Flush();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Receive ()
+// Desc : The wrapped transport's next datagram. Delays are applied on the
+//		sending side, so this only gives held datagrams a chance to leave.
+//-----------------------------------------------------------------------------
+size_t LossyTransport::Receive(void * aBuffer, size_t aCapacity)
+{
+	Flush();
+	return mInner.Receive(aBuffer, aCapacity);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Flush ()
+// Desc : Due datagrams leave in due time order, not send order, which is
+//		how jitter reorders them.
+//-----------------------------------------------------------------------------
+void LossyTransport::Flush()
+{
+	const double now = Now();
+
+	for (;;)
+	{
+		size_t next = mPending.size();
+		for (size_t i = 0; i < mPending.size(); ++i)
+		{
+			if (mPending[i].mDueTime <= now && (next == mPending.size() || mPending[i].mDueTime < mPending[next].mDueTime))
+				next = i;
+		}
+
+		if (next == mPending.size())
+			return;
+
+		mInner.Send(mPending[next].mData.data(), mPending[next].mData.size());
+		mPending.erase(mPending.begin() + next);
+	}
+}
@@ -0,0 +1,111 @@
+//-----------------------------------------------------------------------------
+// File: Platform.cpp
+//
+// Desc: The compile time clock and the file access shared by every backend.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Platform Specific Includes
+//-----------------------------------------------------------------------------
+#include "Platform.h"
+#include <stdio.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Name : Ticks () (Static)
+// Desc : Current reading of the high resolution clock.
+//-----------------------------------------------------------------------------
+int64_t PlatformClock::Ticks()
+{
+#if defined(_WIN32)
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+#else
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Name : Frequency () (Static)
+// Desc : Ticks per second.
+//-----------------------------------------------------------------------------
+int64_t PlatformClock::Frequency()
+{
+#if defined(_WIN32)
+	// Fixed at boot, so it only has to be asked for once
+	static int64_t frequency = 0;
+	if (frequency == 0)
+	{
+		LARGE_INTEGER value;
+		QueryPerformanceFrequency(&value);
+		frequency = value.QuadPart;
+	}
+	return frequency;
+#else
+	return 1000000000;
+#endif
+}
+
+double PlatformClock::Seconds(int64_t aStart, int64_t aEnd)
+{
+	return (double)(aEnd - aStart) / (double)Frequency();
+}
+
+void PlatformClock::SleepFor(double aSeconds)
+{
+	if (aSeconds <= 0.0)
+		return;
+
+#if defined(_WIN32)
+	Sleep((DWORD)(aSeconds * 1000.0));
+#else
+	timespec duration;
+	duration.tv_sec  = (time_t)aSeconds;
+	duration.tv_nsec = (long)((aSeconds - (double)duration.tv_sec) * 1e9);
+	nanosleep(&duration, NULL);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Name : LoadFile ()
+// Desc : Reads a whole file from disk into aData.
+//-----------------------------------------------------------------------------
+bool IPlatform::LoadFile(const char * szFileName, std::vector<uint8_t> & aData)
+{
+	FILE * file = fopen(szFileName, "rb");
+	if (!file)
+		return false;
+
+	aData.clear();
+	uint8_t buffer[4096];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		aData.insert(aData.end(), buffer, buffer + read);
+
+	const bool ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SaveFile ()
+// Desc : Writes aSize bytes to disk, replacing the file.
+//-----------------------------------------------------------------------------
+bool IPlatform::SaveFile(const char * szFileName, const void * aData, size_t aSize)
+{
+	FILE * file = fopen(szFileName, "wb");
+	if (!file)
+		return false;
+
+	bool ok = fwrite(aData, 1, aSize, file) == aSize;
+	ok = (fclose(file) == 0) && ok;
+	return ok;
+}
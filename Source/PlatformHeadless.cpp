@@ -0,0 +1,109 @@
+//-----------------------------------------------------------------------------
+// File: PlatformHeadless.cpp
+//
+// Desc: Platform backend with no window and no sound.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// PlatformHeadless Specific Includes
+//-----------------------------------------------------------------------------
+#include "PlatformHeadless.h"
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Name : HeadlessPlatform () (Constructor)
+// Desc : Allocates a cleared aWidth x aHeight surface.
+//-----------------------------------------------------------------------------
+HeadlessPlatform::HeadlessPlatform(int aWidth, int aHeight, bool aFilesInMemory)
+	: mWidth(aWidth)
+	, mHeight(aHeight)
+	, mPixels((size_t)aWidth * aHeight, 0)
+	, mPresentCount(0)
+	, mSoundCount(0)
+	, mFilesInMemory(aFilesInMemory)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : LoadSprite ()
+// Desc : Keeps the mask to draw from; the image file is never read. Each
+//		sprite gets its own colour so they can be told apart.
+//-----------------------------------------------------------------------------
+bool HeadlessPlatform::LoadSprite(uint16_t aSprite, const SpriteSheet & aSheet, const CollisionMask & aMask)
+{
+	if (aSprite >= mSprites.size())
+		mSprites.resize(aSprite + 1);
+
+	HeadlessSprite & sprite = mSprites[aSprite];
+	sprite.mMask        = aMask;
+	sprite.mFrameWidth  = aSheet.mFrameWidth;
+	sprite.mFrameHeight = aSheet.mFrameHeight;
+	sprite.mColour      = 0xFF404040u | ((aSprite * 0x9E3779B9u) & 0x00BFBFBFu);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawSprite ()
+// Desc : Masked copy of one frame into the surface, clipped to it; stands
+//		in for the GDI mask / image BitBlt pair.
+//-----------------------------------------------------------------------------
+void HeadlessPlatform::DrawSprite(uint16_t aSprite, int aFrame, float aX, float aY)
+{
+	const HeadlessSprite & sprite = mSprites[aSprite];
+	const int frameX = (aFrame % kSpriteFramesPerRow) * sprite.mFrameWidth;
+	const int frameY = (aFrame / kSpriteFramesPerRow) * sprite.mFrameHeight;
+	const int left   = (int)aX - sprite.mFrameWidth / 2;
+	const int top    = (int)aY - sprite.mFrameHeight / 2;
+
+	const int x0 = std::max(left, 0), x1 = std::min(left + sprite.mFrameWidth, mWidth);
+	const int y0 = std::max(top, 0),  y1 = std::min(top + sprite.mFrameHeight, mHeight);
+
+	for (int y = y0; y < y1; ++y)
+	{
+		uint32_t * row = mPixels.data() + (size_t)y * mWidth;
+		for (int x = x0; x < x1; ++x)
+		{
+			if (sprite.mMask.IsOpaque(frameX + x - left, frameY + y - top))
+				row[x] = sprite.mColour;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Present ()
+// Desc : Nothing to show; the frame stays in Pixels() until redrawn.
+//-----------------------------------------------------------------------------
+void HeadlessPlatform::Present()
+{
+	++mPresentCount;
+}
+
+void HeadlessPlatform::PlayAudio(const char * /*szFileName*/)
+{
+	if (!IsAudioMuted())
+		++mSoundCount;
+}
+
+//-----------------------------------------------------------------------------
+// Name : LoadFile ()
+// Desc : Serves a file saved during this run, or falls back to disk.
+//-----------------------------------------------------------------------------
+bool HeadlessPlatform::LoadFile(const char * szFileName, std::vector<uint8_t> & aData)
+{
+	std::map<std::string, std::vector<uint8_t> >::const_iterator file = mFiles.find(szFileName);
+	if (file == mFiles.end())
+		return IPlatform::LoadFile(szFileName, aData);
+
+	aData = file->second;
+	return true;
+}
+
+bool HeadlessPlatform::SaveFile(const char * szFileName, const void * aData, size_t aSize)
+{
+	if (!mFilesInMemory)
+		return IPlatform::SaveFile(szFileName, aData, aSize);
+
+	const uint8_t * bytes = static_cast<const uint8_t *>(aData);
+	mFiles[szFileName].assign(bytes, bytes + aSize);
+	return true;
+}
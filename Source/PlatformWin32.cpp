@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------
+// File: PlatformWin32.cpp
+//
+// Desc: Platform backend for the game window.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// PlatformWin32 Specific Includes
+//-----------------------------------------------------------------------------
+#include "PlatformWin32.h"
+
+Win32Platform::Win32Platform(BackBuffer * pBackBuffer)
+	: mBackBuffer(pBackBuffer)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : LoadSprite ()
+// Desc : Loads the image and mask bitmaps; GDI builds its own mask from
+//		the file, so the decoded one is not needed.
+//-----------------------------------------------------------------------------
+bool Win32Platform::LoadSprite(uint16_t aSprite, const SpriteSheet & aSheet, const CollisionMask & /*aMask*/)
+{
+	LoadedSprite loaded;
+	loaded.mAnimation = nullptr;
+	if (aSheet.mFrameCount > 1)
+	{
+		const RECT firstFrame = { 0, 0, aSheet.mFrameWidth, aSheet.mFrameHeight };
+		loaded.mAnimation = new AnimatedSprite(aSheet.mImageFile, aSheet.mMaskFile, firstFrame, aSheet.mFrameCount);
+		loaded.mSprite.reset(loaded.mAnimation);
+	}
+	else
+	{
+		loaded.mSprite = std::make_unique<Sprite>(aSheet.mImageFile, aSheet.mMaskFile);
+	}
+
+	if (loaded.mSprite->width() == 0)
+		return false;
+
+	loaded.mSprite->setBackBuffer(mBackBuffer);
+	if (aSprite >= mSprites.size())
+		mSprites.resize(aSprite + 1);
+	mSprites[aSprite] = std::move(loaded);
+	return true;
+}
+
+void Win32Platform::DrawSprite(uint16_t aSprite, int aFrame, float aX, float aY)
+{
+	LoadedSprite & loaded = mSprites[aSprite];
+	if (loaded.mAnimation)
+		loaded.mAnimation->SetFrame(aFrame);
+
+	loaded.mSprite->mPosition = Vec2(aX, aY);
+	loaded.mSprite->draw();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Present ()
+// Desc : Blits the back buffer into the window's client area.
+//-----------------------------------------------------------------------------
+void Win32Platform::Present()
+{
+	mBackBuffer->present();
+}
+
+//-----------------------------------------------------------------------------
+// Name : PlayAudio ()
+// Desc : PlaySound plays one asynchronous sound at a time, a new one stops
+//		the previous.
+//-----------------------------------------------------------------------------
+void Win32Platform::PlayAudio(const char * szFileName)
+{
+	if (IsAudioMuted())
+		return;
+
+	::PlaySound(szFileName, NULL, SND_FILENAME | SND_ASYNC);
+}
@@ -0,0 +1,173 @@
+//-----------------------------------------------------------------------------
+// File: Profiler.cpp
+//
+// Desc: Per thread event rings and the Chrome trace export.
+//
+//	   A thread's ring is created the first time it records and is owned by
+//	   the global list, so events from threads that have since exited still
+//	   make it into the trace. Only creating a ring takes the lock.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Profiler Specific Includes
+//-----------------------------------------------------------------------------
+#include "Profiler.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Local Structures
+//-----------------------------------------------------------------------------
+namespace
+{
+	struct ProfileEvent
+	{
+		const char * mName;
+		int64_t      mStart;
+		int64_t      mEnd;
+		uint32_t     mDepth;
+	};
+
+	struct ThreadEvents
+	{
+		explicit ThreadEvents(uint32_t aThreadId)
+			: mThreadId(aThreadId)
+			, mEvents(Profiler::kEventsPerThread)
+			, mWritten(0)
+		{
+		}
+
+		uint32_t                  mThreadId;
+		std::string               mName;
+		std::vector<ProfileEvent> mEvents;
+		uint64_t                  mWritten;	// Total ever recorded; the ring keeps the last kEventsPerThread
+	};
+
+	std::mutex                                  gThreadsLock;
+	std::vector<std::unique_ptr<ThreadEvents> > gThreads;
+	thread_local ThreadEvents *                 tEvents = nullptr;
+
+	ThreadEvents & CurrentThread()
+	{
+		if (!tEvents)
+		{
+			std::lock_guard<std::mutex> lock(gThreadsLock);
+			gThreads.push_back(std::make_unique<ThreadEvents>((uint32_t)gThreads.size() + 1));
+			tEvents = gThreads.back().get();
+		}
+		return *tEvents;
+	}
+
+	// Trace names are identifiers in practice; quotes, backslashes and
+	// control characters are all that could break the JSON.
+	void WriteJsonString(std::string & aJson, const char * szText)
+	{
+		aJson += '"';
+		for (const char * c = szText; *c; ++c)
+		{
+			if (*c == '"' || *c == '\\')
+				aJson += '\\';
+			aJson += (unsigned char)*c < 0x20 ? ' ' : *c;
+		}
+		aJson += '"';
+	}
+
+	void WriteFormat(std::string & aJson, const char * szFormat, ...)
+	{
+		char buffer[256];
+		va_list arguments;
+		va_start(arguments, szFormat);
+		const int length = vsnprintf(buffer, sizeof(buffer), szFormat, arguments);
+		va_end(arguments);
+
+		if (length > 0)
+			aJson.append(buffer, std::min((size_t)length, sizeof(buffer) - 1));
+	}
+}
+
+thread_local uint32_t ProfileScope::sDepth = 0;
+
+//-----------------------------------------------------------------------------
+// Name : Record () (Static)
+// Desc : Appends a finished event to the calling thread's ring.
+//-----------------------------------------------------------------------------
+void Profiler::Record(const char * szName, int64_t aStart, int64_t aEnd, uint32_t aDepth)
+{
+	ThreadEvents & thread = CurrentThread();
+
+	ProfileEvent & event = thread.mEvents[thread.mWritten % kEventsPerThread];
+	event.mName  = szName;
+	event.mStart = aStart;
+	event.mEnd   = aEnd;
+	event.mDepth = aDepth;
+	++thread.mWritten;
+}
+
+void Profiler::SetThreadName(const char * szName)
+{
+	CurrentThread().mName = szName;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WriteChromeTrace () (Static)
+// Desc : Saves every thread's events as complete ("X") trace events, times
+//		in microseconds from the earliest one. The JSON is built in memory
+//		and written in one go.
+//-----------------------------------------------------------------------------
+bool Profiler::WriteChromeTrace(IPlatform & aPlatform, const char * szFileName)
+{
+	std::lock_guard<std::mutex> lock(gThreadsLock);
+
+	std::string json;
+
+	int64_t origin = INT64_MAX;
+	for (const std::unique_ptr<ThreadEvents> & thread : gThreads)
+	{
+		const uint64_t first = thread->mWritten > kEventsPerThread ? thread->mWritten - kEventsPerThread : 0;
+		for (uint64_t i = first; i < thread->mWritten; ++i)
+			origin = std::min(origin, thread->mEvents[i % kEventsPerThread].mStart);
+	}
+
+	const double microseconds = 1000000.0 / (double)PlatformClock::Frequency();
+	bool comma = false;
+
+	json += "{\"traceEvents\":[\n";
+	for (const std::unique_ptr<ThreadEvents> & thread : gThreads)
+	{
+		if (!thread->mName.empty())
+		{
+			WriteFormat(json, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+				comma ? ",\n" : "", thread->mThreadId);
+			WriteJsonString(json, thread->mName.c_str());
+			json += "}}";
+			comma = true;
+		}
+
+		const uint64_t first = thread->mWritten > kEventsPerThread ? thread->mWritten - kEventsPerThread : 0;
+		for (uint64_t i = first; i < thread->mWritten; ++i)
+		{
+			const ProfileEvent & event = thread->mEvents[i % kEventsPerThread];
+			json += comma ? ",\n{\"name\":" : "{\"name\":";
+			WriteJsonString(json, event.mName);
+			WriteFormat(json, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"depth\":%u}}",
+				thread->mThreadId, (event.mStart - origin) * microseconds,
+				(event.mEnd - event.mStart) * microseconds, event.mDepth);
+			comma = true;
+		}
+	}
+	json += "\n]}\n";
+
+	return aPlatform.SaveFile(szFileName, json.data(), json.size());
+}
+
+void Profiler::Clear()
+{
+	std::lock_guard<std::mutex> lock(gThreadsLock);
+	for (const std::unique_ptr<ThreadEvents> & thread : gThreads)
+		thread->mWritten = 0;
+}
@@ -0,0 +1,83 @@
+//-----------------------------------------------------------------------------
+// File: ProjectilePool.cpp
+//
+// Desc: Fixed capacity projectile storage with generation checked handles.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// ProjectilePool Specific Includes
+//-----------------------------------------------------------------------------
+#include "ProjectilePool.h"
+#include "WorldSnapshot.h"
+#include <assert.h>
+
+//-----------------------------------------------------------------------------
+// Name : ProjectilePool () (Constructor)
+// Desc : ProjectilePool Class Constructor
+//-----------------------------------------------------------------------------
+ProjectilePool::ProjectilePool(size_t aCapacity)
+	: mCapacity(aCapacity)
+	, mHighWater(0)
+	, mDropped(0)
+{
+	mEntities.Reserve(aCapacity);
+	mSlots.Reserve(aCapacity);
+}
+
+ProjectileHandle ProjectilePool::Spawn(float aX, float aY, float aVelocityX, float aVelocityY,
+                                       uint16_t aSprite, int32_t aHalfWidth, int32_t aHalfHeight,
+                                       uint16_t aOwner)
+{
+	if (mEntities.Size() == mCapacity)
+	{
+		++mDropped;
+		return ProjectileHandle();
+	}
+
+	mEntities.Add(aX, aY, aVelocityX, aVelocityY, aSprite, aHalfWidth, aHalfHeight, aOwner);
+
+	if (mEntities.Size() > mHighWater)
+		mHighWater = mEntities.Size();
+
+	return mSlots.Insert();
+}
+
+bool ProjectilePool::Release(ProjectileHandle aHandle)
+{
+	const size_t index = mSlots.IndexOf(aHandle);
+	if (index == kInvalidIndex)
+		return false;
+
+	ReleaseAt(index);
+	return true;
+}
+
+void ProjectilePool::ReleaseAt(size_t aIndex)
+{
+	assert(aIndex < mEntities.Size());
+
+	// Both move their last element into the hole.
+	mEntities.Remove(aIndex);
+	mSlots.EraseAt(aIndex);
+}
+
+void ProjectilePool::Clear()
+{
+	mEntities.Clear();
+	mSlots.Clear();
+}
+
+void ProjectilePool::SaveState(WorldSnapshot & aSnapshot) const
+{
+	mEntities.SaveState(aSnapshot);
+	mSlots.SaveState(aSnapshot);
+}
+
+bool ProjectilePool::LoadState(SnapshotReader & aReader)
+{
+	mEntities.LoadState(aReader);
+	mSlots.LoadState(aReader);
+
+	// Saved from a pool of the same capacity, so it always fits.
+	return !aReader.Failed() && mEntities.Size() <= mCapacity;
+}
@@ -0,0 +1,60 @@
+//-----------------------------------------------------------------------------
+// File: Random.cpp
+//
+// Desc: Seeded PCG32 random number generator.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Random Specific Includes
+//-----------------------------------------------------------------------------
+#include "Random.h"
+#include <assert.h>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+static const uint64_t kMultiplier = 6364136223846793005ull;
+static const uint64_t kIncrement  = 1442695040888963407ull;
+
+//-----------------------------------------------------------------------------
+// Name : Random () (Constructor)
+// Desc : Random Class Constructor
+//-----------------------------------------------------------------------------
+Random::Random(uint64_t aSeed)
+{
+	Seed(aSeed);
+}
+
+void Random::Seed(uint64_t aSeed)
+{
+	// Reference PCG seeding: nearby seeds still give unrelated sequences.
+	mState = 0;
+	Next();
+	mState += aSeed;
+	Next();
+}
+
+uint32_t Random::Next()
+{
+	const uint64_t state = mState;
+	mState = state * kMultiplier + kIncrement;
+
+	const uint32_t xorShifted = (uint32_t)(((state >> 18) ^ state) >> 27);
+	const uint32_t rotation   = (uint32_t)(state >> 59);
+
+	return (xorShifted >> rotation) | (xorShifted << ((0u - rotation) & 31));
+}
+
+uint32_t Random::NextBelow(uint32_t aBound)
+{
+	assert(aBound > 0);
+
+	// Multiply-shift instead of modulo: no division, and the bias is
+	// negligible for the small bounds used by the game.
+	return (uint32_t)(((uint64_t)Next() * aBound) >> 32);
+}
+
+float Random::NextFloat()
+{
+	return (Next() >> 8) * (1.0f / 16777216.0f);
+}
@@ -0,0 +1,175 @@
+//-----------------------------------------------------------------------------
+// File: RectangleSoA.cpp
+//
+// Desc: Structure-of-arrays rectangle store and batched overlap kernels.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// RectangleSoA Specific Includes
+//-----------------------------------------------------------------------------
+#include "RectangleSoA.h"
+#include "SimdUtil.h"
+#include <assert.h>
+#include <limits.h>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// Padding lanes are "inverted" rectangles, they can never overlap anything.
+static const int32_t kPadMin = INT32_MIN;
+static const int32_t kPadMax = INT32_MAX;
+
+//-----------------------------------------------------------------------------
+// Name : RectangleSoA () (Constructor)
+// Desc : RectangleSoA Class Constructor
+//-----------------------------------------------------------------------------
+RectangleSoA::RectangleSoA()
+	: mSize(0)
+{
+}
+
+void RectangleSoA::Clear()
+{
+	mLeft.clear();
+	mTop.clear();
+	mRight.clear();
+	mBottom.clear();
+	mSize = 0;
+}
+
+void RectangleSoA::Reserve(size_t aCount)
+{
+	size_t padded = (aCount + 3) & ~size_t(3);
+	mLeft.reserve(padded);
+	mTop.reserve(padded);
+	mRight.reserve(padded);
+	mBottom.reserve(padded);
+}
+
+size_t RectangleSoA::Add(int32_t aLeft, int32_t aTop, int32_t aRight, int32_t aBottom)
+{
+	// Grow a whole SIMD lane group at a time so kernels never need a tail loop.
+	if (mSize == mLeft.size())
+	{
+		mLeft.resize(mSize + 4);
+		mTop.resize(mSize + 4);
+		mRight.resize(mSize + 4);
+		mBottom.resize(mSize + 4);
+
+		for (size_t i = mSize; i < mSize + 4; ++i)
+			ResetPadding(i);
+	}
+
+	Set(mSize, aLeft, aTop, aRight, aBottom);
+	return mSize++;
+}
+
+void RectangleSoA::Set(size_t aIndex, int32_t aLeft, int32_t aTop, int32_t aRight, int32_t aBottom)
+{
+	assert(aIndex < mLeft.size());
+
+	mLeft[aIndex]   = aLeft;
+	mTop[aIndex]    = aTop;
+	mRight[aIndex]  = aRight;
+	mBottom[aIndex] = aBottom;
+}
+
+void RectangleSoA::RemoveSwap(size_t aIndex)
+{
+	assert(aIndex < mSize);
+
+	size_t last = mSize - 1;
+	Set(aIndex, mLeft[last], mTop[last], mRight[last], mBottom[last]);
+	ResetPadding(last);
+	--mSize;
+}
+
+void RectangleSoA::ResetPadding(size_t aIndex)
+{
+	Set(aIndex, kPadMax, kPadMax, kPadMin, kPadMin);
+}
+
+namespace RectangleBatch
+{
+	//-------------------------------------------------------------------------
+	// Name : IntersectOne ()
+	// Desc : Tests one rectangle against a whole store, four lanes at a time.
+	//-------------------------------------------------------------------------
+	size_t IntersectOne(const RectangleSoA & aStore,
+	                    int32_t aLeft, int32_t aTop, int32_t aRight, int32_t aBottom,
+	                    uint32_t * aHitMask)
+	{
+		const size_t words = aStore.MaskWords();
+		for (size_t w = 0; w < words; ++w)
+			aHitMask[w] = 0;
+
+		const int32_t * left   = aStore.Left();
+		const int32_t * top    = aStore.Top();
+		const int32_t * right  = aStore.Right();
+		const int32_t * bottom = aStore.Bottom();
+		const size_t count     = aStore.Size();
+		size_t hits = 0;
+
+#if defined(SIMD_SSE2)
+		const __m128i qLeft   = _mm_set1_epi32(aLeft);
+		const __m128i qTop    = _mm_set1_epi32(aTop);
+		const __m128i qRight  = _mm_set1_epi32(aRight);
+		const __m128i qBottom = _mm_set1_epi32(aBottom);
+
+		for (size_t i = 0; i < count; i += 4)
+		{
+			__m128i l = _mm_loadu_si128((const __m128i *)(left + i));
+			__m128i t = _mm_loadu_si128((const __m128i *)(top + i));
+			__m128i r = _mm_loadu_si128((const __m128i *)(right + i));
+			__m128i b = _mm_loadu_si128((const __m128i *)(bottom + i));
+
+			// Separated on any axis -> no overlap.
+			__m128i miss = _mm_or_si128(
+				_mm_or_si128(_mm_cmpgt_epi32(l, qRight), _mm_cmpgt_epi32(qLeft, r)),
+				_mm_or_si128(_mm_cmpgt_epi32(t, qBottom), _mm_cmpgt_epi32(qTop, b)));
+
+			uint32_t lanes = ~(uint32_t)_mm_movemask_ps(_mm_castsi128_ps(miss)) & 0xFu;
+			if (lanes)
+			{
+				aHitMask[i / 32] |= lanes << (i % 32);
+				hits += SimdUtil::PopCount(lanes);
+			}
+		}
+#else
+		for (size_t i = 0; i < count; ++i)
+		{
+			bool miss = (left[i] > aRight) | (aLeft > right[i]) |
+			            (top[i] > aBottom) | (aTop > bottom[i]);
+			if (!miss)
+			{
+				aHitMask[i / 32] |= 1u << (i % 32);
+				++hits;
+			}
+		}
+#endif
+
+		return hits;
+	}
+
+	//-------------------------------------------------------------------------
+	// Name : IntersectMany ()
+	// Desc : All pairs between two stores, one bitmask row per aFirst entry.
+	//-------------------------------------------------------------------------
+	size_t IntersectMany(const RectangleSoA & aFirst, const RectangleSoA & aSecond,
+	                     std::vector<uint32_t> & aHitMasks)
+	{
+		const size_t words = aSecond.MaskWords();
+		aHitMasks.resize(aFirst.Size() * words);
+
+		size_t hits = 0;
+		for (size_t i = 0; i < aFirst.Size(); ++i)
+		{
+			hits += IntersectOne(aSecond,
+			                     aFirst.Left()[i], aFirst.Top()[i],
+			                     aFirst.Right()[i], aFirst.Bottom()[i],
+			                     aHitMasks.data() + i * words);
+		}
+
+		return hits;
+	}
+}
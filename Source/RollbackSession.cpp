@@ -0,0 +1,457 @@
+//-----------------------------------------------------------------------------
+// File: RollbackSession.cpp
+//
+// Desc: Input exchange, prediction, rollback and the desync check.
+//
+//	   Datagram layout, little endian like both peers:
+//
+//		   uint32  magic
+//		   uint32  tick         the sender's next tick to simulate
+//		   int32   advantage    how far the sender thinks it is ahead
+//		   uint32  ack          remote inputs the sender has, all ticks below
+//		   uint32  sync tick    tick of the sender's newest final state hash
+//		   uint64  sync hash    (tick ~0u: none yet)
+//		   uint32  first tick   of the inputs that follow
+//		   uint8   count
+//		   uint16  inputs[count]
+//
+//	   A peer that leaves sends just the leaving magic instead.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// RollbackSession Specific Includes
+//-----------------------------------------------------------------------------
+#include "RollbackSession.h"
+#include "NetTransport.h"
+#include "Platform.h"
+#include "Profiler.h"
+#include <assert.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// Static Member Definitions
+//-----------------------------------------------------------------------------
+const uint32_t RollbackSession::kPlayerCount;
+const uint32_t RollbackSession::kMaxRollback;
+const uint32_t RollbackSession::kMaxInputDelay;
+const uint32_t RollbackSession::kInputHistory;
+const uint32_t RollbackSession::kSnapshotCount;
+const uint32_t RollbackSession::kSyncHistory;
+const uint32_t RollbackSession::kSyncInterval;
+const uint32_t RollbackSession::kMaxPacketInputs;
+const int32_t  RollbackSession::kMaxLead;
+const uint32_t RollbackSession::kQuitRepeats;
+
+//-----------------------------------------------------------------------------
+// Local Functions
+//-----------------------------------------------------------------------------
+namespace
+{
+	const uint32_t kMagic      = 0x31425253;	// "SRB1"
+	const uint32_t kQuitMagic  = 0x51425253;	// "SRBQ"
+	const double   kDefaultTimeout = 10.0;		// Seconds
+	const uint32_t kNoSyncTick = ~0u;
+	const size_t   kHeaderSize = 4 + 4 + 4 + 4 + 4 + 8 + 4 + 1;
+
+	template <typename T>
+	inline void Put(uint8_t *& aCursor, T aValue)
+	{
+		memcpy(aCursor, &aValue, sizeof(T));
+		aCursor += sizeof(T);
+	}
+
+	template <typename T>
+	inline T Get(const uint8_t *& aCursor)
+	{
+		T value;
+		memcpy(&value, aCursor, sizeof(T));
+		aCursor += sizeof(T);
+		return value;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : RollbackSession () (Constructor)
+// Desc : Both players' inputs for the first aInputDelay ticks are known to
+//		be empty, on both peers.
+//-----------------------------------------------------------------------------
+RollbackSession::RollbackSession(IRollbackWorld & aWorld, INetTransport & aTransport, uint32_t aLocalPlayer, uint32_t aInputDelay)
+	: mWorld(aWorld)
+	, mTransport(aTransport)
+	, mLocalPlayer(aLocalPlayer ? 1 : 0)
+	, mInputDelay(aInputDelay < kMaxInputDelay ? aInputDelay : kMaxInputDelay)
+	, mHeldButtons(0)
+	, mTick(0)
+	, mLocalCount(0)
+	, mRemoteCount(0)
+	, mRemoteAcked(0)
+	, mRollbackFrom(0)
+	, mPeerTick(0)
+	, mPeerAdvantage(0)
+	, mSyncCount(0)
+	, mFinalTick(0)
+	, mPeerSyncTick(0)
+	, mPeerSyncHash(0)
+	, mPeerSyncPending(false)
+	, mDesynced(false)
+	, mSentSincePoll(false)
+	, mEnd(SESSION_RUNNING)
+	, mTimeout(kDefaultTimeout)
+	, mManualTime(false)
+	, mTime(0.0)
+	, mLastReceived(0.0)
+{
+	memset(mLocalInput, 0, sizeof(mLocalInput));
+	memset(mRemoteInput, 0, sizeof(mRemoteInput));
+	memset(mRemoteUsed, 0, sizeof(mRemoteUsed));
+	memset(mSyncTick, 0, sizeof(mSyncTick));
+	memset(mSyncHash, 0, sizeof(mSyncHash));
+	memset(&mStats, 0, sizeof(mStats));
+
+	mLocalCount  = mInputDelay;
+	mRemoteCount = mInputDelay;
+	mRemoteAcked = mInputDelay;
+	mLastReceived = Now();
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetTime ()
+//-----------------------------------------------------------------------------
+void RollbackSession::SetTime(double aSeconds)
+{
+	if (!mManualTime)
+		mLastReceived = aSeconds;
+
+	mManualTime = true;
+	mTime       = aSeconds;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Now () (Private)
+//-----------------------------------------------------------------------------
+double RollbackSession::Now() const
+{
+	if (mManualTime)
+		return mTime;
+
+	return PlatformClock::Seconds(0, PlatformClock::Ticks());
+}
+
+//-----------------------------------------------------------------------------
+// Name : Disconnect ()
+//-----------------------------------------------------------------------------
+void RollbackSession::Disconnect()
+{
+	if (IsOver())
+		return;
+
+	uint8_t datagram[sizeof(uint32_t)];
+	uint8_t * cursor = datagram;
+	Put<uint32_t>(cursor, kQuitMagic);
+	for (uint32_t i = 0; i < kQuitRepeats; ++i)
+		mTransport.Send(datagram, sizeof(datagram));
+
+	mEnd = SESSION_LEFT;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CanAdvance ()
+// Desc : Also false if the peer has not acknowledged enough local input
+//		for the history to hold another tick, or while this peer's clock
+//		runs ahead of the other's.
+//-----------------------------------------------------------------------------
+bool RollbackSession::CanAdvance() const
+{
+	return !IsOver() && mTick < mRemoteCount + kMaxRollback && mLocalCount + 1 - mRemoteAcked <= kInputHistory &&
+		TicksAhead() < kMaxLead;
+}
+
+//-----------------------------------------------------------------------------
+// Name : LocalAdvantage () (Private)
+// Desc : Ticks between here and the peer's last reported tick. That report
+//		is a one way trip old, which inflates both peers' advantages the
+//		same, so half the difference of the two is how far apart the
+//		clocks really are.
+//-----------------------------------------------------------------------------
+int32_t RollbackSession::LocalAdvantage() const
+{
+	return (int32_t)(mTick - mPeerTick);
+}
+
+int32_t RollbackSession::TicksAhead() const
+{
+	return (LocalAdvantage() - mPeerAdvantage) / 2;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Poll ()
+// Desc : Does nothing once the match is over.
+//-----------------------------------------------------------------------------
+void RollbackSession::Poll()
+{
+	PROFILE_SCOPE("Net");
+
+	if (IsOver())
+		return;
+
+	mRollbackFrom = mTick;
+
+	const uint32_t received = mStats.mPacketsReceived;
+	uint8_t datagram[INetTransport::kMaxDatagram];
+	size_t size;
+	while (!IsOver() && (size = mTransport.Receive(datagram, sizeof(datagram))) != 0)
+		ReadDatagram(datagram, size);
+
+	if (IsOver())
+		return;
+
+	// Silence only counts once the peer has been heard from at all
+	const double now = Now();
+	if (mStats.mPacketsReceived != received)
+		mLastReceived = now;
+	else if (HasRemote() && now - mLastReceived > mTimeout)
+	{
+		mEnd = SESSION_TIMED_OUT;
+		return;
+	}
+
+	if (mRollbackFrom < mTick)
+		Rollback(mRollbackFrom);
+
+	UpdateSyncHash();
+
+	// A peer that is waiting, or has not advanced since the last poll,
+	// keeps sending anyway: a lost datagram would otherwise leave both
+	// waiting for each other.
+	const bool stalled = !CanAdvance();
+	if (stalled)
+		++mStats.mStalls;
+	if (stalled || !mSentSincePoll)
+		SendInputs();
+	mSentSincePoll = false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Advance ()
+//-----------------------------------------------------------------------------
+void RollbackSession::Advance(uint16_t aButtons)
+{
+	assert(CanAdvance());
+
+	mLocalInput[mLocalCount % kInputHistory] = aButtons;
+	++mLocalCount;
+
+	mWorld.SaveState(mSnapshots[mTick % kSnapshotCount]);
+	SimulateOne(mTick, false);
+	++mTick;
+
+	UpdateSyncHash();
+	SendInputs();
+}
+
+//-----------------------------------------------------------------------------
+// Name : SimulateOne () (Private)
+// Desc : The remote input is the confirmed one if it has arrived, or the
+//		last one that has with the presses cleared.
+//-----------------------------------------------------------------------------
+void RollbackSession::SimulateOne(uint32_t aTick, bool aReplaying)
+{
+	uint16_t remote = 0;
+	if (aTick < mRemoteCount)
+		remote = mRemoteInput[aTick % kInputHistory];
+	else if (mRemoteCount > 0)
+		remote = mRemoteInput[(mRemoteCount - 1) % kInputHistory] & mHeldButtons;
+
+	mRemoteUsed[aTick % kInputHistory] = remote;
+
+	uint16_t buttons[kPlayerCount];
+	buttons[mLocalPlayer]     = mLocalInput[aTick % kInputHistory];
+	buttons[1 - mLocalPlayer] = remote;
+	mWorld.SimulateTick(buttons, aReplaying);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Rollback () (Private)
+// Desc : Back to the start of aFirstTick, then forward again to the current
+//		tick, refreshing the snapshots on the way.
+//-----------------------------------------------------------------------------
+void RollbackSession::Rollback(uint32_t aFirstTick)
+{
+	PROFILE_SCOPE("Rollback");
+
+	assert(mTick - aFirstTick <= kMaxRollback);
+	const int64_t start = PlatformClock::Ticks();
+
+	const bool restored = mWorld.LoadState(mSnapshots[aFirstTick % kSnapshotCount]);
+	assert(restored);
+	(void)restored;
+
+	for (uint32_t tick = aFirstTick; tick < mTick; ++tick)
+	{
+		if (tick != aFirstTick)
+			mWorld.SaveState(mSnapshots[tick % kSnapshotCount]);
+		SimulateOne(tick, true);
+	}
+
+	const uint32_t depth = mTick - aFirstTick;
+	const double seconds = PlatformClock::Seconds(start, PlatformClock::Ticks());
+	++mStats.mRollbacks;
+	mStats.mReplayedTicks += depth;
+	if (depth > mStats.mMaxDepth)
+		mStats.mMaxDepth = depth;
+	mStats.mLastRollbackSeconds = seconds;
+	if (seconds > mStats.mMaxRollbackSeconds)
+		mStats.mMaxRollbackSeconds = seconds;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReadDatagram () (Private)
+// Desc : Anything malformed is ignored; the next datagram repeats it.
+//-----------------------------------------------------------------------------
+void RollbackSession::ReadDatagram(const uint8_t * aData, size_t aSize)
+{
+	uint32_t leading = 0;
+	if (aSize == sizeof(leading))
+	{
+		memcpy(&leading, aData, sizeof(leading));
+		if (leading == kQuitMagic)
+			mEnd = SESSION_PEER_LEFT;
+		return;
+	}
+
+	if (aSize < kHeaderSize)
+		return;
+
+	const uint8_t * cursor = aData;
+	const uint32_t magic     = Get<uint32_t>(cursor);
+	const uint32_t tick      = Get<uint32_t>(cursor);
+	const int32_t  advantage = Get<int32_t>(cursor);
+	const uint32_t ack       = Get<uint32_t>(cursor);
+	const uint32_t syncTick  = Get<uint32_t>(cursor);
+	const uint64_t syncHash  = Get<uint64_t>(cursor);
+	const uint32_t firstTick = Get<uint32_t>(cursor);
+	const uint8_t  count     = Get<uint8_t>(cursor);
+
+	if (magic != kMagic || aSize != kHeaderSize + count * sizeof(uint16_t))
+		return;
+
+	++mStats.mPacketsReceived;
+
+	// The newest report of the peer's clock; reordered ones are older.
+	if (tick >= mPeerTick)
+	{
+		mPeerTick      = tick;
+		mPeerAdvantage = advantage;
+	}
+
+	// Acks only grow; an old datagram arriving late says nothing new.
+	if (ack > mRemoteAcked && ack <= mLocalCount)
+		mRemoteAcked = ack;
+
+	for (uint32_t i = 0; i < count; ++i)
+		ConfirmRemote(firstTick + i, Get<uint16_t>(cursor));
+
+	if (syncTick != kNoSyncTick)
+		CheckSync(syncTick, syncHash);
+}
+
+//-----------------------------------------------------------------------------
+// Name : ConfirmRemote () (Private)
+// Desc : Takes the next remote input in sequence; repeats and gaps are
+//		skipped (the gap is resent). A simulated tick that used something
+//		else is marked for rollback.
+//-----------------------------------------------------------------------------
+void RollbackSession::ConfirmRemote(uint32_t aTick, uint16_t aButtons)
+{
+	if (aTick != mRemoteCount)
+		return;
+
+	// Too far ahead to keep without overwriting input still needed
+	if (aTick >= mTick + kInputHistory - kSnapshotCount)
+		return;
+
+	mRemoteInput[aTick % kInputHistory] = aButtons;
+	++mRemoteCount;
+
+	if (aTick < mTick && mRemoteUsed[aTick % kInputHistory] != aButtons && aTick < mRollbackFrom)
+		mRollbackFrom = aTick;
+}
+
+//-----------------------------------------------------------------------------
+// Name : UpdateSyncHash () (Private)
+// Desc : The world at the start of tick t is final once every input before
+//		t is confirmed. Every kSyncInterval'th final state is hashed while
+//		its snapshot is still kept.
+//-----------------------------------------------------------------------------
+void RollbackSession::UpdateSyncHash()
+{
+	// The newest saved state is the start of mTick - 1
+	const uint32_t finalEnd = mRemoteCount < mTick ? mRemoteCount + 1 : mTick;
+
+	for (; mFinalTick < finalEnd; ++mFinalTick)
+	{
+		if (mFinalTick % kSyncInterval != 0)
+			continue;
+
+		const uint32_t slot = mSyncCount % kSyncHistory;
+		mSyncTick[slot] = mFinalTick;
+		mSyncHash[slot] = mSnapshots[mFinalTick % kSnapshotCount].Hash();
+		++mSyncCount;
+	}
+
+	if (mPeerSyncPending)
+		CheckSync(mPeerSyncTick, mPeerSyncHash);
+}
+
+//-----------------------------------------------------------------------------
+// Name : CheckSync () (Private)
+// Desc : Compares the peer's hash with ours for the same tick. One this
+//		peer has not reached yet is kept and checked once it has.
+//-----------------------------------------------------------------------------
+void RollbackSession::CheckSync(uint32_t aTick, uint64_t aHash)
+{
+	mPeerSyncPending = false;
+
+	if (mSyncCount == 0 || aTick > mSyncTick[(mSyncCount - 1) % kSyncHistory])
+	{
+		mPeerSyncTick    = aTick;
+		mPeerSyncHash    = aHash;
+		mPeerSyncPending = true;
+		return;
+	}
+
+	const uint32_t oldest = mSyncCount > kSyncHistory ? mSyncCount - kSyncHistory : 0;
+	for (uint32_t i = oldest; i < mSyncCount; ++i)
+	{
+		if (mSyncTick[i % kSyncHistory] == aTick && mSyncHash[i % kSyncHistory] != aHash)
+			mDesynced = true;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : SendInputs () (Private)
+// Desc : The local inputs the peer has not acknowledged, oldest first and
+//		up to a datagram's worth; the peer only takes them in sequence.
+//-----------------------------------------------------------------------------
+void RollbackSession::SendInputs()
+{
+	const uint32_t first = mRemoteAcked;
+	const uint32_t count = mLocalCount - first < kMaxPacketInputs ? mLocalCount - first : kMaxPacketInputs;
+
+	uint8_t datagram[kHeaderSize + kMaxPacketInputs * sizeof(uint16_t)];
+	uint8_t * cursor = datagram;
+	Put<uint32_t>(cursor, kMagic);
+	Put<uint32_t>(cursor, mTick);
+	Put<int32_t>(cursor, LocalAdvantage());
+	Put<uint32_t>(cursor, mRemoteCount);
+	Put<uint32_t>(cursor, mSyncCount ? mSyncTick[(mSyncCount - 1) % kSyncHistory] : kNoSyncTick);
+	Put<uint64_t>(cursor, mSyncCount ? mSyncHash[(mSyncCount - 1) % kSyncHistory] : 0);
+	Put<uint32_t>(cursor, first);
+	Put<uint8_t>(cursor, (uint8_t)count);
+	for (uint32_t tick = first; tick < first + count; ++tick)
+		Put<uint16_t>(cursor, mLocalInput[tick % kInputHistory]);
+
+	mTransport.Send(datagram, (size_t)(cursor - datagram));
+	++mStats.mPacketsSent;
+	mSentSincePoll = true;
+}
@@ -0,0 +1,109 @@
+//-----------------------------------------------------------------------------
+// File: SlotMap.cpp
+//
+// Desc: Stable, generation checked handles for densely packed collections.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// SlotMap Specific Includes
+//-----------------------------------------------------------------------------
+#include "SlotMap.h"
+#include "WorldSnapshot.h"
+#include <assert.h>
+
+//-----------------------------------------------------------------------------
+// Name : SlotMap () (Constructor)
+// Desc : SlotMap Class Constructor
+//-----------------------------------------------------------------------------
+SlotMap::SlotMap()
+{
+}
+
+void SlotMap::Reserve(size_t aCount)
+{
+	mSlots.reserve(aCount);
+	mSlotOfIndex.reserve(aCount);
+	mFreeSlots.reserve(aCount);
+}
+
+void SlotMap::Clear()
+{
+	while (!mSlotOfIndex.empty())
+		EraseAt(mSlotOfIndex.size() - 1);
+}
+
+void SlotMap::SaveState(WorldSnapshot & aSnapshot) const
+{
+	aSnapshot.WriteArray(mSlots);
+	aSnapshot.WriteArray(mSlotOfIndex);
+	aSnapshot.WriteArray(mFreeSlots);
+}
+
+bool SlotMap::LoadState(SnapshotReader & aReader)
+{
+	aReader.ReadArray(mSlots);
+	aReader.ReadArray(mSlotOfIndex);
+	aReader.ReadArray(mFreeSlots);
+	return !aReader.Failed();
+}
+
+SlotHandle SlotMap::Insert()
+{
+	uint32_t slot;
+	if (mFreeSlots.empty())
+	{
+		Slot fresh = { 0, 1 };
+		slot = (uint32_t)mSlots.size();
+		mSlots.push_back(fresh);
+	}
+	else
+	{
+		slot = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	}
+
+	mSlots[slot].mIndex = (uint32_t)mSlotOfIndex.size();
+	mSlotOfIndex.push_back(slot);
+
+	return SlotHandle(slot, mSlots[slot].mGeneration);
+}
+
+void SlotMap::EraseAt(size_t aIndex)
+{
+	assert(aIndex < mSlotOfIndex.size());
+
+	const uint32_t slot = mSlotOfIndex[aIndex];
+
+	// Follow the owner moving its last element into the hole.
+	mSlotOfIndex[aIndex] = mSlotOfIndex.back();
+	mSlots[mSlotOfIndex[aIndex]].mIndex = (uint32_t)aIndex;
+	mSlotOfIndex.pop_back();
+
+	// Skip 0 on wrap around so a null handle never matches.
+	if (++mSlots[slot].mGeneration == 0)
+		mSlots[slot].mGeneration = 1;
+	mFreeSlots.push_back(slot);
+}
+
+size_t SlotMap::IndexOf(SlotHandle aHandle) const
+{
+	if (aHandle.mSlot >= mSlots.size())
+		return kInvalidIndex;
+
+	const Slot & slot = mSlots[aHandle.mSlot];
+	if (slot.mGeneration != aHandle.mGeneration)
+		return kInvalidIndex;
+
+	// Free slots keep their generation until reused, check the slot is
+	// really the one living at that index.
+	if (slot.mIndex >= mSlotOfIndex.size() || mSlotOfIndex[slot.mIndex] != aHandle.mSlot)
+		return kInvalidIndex;
+
+	return slot.mIndex;
+}
+
+SlotHandle SlotMap::HandleAt(size_t aIndex) const
+{
+	const uint32_t slot = mSlotOfIndex[aIndex];
+	return SlotHandle(slot, mSlots[slot].mGeneration);
+}
@@ -0,0 +1,235 @@
+//-----------------------------------------------------------------------------
+// File: SpatialGrid.cpp
+//
+// Desc: Uniform grid acceleration structure for ray and area queries.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// SpatialGrid Specific Includes
+//-----------------------------------------------------------------------------
+#include "SpatialGrid.h"
+#include <limits.h>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// Upper bound on cells per axis; the cell size grows if the data is spread
+// wider than this (e.g. bullets that left the screen).
+static const int32_t kMaxAxisCells = 256;
+
+//-----------------------------------------------------------------------------
+// Name : SpatialGrid () (Constructor)
+// Desc : SpatialGrid Class Constructor
+//-----------------------------------------------------------------------------
+SpatialGrid::SpatialGrid(int32_t aCellSize)
+	: mBaseCellSize(aCellSize > 0 ? aCellSize : 64)
+	, mCellSize(mBaseCellSize)
+	, mOriginX(0)
+	, mOriginY(0)
+	, mColumns(0)
+	, mRows(0)
+	, mRectangles(nullptr)
+{
+}
+
+void SpatialGrid::Clear()
+{
+	mColumns = mRows = 0;
+	mCellStart.clear();
+	mItems.clear();
+	mFirstCellX.clear();
+	mFirstCellY.clear();
+	mRectangles = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Build ()
+// Desc : Counting sort of the rectangles into the cells they overlap. The
+//		grid keeps a pointer to aRectangles, which must stay unchanged
+//		until the next Build.
+//-----------------------------------------------------------------------------
+void SpatialGrid::Build(const RectangleSoA & aRectangles)
+{
+	mRectangles = &aRectangles;
+
+	const size_t count     = aRectangles.Size();
+	const int32_t * left   = aRectangles.Left();
+	const int32_t * top    = aRectangles.Top();
+	const int32_t * right  = aRectangles.Right();
+	const int32_t * bottom = aRectangles.Bottom();
+
+	if (count == 0)
+	{
+		mColumns = mRows = 1;
+		mCellStart.assign(2, 0);
+		mItems.clear();
+		mFirstCellX.clear();
+		mFirstCellY.clear();
+		return;
+	}
+
+	// Fit the grid to the data.
+	int32_t minX = INT32_MAX, minY = INT32_MAX;
+	int32_t maxX = INT32_MIN, maxY = INT32_MIN;
+	for (size_t i = 0; i < count; ++i)
+	{
+		minX = std::min(minX, left[i]);
+		minY = std::min(minY, top[i]);
+		maxX = std::max(maxX, right[i]);
+		maxY = std::max(maxY, bottom[i]);
+	}
+
+	const int64_t extent = std::max((int64_t)maxX - minX, (int64_t)maxY - minY) + 1;
+	mCellSize = mBaseCellSize;
+	while (extent / mCellSize >= kMaxAxisCells)
+		mCellSize *= 2;
+
+	mOriginX = minX;
+	mOriginY = minY;
+	mColumns = (int32_t)(((int64_t)maxX - minX) / mCellSize) + 1;
+	mRows    = (int32_t)(((int64_t)maxY - minY) / mCellSize) + 1;
+
+	const size_t cells = (size_t)mColumns * mRows;
+	mCellStart.assign(cells + 1, 0);
+
+	// Pass 1: count entries per cell (shifted by one for the prefix sum).
+	mFirstCellX.resize(count);
+	mFirstCellY.resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const int32_t x0 = CellX(left[i]), x1 = CellX(right[i]);
+		const int32_t y0 = CellY(top[i]),  y1 = CellY(bottom[i]);
+
+		mFirstCellX[i] = x0;
+		mFirstCellY[i] = y0;
+
+		for (int32_t y = y0; y <= y1; ++y)
+			for (int32_t x = x0; x <= x1; ++x)
+				++mCellStart[y * mColumns + x + 1];
+	}
+
+	for (size_t c = 0; c < cells; ++c)
+		mCellStart[c + 1] += mCellStart[c];
+
+	// Pass 2: scatter; mCellStart[c] walks forward and ends at the next
+	// cell's start, so shift back afterwards.
+	mItems.resize(mCellStart[cells]);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const int32_t x0 = mFirstCellX[i], x1 = CellX(right[i]);
+		const int32_t y0 = mFirstCellY[i], y1 = CellY(bottom[i]);
+
+		GridItem item;
+		item.mLeft       = (float)left[i];
+		item.mTop        = (float)top[i];
+		item.mRight      = (float)right[i];
+		item.mBottom     = (float)bottom[i];
+		item.mIndex      = (uint32_t)i;
+		item.mFirstCellX = x0;
+		item.mFirstCellY = y0;
+
+		for (int32_t y = y0; y <= y1; ++y)
+			for (int32_t x = x0; x <= x1; ++x)
+				mItems[mCellStart[y * mColumns + x]++] = item;
+	}
+
+	for (size_t c = cells; c > 0; --c)
+		mCellStart[c] = mCellStart[c - 1];
+	mCellStart[0] = 0;
+}
+
+int32_t SpatialGrid::CellX(int32_t aX) const
+{
+	int64_t cell = ((int64_t)aX - mOriginX) / mCellSize;
+	return (int32_t)std::min(std::max(cell, (int64_t)0), (int64_t)mColumns - 1);
+}
+
+int32_t SpatialGrid::CellY(int32_t aY) const
+{
+	int64_t cell = ((int64_t)aY - mOriginY) / mCellSize;
+	return (int32_t)std::min(std::max(cell, (int64_t)0), (int64_t)mRows - 1);
+}
+
+//-----------------------------------------------------------------------------
+// Name : FindNearest ()
+// Desc : Searches square rings of cells outwards from the query cell and
+//		keeps the best aCount in a sorted array. Once ring n is done nothing
+//		closer than n cells can remain, which bounds the search.
+//-----------------------------------------------------------------------------
+size_t SpatialGrid::FindNearest(float aX, float aY, size_t aCount, float aMaxDistance,
+                                uint32_t * aIndices, float * aDistances) const
+{
+	if (!mRectangles || mRectangles->IsEmpty() || aCount == 0)
+		return 0;
+
+	const int32_t qx = CellX((int32_t)floorf(aX));
+	const int32_t qy = CellY((int32_t)floorf(aY));
+	const int32_t maxRing = std::max(std::max(qx, mColumns - 1 - qx), std::max(qy, mRows - 1 - qy));
+	const float maxDistSq = aMaxDistance * aMaxDistance;
+
+	size_t found = 0;
+	for (int32_t ring = 0; ring <= maxRing; ++ring)
+	{
+		// Everything in this ring is at least (ring - 1) cells away.
+		const float ringDist = (float)std::max(ring - 1, 0) * mCellSize;
+		if (ringDist > aMaxDistance)
+			break;
+		if (found == aCount && ringDist * ringDist > aDistances[found - 1])
+			break;
+
+		for (int32_t cy = qy - ring; cy <= qy + ring; ++cy)
+		{
+			if (cy < 0 || cy >= mRows)
+				continue;
+
+			// Interior rows of the ring only have their two edge cells.
+			const bool edgeRow = (cy == qy - ring || cy == qy + ring);
+			const int32_t stride = edgeRow ? 1 : std::max(2 * ring, 1);
+
+			for (int32_t cx = qx - ring; cx <= qx + ring; cx += stride)
+			{
+				if (cx < 0 || cx >= mColumns)
+					continue;
+
+				const int32_t cell = cy * mColumns + cx;
+				for (uint32_t i = mCellStart[cell]; i < mCellStart[cell + 1]; ++i)
+				{
+					const GridItem & item = mItems[i];
+					const uint32_t index  = item.mIndex;
+
+					const float dx = (item.mLeft + item.mRight) * 0.5f - aX;
+					const float dy = (item.mTop + item.mBottom) * 0.5f - aY;
+					const float distSq = dx * dx + dy * dy;
+
+					if (distSq > maxDistSq)
+						continue;
+					if (found == aCount && distSq >= aDistances[found - 1])
+						continue;
+
+					// Items spanning several cells are met more than once.
+					bool duplicate = false;
+					for (size_t k = 0; k < found && !duplicate; ++k)
+						duplicate = aIndices[k] == index;
+					if (duplicate)
+						continue;
+
+					// Insertion into the sorted result (squared distances).
+					size_t slot = found < aCount ? found++ : found - 1;
+					while (slot > 0 && aDistances[slot - 1] > distSq)
+					{
+						aIndices[slot]   = aIndices[slot - 1];
+						aDistances[slot] = aDistances[slot - 1];
+						--slot;
+					}
+					aIndices[slot]   = index;
+					aDistances[slot] = distSq;
+				}
+			}
+		}
+	}
+
+	for (size_t k = 0; k < found; ++k)
+		aDistances[k] = sqrtf(aDistances[k]);
+
+	return found;
+}
@@ -23,6 +23,8 @@ Sprite::Sprite(int imageID, int maskID)
 
 Sprite::Sprite(const char *szImageFile, const char *szMaskFile)
 {
+	PROFILE_SCOPE("LoadSprite");
+
 	mhImage = (HBITMAP)LoadImage(g_hInst, szImageFile, IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION | LR_LOADFROMFILE);
 	mhMask = (HBITMAP)LoadImage(g_hInst, szMaskFile, IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION | LR_LOADFROMFILE);
 
@@ -40,6 +42,8 @@ Sprite::Sprite(const char *szImageFile, const char *szMaskFile)
 
 Sprite::Sprite(const char *szImageFile, COLORREF crTransparentColor)
 {
+	PROFILE_SCOPE("LoadSprite");
+
 	mhImage = (HBITMAP)LoadImage(g_hInst, szImageFile, IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION | LR_LOADFROMFILE);
 
 	mhMask = 0;
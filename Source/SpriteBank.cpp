@@ -0,0 +1,111 @@
+//-----------------------------------------------------------------------------
+// File: SpriteBank.cpp
+//
+// Desc: Shared sprites for the entity stores.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// SpriteBank Specific Includes
+//-----------------------------------------------------------------------------
+#include "SpriteBank.h"
+#include "BitmapFile.h"
+#include "Profiler.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// By SpriteId. Still sprites leave the frame size 0, to be the image's.
+static const SpriteSheet kSheets[SPRITE_COUNT] =
+{
+	{ "Data/enemy.bmp",         "Data/enemyMask.bmp",         0,   0,   1  },
+	{ "Data/downPlaneImg.bmp",  "Data/downPlaneMask.bmp",     0,   0,   1  },
+	{ "Data/upBullet.bmp",      "Data/upBulletMask.bmp",      0,   0,   1  },
+	{ "Data/downBullet.bmp",    "Data/downBulletMask.bmp",    0,   0,   1  },
+	{ "Data/leftBullet.bmp",    "Data/leftBulletMask.bmp",    0,   0,   1  },
+	{ "Data/rightBullet.bmp",   "Data/rightBulletMask.bmp",   0,   0,   1  },
+	{ "Data/PlaneImg.bmp",      "Data/PlaneMask.bmp",         0,   0,   1  },
+	{ "Data/downPlaneImg.bmp",  "Data/downPlaneMask.bmp",     0,   0,   1  },
+	{ "Data/leftPlaneImg.bmp",  "Data/leftPlaneMask.bmp",     0,   0,   1  },
+	{ "Data/rightPlaneImg.bmp", "Data/rightPlaneMask.bmp",    0,   0,   1  },
+	{ "Data/explosion.bmp",     "Data/explosionmask.bmp",     128, 128, 16 },
+};
+
+//-----------------------------------------------------------------------------
+// Name : SpriteBank () (Constructor)
+// Desc : SpriteBank Class Constructor
+//-----------------------------------------------------------------------------
+SpriteBank::SpriteBank(IPlatform & aPlatform)
+	: mPlatform(aPlatform)
+{
+	for (int sprite = 0; sprite < SPRITE_COUNT; ++sprite)
+	{
+		mFrameWidth[sprite]  = 0;
+		mFrameHeight[sprite] = 0;
+	}
+}
+
+bool SpriteBank::Load(std::string & aError)
+{
+	PROFILE_SCOPE("LoadSprites");
+
+	std::vector<uint8_t> file;
+	for (uint16_t sprite = 0; sprite < SPRITE_COUNT; ++sprite)
+	{
+		SpriteSheet sheet = kSheets[sprite];
+		if (!mPlatform.LoadFile(sheet.mMaskFile, file))
+		{
+			aError = std::string("Cannot open ") + sheet.mMaskFile;
+			return false;
+		}
+		if (!BitmapFile::DecodeMask(file, mMasks[sprite]))
+		{
+			aError = std::string(sheet.mMaskFile) + " is not an uncompressed bitmap";
+			return false;
+		}
+
+		if (sheet.mFrameCount == 1)
+		{
+			sheet.mFrameWidth  = mMasks[sprite].Width();
+			sheet.mFrameHeight = mMasks[sprite].Height();
+		}
+		mFrameWidth[sprite]  = sheet.mFrameWidth;
+		mFrameHeight[sprite] = sheet.mFrameHeight;
+
+		if (!mPlatform.LoadSprite(sprite, sheet, mMasks[sprite]))
+		{
+			aError = std::string("Cannot load ") + sheet.mImageFile;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int SpriteBank::FrameCount(uint16_t aSprite) const
+{
+	return kSheets[aSprite].mFrameCount;
+}
+
+void SpriteBank::Draw(uint16_t aSprite, float aX, float aY, int aFrame)
+{
+	mPlatform.DrawSprite(aSprite, aFrame, aX, aY);
+}
+
+void SpriteBank::DrawEntities(const EntityStore & aEntities, float aAlpha)
+{
+	// One event per batch; a marker per sprite would fill the ring in a
+	// few frames of bullet hell.
+	PROFILE_SCOPE("BlitEntities");
+
+	const float * x = aEntities.X();
+	const float * y = aEntities.Y();
+	const float * previousX = aEntities.PreviousX();
+	const float * previousY = aEntities.PreviousY();
+	const uint16_t * sprite = aEntities.Sprite();
+
+	for (size_t i = 0; i < aEntities.Size(); ++i)
+	{
+		Draw(sprite[i], previousX[i] + (x[i] - previousX[i]) * aAlpha,
+			previousY[i] + (y[i] - previousY[i]) * aAlpha);
+	}
+}
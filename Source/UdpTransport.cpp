@@ -0,0 +1,234 @@
+//-----------------------------------------------------------------------------
+// File: UdpTransport.cpp
+//
+// Desc: Socket calls behind UdpTransport.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// UdpTransport Specific Includes
+//-----------------------------------------------------------------------------
+#include "UdpTransport.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int SocketLength;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int SOCKET;
+typedef socklen_t SocketLength;
+#define closesocket close
+#endif
+
+//-----------------------------------------------------------------------------
+// Static Member Definitions
+//-----------------------------------------------------------------------------
+const intptr_t UdpTransport::kNoSocket;
+
+//-----------------------------------------------------------------------------
+// Name : UdpTransport () (Constructor)
+//-----------------------------------------------------------------------------
+UdpTransport::UdpTransport()
+	: mSocket(kNoSocket)
+	, mStarted(false)
+	, mHasPeer(false)
+	, mPeerAddress(0)
+	, mPeerPort(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~UdpTransport () (Destructor)
+//-----------------------------------------------------------------------------
+UdpTransport::~UdpTransport()
+{
+	Close();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Host ()
+//-----------------------------------------------------------------------------
+bool UdpTransport::Host(uint16_t aPort, std::string & aError)
+{
+	return Open(aPort, aError);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Join ()
+// Desc : Resolves "host:port" to an IPv4 address and opens a socket on
+//		any local port.
+//-----------------------------------------------------------------------------
+bool UdpTransport::Join(const std::string & aAddress, std::string & aError)
+{
+	const size_t colon = aAddress.rfind(':');
+	if (colon == std::string::npos || colon == 0 || colon + 1 == aAddress.size())
+	{
+		aError = "Expected host:port, got \"" + aAddress + "\"";
+		return false;
+	}
+
+	const std::string host = aAddress.substr(0, colon);
+	const int port = atoi(aAddress.c_str() + colon + 1);
+	if (port <= 0 || port > 65535)
+	{
+		aError = "Bad port in \"" + aAddress + "\"";
+		return false;
+	}
+
+	if (!Open(0, aError))
+		return false;
+
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family   = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+
+	addrinfo * found = nullptr;
+	if (getaddrinfo(host.c_str(), nullptr, &hints, &found) != 0 || !found)
+	{
+		aError = "Cannot resolve " + host;
+		Close();
+		return false;
+	}
+
+	const sockaddr_in * address = reinterpret_cast<const sockaddr_in *>(found->ai_addr);
+	mPeerAddress = address->sin_addr.s_addr;
+	mPeerPort    = htons((uint16_t)port);
+	mHasPeer     = true;
+	freeaddrinfo(found);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Open () (Private)
+// Desc : Creates the socket, non-blocking, bound to aPort (0: any).
+//-----------------------------------------------------------------------------
+bool UdpTransport::Open(uint16_t aPort, std::string & aError)
+{
+	Close();
+
+#ifdef _WIN32
+	WSADATA data;
+	if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+	{
+		aError = "Cannot start Winsock";
+		return false;
+	}
+	mStarted = true;
+#endif
+
+	const SOCKET handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	mSocket = (intptr_t)handle;
+	if (handle == (SOCKET)kNoSocket)
+	{
+		mSocket = kNoSocket;
+		aError = "Cannot create a UDP socket";
+		Close();
+		return false;
+	}
+
+	sockaddr_in local;
+	memset(&local, 0, sizeof(local));
+	local.sin_family      = AF_INET;
+	local.sin_addr.s_addr = htonl(INADDR_ANY);
+	local.sin_port        = htons(aPort);
+	if (bind(handle, reinterpret_cast<const sockaddr *>(&local), sizeof(local)) != 0)
+	{
+		aError = "Cannot bind UDP port " + std::to_string((unsigned)aPort);
+		Close();
+		return false;
+	}
+
+#ifdef _WIN32
+	u_long nonBlocking = 1;
+	const bool made = ioctlsocket(handle, FIONBIO, &nonBlocking) == 0;
+#else
+	const bool made = fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+	if (!made)
+	{
+		aError = "Cannot make the socket non-blocking";
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Close ()
+//-----------------------------------------------------------------------------
+void UdpTransport::Close()
+{
+	if (mSocket != kNoSocket)
+		closesocket((SOCKET)mSocket);
+	mSocket  = kNoSocket;
+	mHasPeer = false;
+
+#ifdef _WIN32
+	if (mStarted)
+		WSACleanup();
+#endif
+	mStarted = false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Send ()
+// Desc : Nothing goes out until there is a peer; a full socket buffer
+//		counts as a lost datagram.
+//-----------------------------------------------------------------------------
+bool UdpTransport::Send(const void * aData, size_t aSize)
+{
+	if (mSocket == kNoSocket || !mHasPeer || aSize > kMaxDatagram)
+		return false;
+
+	sockaddr_in peer;
+	memset(&peer, 0, sizeof(peer));
+	peer.sin_family      = AF_INET;
+	peer.sin_addr.s_addr = mPeerAddress;
+	peer.sin_port        = mPeerPort;
+
+	sendto((SOCKET)mSocket, static_cast<const char *>(aData), (int)aSize, 0,
+		reinterpret_cast<const sockaddr *>(&peer), sizeof(peer));
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Receive ()
+// Desc : Next datagram from the peer; the first sender becomes the peer
+//		when hosting. Strangers' datagrams are skipped.
+//-----------------------------------------------------------------------------
+size_t UdpTransport::Receive(void * aBuffer, size_t aCapacity)
+{
+	if (mSocket == kNoSocket)
+		return 0;
+
+	for (;;)
+	{
+		sockaddr_in from;
+		SocketLength fromSize = sizeof(from);
+		const int received = (int)recvfrom((SOCKET)mSocket, static_cast<char *>(aBuffer), (int)aCapacity, 0,
+			reinterpret_cast<sockaddr *>(&from), &fromSize);
+
+		// Would block, or an error such as the peer's port being closed
+		if (received <= 0)
+			return 0;
+
+		if (!mHasPeer)
+		{
+			mPeerAddress = from.sin_addr.s_addr;
+			mPeerPort    = from.sin_port;
+			mHasPeer     = true;
+		}
+
+		if (from.sin_addr.s_addr == mPeerAddress && from.sin_port == mPeerPort)
+			return (size_t)received;
+	}
+}
@@ -10,44 +10,52 @@
 // Vec2 Specific Includes
 //-----------------------------------------------------------------------------
 #include "Vec2.h"
-#include "main.h"
+#include <math.h>
 
-Vec2& Vec2::operator-()
+// As in Main.h, which comes with the Windows headers Vec2 does not need
+#ifndef EPS
+#define EPS 1e-3
+#endif
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+Vec2 Vec2::operator-() const
 {
-	x = -x;
-	y = -y;
-	return *this;
+	return Vec2(-x, -y);
 }
 
-bool Vec2::operator==(Vec2 v)
+bool Vec2::operator==(const Vec2& v) const
 {
 	return (x == v.x && y == v.y);
 }
 
-bool Vec2::operator!=(Vec2 v)
+bool Vec2::operator!=(const Vec2& v) const
 {
 	return (x != v.x || y != v.y);
 }
 
-Vec2 Vec2::operator+(Vec2 v)
+Vec2 Vec2::operator+(const Vec2& v) const
 {
 	return Vec2(x + v.x, y + v.y);
 }
 
-Vec2 Vec2::operator-(Vec2 v)
+Vec2 Vec2::operator-(const Vec2& v) const
 {
 	return Vec2(x - v.x, y - v.y);
 }
 
-Vec2& Vec2::operator+=(Vec2 v)
+Vec2& Vec2::operator+=(const Vec2& v)
 {
-	*this = *this + v;
+	x += v.x;
+	y += v.y;
 	return *this;
 }
 
-Vec2& Vec2::operator-=(Vec2 v)
+Vec2& Vec2::operator-=(const Vec2& v)
 {
-	*this = *this - v;
+	x -= v.x;
+	y -= v.y;
 	return *this;
 }
 
@@ -72,7 +80,7 @@ double Vec2::Argument() const
 	}
 }
 
-double Vec2::Distance(Vec2 v) const // Euclidean distance
+double Vec2::Distance(const Vec2& v) const // Euclidean distance
 {
 	double dx = x - v.x;
 	double dy = y - v.y;
@@ -92,7 +100,7 @@ Vec2 Polar(double r, double radians)
 	return result;
 }
 
-double Vec2::operator*(Vec2 v)  // dot product
+double Vec2::operator*(const Vec2& v) const // dot product
 {  
 	return x*v.x + y*v.y;
 }
@@ -105,12 +113,12 @@ void Vec2::Rotate(double radians)
 	y = yy;
 }
 
-Vec2 Vec2::operator*(double s) // scale
+Vec2 Vec2::operator*(double s) const // scale
 {
 	return Vec2(s*x, s*y);
 }
 
-Vec2 Vec2::operator/(double s) // scale
+Vec2 Vec2::operator/(double s) const // scale
 {
 	return Vec2(x/s, y/s);
 }
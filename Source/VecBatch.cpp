@@ -0,0 +1,195 @@
+//-----------------------------------------------------------------------------
+// File: VecBatch.cpp
+//
+// Desc: Batched single precision vector math.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// VecBatch Specific Includes
+//-----------------------------------------------------------------------------
+#include "VecBatch.h"
+#include "SimdUtil.h"
+#include <math.h>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+static const float kPi       = 3.14159265f;
+static const float kTwoPi    = 6.28318531f;
+static const float kInvTwoPi = 0.15915494f;
+
+// Parabolic sine approximation with one refinement step on [-pi, pi].
+static const float kSinB = 4.0f / kPi;
+static const float kSinC = -4.0f / (kPi * kPi);
+static const float kSinP = 0.225f;
+
+static inline float FastSin(float aX)
+{
+	const float turns = aX * kInvTwoPi;
+	aX -= kTwoPi * (float)(int)(turns + (turns < 0.0f ? -0.5f : 0.5f));
+
+	float y = kSinB * aX + kSinC * aX * fabsf(aX);
+	return kSinP * (y * fabsf(y) - y) + y;
+}
+
+void VecBatch::Integrate(float * aX, float * aY, const float * aVelocityX, const float * aVelocityY,
+                         size_t aCount, float aTime)
+{
+	size_t i = 0;
+
+#if SIMD_SSE2
+	const __m128 time = _mm_set1_ps(aTime);
+
+	for (; i + 4 <= aCount; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(aX + i);
+		const __m128 y = _mm_loadu_ps(aY + i);
+
+		_mm_storeu_ps(aX + i, _mm_add_ps(x, _mm_mul_ps(_mm_loadu_ps(aVelocityX + i), time)));
+		_mm_storeu_ps(aY + i, _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(aVelocityY + i), time)));
+	}
+#endif
+
+	for (; i < aCount; ++i)
+	{
+		aX[i] += aVelocityX[i] * aTime;
+		aY[i] += aVelocityY[i] * aTime;
+	}
+}
+
+void VecBatch::Normalize(float * aX, float * aY, size_t aCount)
+{
+	size_t i = 0;
+
+#if SIMD_SSE2
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one  = _mm_set1_ps(1.0f);
+
+	for (; i + 4 <= aCount; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(aX + i);
+		const __m128 y = _mm_loadu_ps(aY + i);
+
+		// Zero lengths would divide by zero; mask their scale to 0.
+		const __m128 lengthSq = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+		const __m128 nonZero  = _mm_cmpgt_ps(lengthSq, zero);
+		const __m128 scale    = _mm_and_ps(nonZero, _mm_div_ps(one, _mm_sqrt_ps(lengthSq)));
+
+		_mm_storeu_ps(aX + i, _mm_mul_ps(x, scale));
+		_mm_storeu_ps(aY + i, _mm_mul_ps(y, scale));
+	}
+#endif
+
+	for (; i < aCount; ++i)
+	{
+		const float lengthSq = aX[i] * aX[i] + aY[i] * aY[i];
+		const float scale    = lengthSq > 0.0f ? 1.0f / sqrtf(lengthSq) : 0.0f;
+
+		aX[i] *= scale;
+		aY[i] *= scale;
+	}
+}
+
+void VecBatch::Rotate(float * aX, float * aY, size_t aCount, float aRadians)
+{
+	const float c = cosf(aRadians);
+	const float s = sinf(aRadians);
+	size_t i = 0;
+
+#if SIMD_SSE2
+	const __m128 cos4 = _mm_set1_ps(c);
+	const __m128 sin4 = _mm_set1_ps(s);
+
+	for (; i + 4 <= aCount; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(aX + i);
+		const __m128 y = _mm_loadu_ps(aY + i);
+
+		_mm_storeu_ps(aX + i, _mm_sub_ps(_mm_mul_ps(cos4, x), _mm_mul_ps(sin4, y)));
+		_mm_storeu_ps(aY + i, _mm_add_ps(_mm_mul_ps(sin4, x), _mm_mul_ps(cos4, y)));
+	}
+#endif
+
+	for (; i < aCount; ++i)
+	{
+		const float x = aX[i];
+		const float y = aY[i];
+
+		aX[i] = c * x - s * y;
+		aY[i] = s * x + c * y;
+	}
+}
+
+void VecBatch::DistanceSquared(const float * aX, const float * aY, size_t aCount,
+                               float aPointX, float aPointY, float * aOut)
+{
+	size_t i = 0;
+
+#if SIMD_SSE2
+	const __m128 pointX = _mm_set1_ps(aPointX);
+	const __m128 pointY = _mm_set1_ps(aPointY);
+
+	for (; i + 4 <= aCount; i += 4)
+	{
+		const __m128 dx = _mm_sub_ps(_mm_loadu_ps(aX + i), pointX);
+		const __m128 dy = _mm_sub_ps(_mm_loadu_ps(aY + i), pointY);
+
+		_mm_storeu_ps(aOut + i, _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+	}
+#endif
+
+	for (; i < aCount; ++i)
+	{
+		const float dx = aX[i] - aPointX;
+		const float dy = aY[i] - aPointY;
+
+		aOut[i] = dx * dx + dy * dy;
+	}
+}
+
+void VecBatch::Distance(const float * aX, const float * aY, size_t aCount,
+                        float aPointX, float aPointY, float * aOut)
+{
+	DistanceSquared(aX, aY, aCount, aPointX, aPointY, aOut);
+
+	size_t i = 0;
+
+#if SIMD_SSE2
+	for (; i + 4 <= aCount; i += 4)
+		_mm_storeu_ps(aOut + i, _mm_sqrt_ps(_mm_loadu_ps(aOut + i)));
+#endif
+
+	for (; i < aCount; ++i)
+		aOut[i] = sqrtf(aOut[i]);
+}
+
+void VecBatch::Sin(const float * aIn, float * aOut, size_t aCount)
+{
+	size_t i = 0;
+
+#if SIMD_SSE2
+	const __m128 invTwoPi = _mm_set1_ps(kInvTwoPi);
+	const __m128 twoPi    = _mm_set1_ps(kTwoPi);
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 b        = _mm_set1_ps(kSinB);
+	const __m128 c        = _mm_set1_ps(kSinC);
+	const __m128 p        = _mm_set1_ps(kSinP);
+
+	for (; i + 4 <= aCount; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(aIn + i);
+
+		// Round to nearest turn and wrap into [-pi, pi].
+		__m128 turns = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, invTwoPi)));
+		x = _mm_sub_ps(x, _mm_mul_ps(turns, twoPi));
+
+		__m128 y = _mm_add_ps(_mm_mul_ps(b, x), _mm_mul_ps(_mm_mul_ps(c, x), _mm_andnot_ps(signMask, x)));
+		y = _mm_add_ps(_mm_mul_ps(p, _mm_sub_ps(_mm_mul_ps(y, _mm_andnot_ps(signMask, y)), y)), y);
+
+		_mm_storeu_ps(aOut + i, y);
+	}
+#endif
+
+	for (; i < aCount; ++i)
+		aOut[i] = FastSin(aIn[i]);
+}
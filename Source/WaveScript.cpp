@@ -0,0 +1,277 @@
+//-----------------------------------------------------------------------------
+// File: WaveScript.cpp
+//
+// Desc: Compiles the wave text format into flat tables.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// WaveScript Specific Includes
+//-----------------------------------------------------------------------------
+#include "WaveScript.h"
+#include "Profiler.h"
+#include "Platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <map>
+#include <sstream>
+
+//-----------------------------------------------------------------------------
+// Name : ReadNumbers () (Static)
+// Desc : Reads exactly aCount numbers from the rest of the line.
+//-----------------------------------------------------------------------------
+static bool ReadNumbers(std::istringstream & aLine, float * aValues, int aCount)
+{
+	for (int i = 0; i < aCount; ++i)
+	{
+		if (!(aLine >> aValues[i]))
+			return false;
+	}
+
+	std::string extra;
+	return !(aLine >> extra);
+}
+
+//-----------------------------------------------------------------------------
+// Name : WaveScript () (Constructor)
+// Desc : WaveScript Class Constructor
+//-----------------------------------------------------------------------------
+WaveScript::WaveScript()
+{
+}
+
+bool WaveScript::LoadFromFile(IPlatform & aPlatform, const char * szFileName)
+{
+	PROFILE_SCOPE("LoadWaves");
+
+	std::vector<uint8_t> file;
+	if (!aPlatform.LoadFile(szFileName, file))
+	{
+		mError = std::string("Cannot open ") + szFileName;
+		return false;
+	}
+
+	const std::string text(file.begin(), file.end());
+	return Compile(text.c_str());
+}
+
+bool WaveScript::Compile(const char * szText)
+{
+	mPaths.clear();
+	mPointX.clear();
+	mPointY.clear();
+	mFirePatterns.clear();
+	mWaves.clear();
+	mEvents.clear();
+	mError.clear();
+
+	// Names only exist while compiling; the tables use indices.
+	std::map<std::string, uint16_t> paths;
+	std::map<std::string, uint32_t> firePatterns;
+	bool inWave = false;
+
+	std::istringstream text(szText);
+	std::string line;
+	int lineNumber = 0;
+
+	while (std::getline(text, line))
+	{
+		++lineNumber;
+
+		const size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		std::istringstream tokens(line);
+		std::string keyword;
+		if (!(tokens >> keyword))
+			continue;
+
+		if (keyword == "path")
+		{
+			std::string name, type;
+			if (!(tokens >> name >> type))
+				return Fail(lineNumber, "expected: path <name> <type> ...");
+			if (paths.count(name))
+				return Fail(lineNumber, "path defined twice");
+
+			float values[5];
+			FormationPath path;
+
+			if (type == "hold")
+			{
+				if (!ReadNumbers(tokens, values, 0))
+					return Fail(lineNumber, "hold takes no parameters");
+				path = FormationPath::Hold();
+			}
+			else if (type == "sine")
+			{
+				if (!ReadNumbers(tokens, values, 3))
+					return Fail(lineNumber, "expected: sine <amplitudeX> <amplitudeY> <frequency>");
+				path = FormationPath::Sine(values[0], values[1], values[2]);
+			}
+			else if (type == "dive")
+			{
+				if (!ReadNumbers(tokens, values, 5) || values[2] <= 0.0f)
+					return Fail(lineNumber, "expected: dive <delay> <acceleration> <period > 0> <sway> <swayFrequency>");
+				path = FormationPath::Dive(values[0], values[1], values[2], values[3], values[4]);
+			}
+			else if (type == "spline")
+			{
+				path = FormationPath::Hold();
+				path.mType       = PATH_SPLINE;
+				path.mFirstPoint = (uint32_t)mPointX.size();
+
+				float x, y;
+				if (!(tokens >> path.mFrequency))
+					return Fail(lineNumber, "expected: spline <segmentsPerSecond> <x0> <y0> ...");
+				while (tokens >> x)
+				{
+					if (!(tokens >> y))
+						return Fail(lineNumber, "spline point without y");
+					mPointX.push_back(x);
+					mPointY.push_back(y);
+				}
+				if (!tokens.eof())
+					return Fail(lineNumber, "bad spline point");
+
+				path.mPointCount = (uint32_t)mPointX.size() - path.mFirstPoint;
+				if (path.mPointCount < 2)
+					return Fail(lineNumber, "spline needs at least two points");
+			}
+			else
+			{
+				return Fail(lineNumber, "unknown path type");
+			}
+
+			paths[name] = (uint16_t)mPaths.size();
+			mPaths.push_back(path);
+		}
+		else if (keyword == "fire")
+		{
+			std::string name;
+			float values[3];
+			if (!(tokens >> name) || !ReadNumbers(tokens, values, 3) || values[0] <= 0.0f || values[1] < 0.0f)
+				return Fail(lineNumber, "expected: fire <name> <interval > 0> <volley> <speed>");
+			if (firePatterns.count(name))
+				return Fail(lineNumber, "fire pattern defined twice");
+
+			FirePattern pattern;
+			pattern.mInterval = values[0];
+			pattern.mVolley   = (uint32_t)values[1];
+			pattern.mSpeed    = values[2];
+
+			firePatterns[name] = (uint32_t)mFirePatterns.size();
+			mFirePatterns.push_back(pattern);
+		}
+		else if (keyword == "wave")
+		{
+			std::string fire, chase;
+			float chaseSpeed = 0.0f;
+			if (inWave)
+				return Fail(lineNumber, "missing end before wave");
+			if (!(tokens >> fire) || !firePatterns.count(fire))
+				return Fail(lineNumber, "expected: wave <defined fire pattern> [chase <speed>]");
+			if (tokens >> chase && (chase != "chase" || !ReadNumbers(tokens, &chaseSpeed, 1) || chaseSpeed < 0.0f))
+				return Fail(lineNumber, "expected: wave <defined fire pattern> [chase <speed>]");
+
+			WaveInfo wave;
+			wave.mFirstEvent  = (uint32_t)mEvents.size();
+			wave.mEventCount  = 0;
+			wave.mFirePattern = firePatterns[fire];
+			wave.mChaseSpeed  = chaseSpeed;
+			mWaves.push_back(wave);
+			inWave = true;
+		}
+		else if (keyword == "at")
+		{
+			std::string type, path;
+			WaveEvent event = {};
+
+			if (!inWave)
+				return Fail(lineNumber, "event outside of a wave");
+			if (!(tokens >> event.mTime >> type >> path) || event.mTime < 0.0f)
+				return Fail(lineNumber, "expected: at <time >= 0> <line|boss> <path> ...");
+			if (!paths.count(path))
+				return Fail(lineNumber, "unknown path");
+
+			event.mPath = paths[path];
+
+			float values[5];
+			if (type == "line")
+			{
+				if (!ReadNumbers(tokens, values, 5) || values[0] < 1.0f || values[0] > 65535.0f)
+					return Fail(lineNumber, "expected: line <path> <count> <x> <y> <spacing> <stagger>");
+
+				event.mType    = WAVE_EVENT_LINE;
+				event.mCount   = (uint16_t)values[0];
+				event.mX       = values[1];
+				event.mY       = values[2];
+				event.mSpacing = values[3];
+				event.mStagger = values[4];
+			}
+			else if (type == "boss")
+			{
+				if (!ReadNumbers(tokens, values, 2))
+					return Fail(lineNumber, "expected: boss <path> <x> <y>");
+
+				event.mType  = WAVE_EVENT_BOSS;
+				event.mCount = 1;
+				event.mX     = values[0];
+				event.mY     = values[1];
+			}
+			else
+			{
+				return Fail(lineNumber, "unknown event type");
+			}
+
+			mEvents.push_back(event);
+			++mWaves.back().mEventCount;
+		}
+		else if (keyword == "end")
+		{
+			if (!inWave)
+				return Fail(lineNumber, "end without wave");
+			if (mWaves.back().mEventCount == 0)
+				return Fail(lineNumber, "empty wave");
+
+			// The cursor relies on each wave being sorted by time.
+			WaveInfo & wave = mWaves.back();
+			std::stable_sort(mEvents.begin() + wave.mFirstEvent, mEvents.end(),
+				[](const WaveEvent & aA, const WaveEvent & aB) { return aA.mTime < aB.mTime; });
+			inWave = false;
+		}
+		else
+		{
+			return Fail(lineNumber, "unknown statement");
+		}
+	}
+
+	if (inWave)
+		return Fail(lineNumber, "missing end after the last wave");
+	if (mWaves.empty())
+		return Fail(lineNumber, "no waves");
+
+	return true;
+}
+
+void WaveScript::RegisterPaths(Formation & aFormation) const
+{
+	for (const FormationPath & path : mPaths)
+	{
+		if (path.mType == PATH_SPLINE)
+			aFormation.AddSpline(&mPointX[path.mFirstPoint], &mPointY[path.mFirstPoint],
+				path.mPointCount, path.mFrequency);
+		else
+			aFormation.AddPath(path);
+	}
+}
+
+bool WaveScript::Fail(int aLine, const char * szMessage)
+{
+	char prefix[32];
+	snprintf(prefix, sizeof(prefix), "line %d: ", aLine);
+
+	mError = std::string(prefix) + szMessage;
+	return false;
+}
@@ -0,0 +1,82 @@
+//-----------------------------------------------------------------------------
+// File: WorldSnapshot.cpp
+//
+// Desc: Snapshot hashing.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// WorldSnapshot Specific Includes
+//-----------------------------------------------------------------------------
+#include "WorldSnapshot.h"
+
+//-----------------------------------------------------------------------------
+// Local Functions
+//-----------------------------------------------------------------------------
+namespace
+{
+	const uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+	const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+
+	inline uint64_t RotateLeft(uint64_t aValue, int aBits)
+	{
+		return (aValue << aBits) | (aValue >> (64 - aBits));
+	}
+
+	inline uint64_t LoadWord(const uint8_t * aBytes)
+	{
+		uint64_t word;
+		memcpy(&word, aBytes, sizeof(word));
+		return word;
+	}
+
+	inline uint64_t Round(uint64_t aLane, uint64_t aWord)
+	{
+		return RotateLeft(aLane + aWord * kPrime2, 31) * kPrime1;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : HashBytes () (Static)
+// Desc : Four independent multiply-rotate lanes over 32 byte blocks, so
+//		the multiplies overlap instead of waiting on each other, folded
+//		together with the tail and finished with an avalanche. Not
+//		cryptographic; meant for telling states apart quickly.
+//-----------------------------------------------------------------------------
+uint64_t WorldSnapshot::HashBytes(const void * aData, size_t aSize)
+{
+	const uint8_t * bytes = static_cast<const uint8_t *>(aData);
+
+	uint64_t lane0 = kPrime1 + kPrime2;
+	uint64_t lane1 = kPrime2;
+	uint64_t lane2 = 0;
+	uint64_t lane3 = 0 - kPrime1;
+
+	size_t i = 0;
+	for (; i + 32 <= aSize; i += 32)
+	{
+		lane0 = Round(lane0, LoadWord(bytes + i));
+		lane1 = Round(lane1, LoadWord(bytes + i + 8));
+		lane2 = Round(lane2, LoadWord(bytes + i + 16));
+		lane3 = Round(lane3, LoadWord(bytes + i + 24));
+	}
+
+	uint64_t hash = RotateLeft(lane0, 1) + RotateLeft(lane1, 7) + RotateLeft(lane2, 12) +
+		RotateLeft(lane3, 18) + (uint64_t)aSize;
+
+	for (; i + 8 <= aSize; i += 8)
+		hash = RotateLeft(hash ^ Round(0, LoadWord(bytes + i)), 27) * kPrime1 + kPrime2;
+
+	if (i < aSize)
+	{
+		uint64_t tail = 0;
+		memcpy(&tail, bytes + i, aSize - i);
+		hash = RotateLeft(hash ^ Round(0, tail), 27) * kPrime1 + kPrime2;
+	}
+
+	hash ^= hash >> 33;
+	hash *= kPrime2;
+	hash ^= hash >> 29;
+	hash *= kPrime1;
+	hash ^= hash >> 32;
+	return hash;
+}